@@ -39,4 +39,13 @@ private:
 
 extern const FlintNativeClass *BASE_NATIVE_CLASS_LIST[13];
 
+/* Classes whose bytecode methods are replaced by native methods when they are loaded */
+extern const FlintNativeClass *OVERRIDE_NATIVE_CLASS_LIST[1];
+
+#if FLINT_AOT
+/* Defined by the output of Tools/flint_aot */
+extern const FlintNativeClass * const AOT_NATIVE_CLASS_LIST[];
+extern const uint32_t AOT_NATIVE_CLASS_COUNT;
+#endif
+
 #endif /* __FLINT_NATIVE_METHOD_H */
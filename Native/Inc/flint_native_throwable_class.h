@@ -0,0 +1,9 @@
+
+#ifndef __FLINT_NATIVE_THROWABLE_CLASS_H
+#define __FLINT_NATIVE_THROWABLE_CLASS_H
+
+#include "flint_native_class.h"
+
+extern const FlintNativeClass THROWABLE_CLASS;
+
+#endif /* __FLINT_NATIVE_THROWABLE_CLASS_H */
@@ -10,6 +10,7 @@
 #include "flint_native_thread_class.h"
 #include "flint_native_graphics_class.h"
 #include "flint_native_character_class.h"
+#include "flint_native_throwable_class.h"
 #include "flint_native_biginteger_class.h"
 #include "flint_native_print_stream_class.h"
 
@@ -28,3 +29,7 @@ const FlintNativeClass *BASE_NATIVE_CLASS_LIST[13] = {
     &PRINT_STREAM_CLASS,
     &GRAPHICS_CLASS,
 };
+
+const FlintNativeClass *OVERRIDE_NATIVE_CLASS_LIST[1] = {
+    &THROWABLE_CLASS,
+};
@@ -786,8 +786,10 @@ static void nativeDrawPolyline(FlintExecution &execution) {
     FlintInt32Array *xPoints = (FlintInt32Array *)checkNullObject(execution, execution.stackPopObject());
     uint32_t color = ((FlintJavaColor *)checkNullObject(execution, execution.stackPopObject()))->getValue();
     FlintGraphics g(execution.stackPopObject(), color);
-    if((nPoints > xPoints->getLength()) || (nPoints > yPoints->getLength()))
-        throw &execution.flint.newArrayIndexOutOfBoundsException();
+    if((nPoints > xPoints->getLength()) || (nPoints > yPoints->getLength())) {
+        execution.throwException(&execution.flint.newArrayIndexOutOfBoundsException());
+        return;
+    }
     g.drawPolyline(xPoints->getData(), yPoints->getData(), nPoints);
 }
 
@@ -797,8 +799,10 @@ static void nativeDrawPolygon(FlintExecution &execution) {
     FlintInt32Array *xPoints = (FlintInt32Array *)checkNullObject(execution, execution.stackPopObject());
     uint32_t color = ((FlintJavaColor *)checkNullObject(execution, execution.stackPopObject()))->getValue();
     FlintGraphics g(execution.stackPopObject(), color);
-    if((nPoints > xPoints->getLength()) || (nPoints > yPoints->getLength()))
-        throw &execution.flint.newArrayIndexOutOfBoundsException();
+    if((nPoints > xPoints->getLength()) || (nPoints > yPoints->getLength())) {
+        execution.throwException(&execution.flint.newArrayIndexOutOfBoundsException());
+        return;
+    }
     g.drawPolygon(xPoints->getData(), yPoints->getData(), nPoints);
 }
 
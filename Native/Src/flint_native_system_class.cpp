@@ -25,13 +25,17 @@ static void nativeArraycopy(FlintExecution &execution) {
             strObj = &execution.flint.newString(STR_AND_SIZE("Source object is not a array"));
         else
             strObj = &execution.flint.newString(STR_AND_SIZE("Destination object is not a array"));
-        throw &execution.flint.newArrayStoreException(strObj);
+        execution.throwException(&execution.flint.newArrayStoreException(strObj));
+        return;
     }
     else if(src->type == dest->type) {
         uint8_t atype = FlintJavaObject::isPrimType(src->type);
         uint8_t elementSize = atype ? FlintJavaObject::getPrimitiveTypeSize(atype) : sizeof(FlintJavaObject *);
-        if((length < 0) || ((length + srcPos) > src->size / elementSize) || ((length + destPos) > dest->size / elementSize))
-            throw "Index out of range in System.arraycopy";
+        if((length < 0) || ((length + srcPos) > src->size / elementSize) || ((length + destPos) > dest->size / elementSize)) {
+            FlintJavaString &strObj = execution.flint.newString(STR_AND_SIZE("Index out of range in System.arraycopy"));
+            execution.throwException(&execution.flint.newArrayIndexOutOfBoundsException(&strObj));
+            return;
+        }
         void *srcVal = ((FlintInt8Array *)src)->getData();
         void *dstVal = ((FlintInt8Array *)dest)->getData();
         switch(elementSize) {
@@ -55,7 +59,7 @@ static void nativeArraycopy(FlintExecution &execution) {
     }
     else {
         FlintJavaString &strObj = execution.flint.newString(STR_AND_SIZE("Type mismatch, can not copy array object"));
-        throw &execution.flint.newArrayStoreException(&strObj);
+        execution.throwException(&execution.flint.newArrayStoreException(&strObj));
     }
 }
 
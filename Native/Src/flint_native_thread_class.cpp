@@ -41,8 +41,10 @@ static void nativeSleep0(FlintExecution &execution) {
     int64_t millis = execution.stackPopInt64();
     while((int64_t)((FlintAPI::System::getNanoTime() / 1000000) - startTime) < (millis - 100)) {
         FlintAPI::Thread::sleep(100);
-        if(execution.hasTerminateRequest())
-            throw &execution.flint.newInterruptedException();
+        if(execution.hasTerminateRequest()) {
+            execution.throwException(&execution.flint.newInterruptedException());
+            return;
+        }
     }
     int64_t remaining = millis - ((FlintAPI::System::getNanoTime() / 1000000) - startTime);
     if(remaining > 0)
@@ -0,0 +1,28 @@
+
+#include "flint.h"
+#include "flint_const_name.h"
+#include "flint_java_throwable.h"
+#include "flint_native_throwable_class.h"
+
+static void nativeGetMessage(FlintExecution &execution) {
+    FlintJavaThrowable *obj = (FlintJavaThrowable *)execution.stackPopObject();
+    execution.stackPushObject(obj->getDetailMessage());
+}
+
+static void nativeFillInStackTrace(FlintExecution &execution) {
+    /* this is also the return value, it stays where it is */
+    execution.fillInStackTrace(true);
+}
+
+static void nativeGetStackTrace(FlintExecution &execution) {
+    FlintJavaThrowable *obj = (FlintJavaThrowable *)execution.stackPopObject();
+    execution.stackPushObject(&execution.flint.newStackTrace(*obj));
+}
+
+static const FlintNativeMethod methods[] = {
+    NATIVE_METHOD("\x0A\x00\x9C\x62""getMessage",       "\x14\x00\xA7\xAF""()Ljava/lang/String;",              nativeGetMessage),
+    NATIVE_METHOD("\x10\x00\xC3\xA5""fillInStackTrace", "\x17\x00\x3F\x3D""()Ljava/lang/Throwable;",           nativeFillInStackTrace),
+    NATIVE_METHOD("\x0D\x00\xEE\x4A""getStackTrace",    "\x20\x00\x18\xCD""()[Ljava/lang/StackTraceElement;", nativeGetStackTrace),
+};
+
+const FlintNativeClass THROWABLE_CLASS = NATIVE_CLASS(throwableClassName, methods);
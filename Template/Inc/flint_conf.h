@@ -15,4 +15,36 @@
 #define DBG_TX_BUFFER_SIZE          KILO_BYTE(1)
 #define DBG_CONSOLE_BUFFER_SIZE     KILO_BYTE(1)
 
+/* Find references on the Java stacks by address instead of keeping a type bit for every slot */
+#define FLINT_GC_CONSERVATIVE_STACK 1
+
+/* Set of superinstructions fused at class load, combine FLINT_SUPER_xxx bits or use 0 to disable */
+#define FLINT_SUPERINSTRUCTIONS     FLINT_SUPER_ALL
+
+/* Translate methods to a register code over their locals and operand slots at class load */
+#define FLINT_REGISTER_IR           0
+
+/* Count executed opcode pairs and triples to find sequences worth fusing */
+#define FLINT_OPCODE_PROFILE        0
+#define FLINT_OPCODE_PROFILE_SIZE   1024
+
+/* Run getters, setters, constant returns and empty methods at the call site without a frame */
+#define FLINT_INLINE_TRIVIAL_METHODS    1
+
+/* Run methods translated by Tools/flint_aot, the generated file must be built with the VM */
+#define FLINT_AOT                   0
+
+/* Compile hot methods to x86-64 code, needs an x32 host and FlintAPI::Jit */
+#define FLINT_JIT                   0
+/* Invocations and backward branches of a method before it is compiled */
+#define FLINT_JIT_THRESHOLD         1000
+
+/* Receiver types cached per invokevirtual/invokeinterface site before it turns megamorphic, 0 to disable */
+#define FLINT_INLINE_CACHE_SIZE     4
+/* Count inline cache hits and misses per call site */
+#define FLINT_INLINE_CACHE_PROFILE  0
+
+/* Frames recorded in the stack trace of a throwable, 0 disables the traces and the line number tables */
+#define FLINT_STACK_TRACE_DEPTH     32
+
 #endif /* __FLINT_CONF_H */
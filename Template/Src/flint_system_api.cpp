@@ -31,3 +31,11 @@ uint64_t FlintAPI::System::getNanoTime(void) {
 FlintNativeMethodPtr FlintAPI::System::findNativeMethod(const FlintMethodInfo &methodInfo) {
     throw "FlintAPI::System::findNativeMethod is not implemented in VM";
 }
+
+void *FlintAPI::Jit::allocCode(uint32_t size) {
+    throw "FlintAPI::Jit::allocCode is not implemented in VM";
+}
+
+void FlintAPI::Jit::freeCode(void *code) {
+    throw "FlintAPI::Jit::freeCode is not implemented in VM";
+}
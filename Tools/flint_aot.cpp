@@ -0,0 +1,1055 @@
+
+/*
+ * flint_aot: translates methods of .class files into C++ native methods for builds with FLINT_AOT enabled.
+ *
+ * Usage: flint_aot [-p <package>]... [-m <profile>] -o <output.cpp> <class files>...
+ *   -p  translate methods of classes in the package, e.g. com/app/dsp. May be repeated
+ *   -m  translate only the methods listed in the profile, one "class.name(descriptor)" per line, '#' starts a comment
+ *   Without -p and -m every method of the given classes is a candidate.
+ *
+ * The output defines AOT_NATIVE_CLASS_LIST. Build it with the VM and findNativeMethod will bind the translated
+ * methods when their classes are loaded. Candidates are static methods that only use primitive values and have
+ * no exception handlers; they may call other translated methods of the same class. Everything else stays in
+ * bytecode and the reason is printed to stderr. Translated code runs on the native stack and is not interrupted
+ * by a terminate request or the debugger.
+ *
+ * Build with a host compiler: g++ -std=c++17 -O2 -o flint_aot flint_aot.cpp
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <set>
+#include <string>
+#include <vector>
+
+#define ACC_STATIC              0x0008
+#define ACC_SYNCHRONIZED        0x0020
+#define ACC_NATIVE              0x0100
+#define ACC_ABSTRACT            0x0400
+
+#define CONST_UTF8              1
+#define CONST_INTEGER           3
+#define CONST_FLOAT             4
+#define CONST_LONG              5
+#define CONST_DOUBLE            6
+#define CONST_CLASS             7
+#define CONST_METHOD            10
+#define CONST_NAME_AND_TYPE     12
+
+#define DEPTH_UNKNOWN           -1
+
+typedef struct {
+    uint8_t tag;
+    uint32_t value1;
+    uint32_t value2;
+    std::string text;
+} AotConst;
+
+typedef struct {
+    uint16_t accessFlag;
+    std::string name;
+    std::string descriptor;
+    uint16_t maxStack;
+    uint16_t maxLocals;
+    uint16_t exceptionTableLength;
+    std::vector<uint8_t> code;
+    bool hasCode;
+    bool translate;
+    std::string reason;
+    std::vector<int32_t> depth;
+    std::set<uint32_t> labels;
+} AotMethod;
+
+typedef struct {
+    std::string name;
+    std::vector<AotConst> constPool;
+    std::vector<AotMethod> methods;
+} AotClass;
+
+typedef struct {
+    uint32_t length;
+    int32_t depthAfter;
+    bool fallThrough;
+    std::vector<uint32_t> targets;
+} AotInsn;
+
+class AotReader {
+private:
+    const std::vector<uint8_t> &data;
+    uint32_t pos;
+public:
+    AotReader(const std::vector<uint8_t> &data) : data(data), pos(0) {
+
+    }
+
+    uint8_t u1(void) {
+        if(pos >= data.size())
+            throw "unexpected end of class file";
+        return data[pos++];
+    }
+
+    uint16_t u2(void) {
+        uint16_t value = u1() << 8;
+        return value | u1();
+    }
+
+    uint32_t u4(void) {
+        uint32_t value = u2() << 16;
+        return value | u2();
+    }
+
+    void skip(uint32_t length) {
+        if(pos + length > data.size())
+            throw "unexpected end of class file";
+        pos += length;
+    }
+
+    const uint8_t *current(void) const {
+        return &data[pos];
+    }
+};
+
+static uint16_t calcCrc(const std::string &text) {
+    uint32_t crc = 0xFFFF;
+    for(uint8_t c : text) {
+        crc ^= c;
+        for(uint8_t i = 0; i < 8; i++)
+            crc = (crc & 0x01) ? ((crc >> 1) ^ 0xA001) : (crc >> 1);
+    }
+    return ~crc & 0xFFFF;
+}
+
+/* Same layout as the FlintConstUtf8 literals in flint_const_name.cpp: length, crc, text */
+static std::string constUtf8Literal(const std::string &text) {
+    char buff[8];
+    uint16_t crc = calcCrc(text);
+    std::string ret = "\"";
+    uint8_t header[] = {(uint8_t)text.length(), (uint8_t)(text.length() >> 8), (uint8_t)crc, (uint8_t)(crc >> 8)};
+    for(uint8_t c : header) {
+        snprintf(buff, sizeof(buff), "\\x%02X", c);
+        ret += buff;
+    }
+    ret += "\"\"";
+    for(uint8_t c : text) {
+        if(c == '"' || c == '\\' || c < 0x20 || c > 0x7E) {
+            snprintf(buff, sizeof(buff), "\\x%02X\"\"", c);
+            ret += buff;
+        }
+        else
+            ret += (char)c;
+    }
+    return ret + "\"";
+}
+
+static const std::string &getUtf8(const AotClass &cls, uint16_t index) {
+    if(index >= cls.constPool.size() || cls.constPool[index].tag != CONST_UTF8)
+        throw "invalid utf8 constant";
+    return cls.constPool[index].text;
+}
+
+static void loadClass(const char *fileName, AotClass &cls) {
+    FILE *file = fopen(fileName, "rb");
+    if(file == NULL)
+        throw "can't open class file";
+    std::vector<uint8_t> data;
+    uint8_t buff[4096];
+    size_t count;
+    while((count = fread(buff, 1, sizeof(buff), file)) > 0)
+        data.insert(data.end(), buff, buff + count);
+    fclose(file);
+
+    AotReader reader(data);
+    if(reader.u4() != 0xCAFEBABE)
+        throw "invalid class file";
+    reader.skip(4);
+    uint16_t constPoolCount = reader.u2();
+    cls.constPool.resize(constPoolCount);
+    for(uint16_t i = 1; i < constPoolCount; i++) {
+        AotConst &entry = cls.constPool[i];
+        entry.tag = reader.u1();
+        switch(entry.tag) {
+            case CONST_UTF8: {
+                uint16_t length = reader.u2();
+                entry.text.assign((const char *)reader.current(), length);
+                reader.skip(length);
+                break;
+            }
+            case CONST_INTEGER:
+            case CONST_FLOAT:
+                entry.value1 = reader.u4();
+                break;
+            case CONST_LONG:
+            case CONST_DOUBLE:
+                entry.value1 = reader.u4();
+                entry.value2 = reader.u4();
+                i++;
+                break;
+            case CONST_CLASS:
+            case 8:     /* String */
+            case 16:    /* MethodType */
+            case 19:    /* Module */
+            case 20:    /* Package */
+                entry.value1 = reader.u2();
+                break;
+            case 15:    /* MethodHandle */
+                reader.skip(3);
+                break;
+            case 9:     /* Fieldref */
+            case CONST_METHOD:
+            case 11:    /* InterfaceMethodref */
+            case CONST_NAME_AND_TYPE:
+            case 17:    /* Dynamic */
+            case 18:    /* InvokeDynamic */
+                entry.value1 = reader.u2();
+                entry.value2 = reader.u2();
+                break;
+            default:
+                throw "unknown constant pool tag";
+        }
+    }
+    reader.skip(2);
+    uint16_t thisClass = reader.u2();
+    if(thisClass >= constPoolCount || cls.constPool[thisClass].tag != CONST_CLASS)
+        throw "invalid this_class";
+    cls.name = getUtf8(cls, cls.constPool[thisClass].value1);
+    reader.skip(2);
+    uint16_t interfacesCount = reader.u2();
+    reader.skip(interfacesCount * 2);
+    uint16_t fieldsCount = reader.u2();
+    while(fieldsCount--) {
+        reader.skip(6);
+        uint16_t attributesCount = reader.u2();
+        while(attributesCount--) {
+            reader.skip(2);
+            reader.skip(reader.u4());
+        }
+    }
+    uint16_t methodsCount = reader.u2();
+    cls.methods.resize(methodsCount);
+    for(AotMethod &method : cls.methods) {
+        method.accessFlag = reader.u2();
+        method.name = getUtf8(cls, reader.u2());
+        method.descriptor = getUtf8(cls, reader.u2());
+        method.hasCode = false;
+        method.translate = false;
+        uint16_t attributesCount = reader.u2();
+        while(attributesCount--) {
+            const std::string &attributeName = getUtf8(cls, reader.u2());
+            uint32_t length = reader.u4();
+            if(attributeName != "Code") {
+                reader.skip(length);
+                continue;
+            }
+            method.hasCode = true;
+            method.maxStack = reader.u2();
+            method.maxLocals = reader.u2();
+            uint32_t codeLength = reader.u4();
+            method.code.assign(reader.current(), reader.current() + codeLength);
+            reader.skip(codeLength);
+            method.exceptionTableLength = reader.u2();
+            reader.skip(method.exceptionTableLength * 8);
+            uint16_t codeAttributesCount = reader.u2();
+            while(codeAttributesCount--) {
+                reader.skip(2);
+                reader.skip(reader.u4());
+            }
+        }
+    }
+}
+
+/* Returns the parameter types followed by the return type, or an empty string for non-primitive signatures */
+static std::string parseDescriptor(const std::string &descriptor) {
+    std::string ret;
+    uint32_t i = 1;
+    for(; i < descriptor.length() && descriptor[i] != ')'; i++) {
+        if(strchr("ZBCSIJFD", descriptor[i]) == NULL)
+            return "";
+        ret += descriptor[i];
+    }
+    if(i + 2 != descriptor.length() || strchr("ZBCSIJFDV", descriptor[i + 1]) == NULL)
+        return "";
+    return ret + descriptor[i + 1];
+}
+
+static uint32_t getArgSlots(const std::string &types) {
+    uint32_t slots = 0;
+    for(uint32_t i = 0; i + 1 < types.length(); i++)
+        slots += (types[i] == 'J' || types[i] == 'D') ? 2 : 1;
+    return slots;
+}
+
+static char normalizeType(char type) {
+    return (type == 'Z' || type == 'B' || type == 'C' || type == 'S') ? 'I' : type;
+}
+
+static const char *cType(char type) {
+    switch(normalizeType(type)) {
+        case 'I': return "int32_t";
+        case 'J': return "int64_t";
+        case 'F': return "float";
+        case 'D': return "double";
+        default: return "void";
+    }
+}
+
+static std::string slot(const char *array, int32_t index) {
+    return std::string(array) + "[" + std::to_string(index) + "]";
+}
+
+static std::string getValue(char type, const char *array, int32_t index) {
+    switch(type) {
+        case 'J': return "aotGetLong(&" + slot(array, index) + ")";
+        case 'F': return "aotGetFloat(&" + slot(array, index) + ")";
+        case 'D': return "aotGetDouble(&" + slot(array, index) + ")";
+        default: return slot(array, index);
+    }
+}
+
+static std::string setValue(char type, const char *array, int32_t index, const std::string &value) {
+    switch(type) {
+        case 'J': return "aotSetLong(&" + slot(array, index) + ", " + value + ");";
+        case 'F': return "aotSetFloat(&" + slot(array, index) + ", " + value + ");";
+        case 'D': return "aotSetDouble(&" + slot(array, index) + ", " + value + ");";
+        default: return slot(array, index) + " = " + value + ";";
+    }
+}
+
+static uint8_t typeSlots(char type) {
+    return (type == 'J' || type == 'D') ? 2 : 1;
+}
+
+static std::string hexValue(uint64_t value, bool isLong) {
+    char buff[32];
+    if(isLong)
+        snprintf(buff, sizeof(buff), "(int64_t)0x%016llXULL", (unsigned long long)value);
+    else
+        snprintf(buff, sizeof(buff), "(int32_t)0x%08X", (uint32_t)value);
+    return buff;
+}
+
+static int16_t readS2(const std::vector<uint8_t> &code, uint32_t pos) {
+    return (int16_t)((code[pos] << 8) | code[pos + 1]);
+}
+
+static int32_t readS4(const std::vector<uint8_t> &code, uint32_t pos) {
+    return (int32_t)(((uint32_t)code[pos] << 24) | (code[pos + 1] << 16) | (code[pos + 2] << 8) | code[pos + 3]);
+}
+
+static std::string functionName(uint32_t classIndex, uint32_t methodIndex) {
+    return "aotMethod" + std::to_string(classIndex) + "_" + std::to_string(methodIndex);
+}
+
+static AotMethod *findCallee(AotClass &cls, uint16_t methodRef, uint32_t *methodIndex) {
+    if(methodRef >= cls.constPool.size() || cls.constPool[methodRef].tag != CONST_METHOD)
+        return NULL;
+    const AotConst &classConst = cls.constPool[cls.constPool[methodRef].value1];
+    const AotConst &nameAndType = cls.constPool[cls.constPool[methodRef].value2];
+    if(getUtf8(cls, classConst.value1) != cls.name)
+        return NULL;
+    const std::string &name = getUtf8(cls, nameAndType.value1);
+    const std::string &descriptor = getUtf8(cls, nameAndType.value2);
+    for(uint32_t i = 0; i < cls.methods.size(); i++) {
+        if(cls.methods[i].name == name && cls.methods[i].descriptor == descriptor) {
+            *methodIndex = i;
+            return &cls.methods[i];
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Decodes the instruction at pc for an operand stack of depth slots.
+ * When out is not NULL the C++ statements for the instruction are appended to it.
+ * Returns false with the reason set for instructions the translator does not support.
+ */
+static bool translateInsn(AotClass &cls, uint32_t classIndex, AotMethod &method, uint32_t pc, int32_t d, AotInsn &insn, std::string *out, std::string &reason) {
+    const std::vector<uint8_t> &code = method.code;
+    uint8_t opcode = code[pc];
+    std::string text;
+    insn.length = 1;
+    insn.depthAfter = d;
+    insn.fallThrough = true;
+    insn.targets.clear();
+
+    static const char loadStoreTypes[] = "IJFD";
+    static const char arithTypes[] = "IJFD";
+    static const char *const arithOps[] = {"add", "sub", "mul", "div", "rem"};
+    static const char *const compares[] = {"==", "!=", "<", ">=", ">", "<="};
+
+    if(opcode == 0x00) {
+        /* nop */
+    }
+    else if(opcode >= 0x02 && opcode <= 0x08) {
+        text = slot("S", d) + " = " + std::to_string((int32_t)opcode - 0x03) + ";";
+        insn.depthAfter = d + 1;
+    }
+    else if(opcode >= 0x09 && opcode <= 0x0F) {
+        static const uint64_t values[] = {
+            0, 1, 0x00000000, 0x3F800000, 0x40000000, 0x0000000000000000ULL, 0x3FF0000000000000ULL
+        };
+        bool isWide = (opcode <= 0x0A || opcode >= 0x0E);
+        text = isWide ? setValue('J', "S", d, hexValue(values[opcode - 0x09], true)) : slot("S", d) + " = " + hexValue(values[opcode - 0x09], false) + ";";
+        insn.depthAfter = d + (isWide ? 2 : 1);
+    }
+    else if(opcode == 0x10) {
+        text = slot("S", d) + " = " + std::to_string((int8_t)code[pc + 1]) + ";";
+        insn.length = 2;
+        insn.depthAfter = d + 1;
+    }
+    else if(opcode == 0x11) {
+        text = slot("S", d) + " = " + std::to_string(readS2(code, pc + 1)) + ";";
+        insn.length = 3;
+        insn.depthAfter = d + 1;
+    }
+    else if(opcode == 0x12 || opcode == 0x13 || opcode == 0x14) {
+        uint16_t index = (opcode == 0x12) ? code[pc + 1] : ((code[pc + 1] << 8) | code[pc + 2]);
+        insn.length = (opcode == 0x12) ? 2 : 3;
+        if(index >= cls.constPool.size()) {
+            reason = "invalid constant index";
+            return false;
+        }
+        const AotConst &value = cls.constPool[index];
+        if(opcode != 0x14 && (value.tag == CONST_INTEGER || value.tag == CONST_FLOAT)) {
+            text = slot("S", d) + " = " + hexValue(value.value1, false) + ";";
+            insn.depthAfter = d + 1;
+        }
+        else if(opcode == 0x14 && (value.tag == CONST_LONG || value.tag == CONST_DOUBLE)) {
+            text = setValue('J', "S", d, hexValue(((uint64_t)value.value1 << 32) | value.value2, true));
+            insn.depthAfter = d + 2;
+        }
+        else {
+            reason = "ldc of a reference constant";
+            return false;
+        }
+    }
+    else if((opcode >= 0x15 && opcode <= 0x18) || (opcode >= 0x1A && opcode <= 0x29)) {
+        char type = (opcode <= 0x18) ? loadStoreTypes[opcode - 0x15] : loadStoreTypes[(opcode - 0x1A) / 4];
+        uint16_t index = (opcode <= 0x18) ? code[pc + 1] : ((opcode - 0x1A) % 4);
+        insn.length = (opcode <= 0x18) ? 2 : 1;
+        text = slot("S", d) + " = " + slot("L", index) + ";";
+        if(typeSlots(type) == 2)
+            text += " " + slot("S", d + 1) + " = " + slot("L", index + 1) + ";";
+        insn.depthAfter = d + typeSlots(type);
+    }
+    else if((opcode >= 0x36 && opcode <= 0x39) || (opcode >= 0x3B && opcode <= 0x4A)) {
+        char type = (opcode <= 0x39) ? loadStoreTypes[opcode - 0x36] : loadStoreTypes[(opcode - 0x3B) / 4];
+        uint16_t index = (opcode <= 0x39) ? code[pc + 1] : ((opcode - 0x3B) % 4);
+        uint8_t slots = typeSlots(type);
+        insn.length = (opcode <= 0x39) ? 2 : 1;
+        text = slot("L", index) + " = " + slot("S", d - slots) + ";";
+        if(slots == 2)
+            text += " " + slot("L", index + 1) + " = " + slot("S", d - 1) + ";";
+        insn.depthAfter = d - slots;
+    }
+    else if(opcode >= 0x57 && opcode <= 0x5F) {
+        /* Stack manipulation works on raw slots so the value types do not matter */
+        switch(opcode) {
+            case 0x57:
+                insn.depthAfter = d - 1;
+                break;
+            case 0x58:
+                insn.depthAfter = d - 2;
+                break;
+            case 0x59:
+                text = slot("S", d) + " = " + slot("S", d - 1) + ";";
+                insn.depthAfter = d + 1;
+                break;
+            case 0x5A:
+                text = slot("S", d) + " = " + slot("S", d - 1) + "; " + slot("S", d - 1) + " = " + slot("S", d - 2) + "; " +
+                       slot("S", d - 2) + " = " + slot("S", d) + ";";
+                insn.depthAfter = d + 1;
+                break;
+            case 0x5B:
+                text = slot("S", d) + " = " + slot("S", d - 1) + "; " + slot("S", d - 1) + " = " + slot("S", d - 2) + "; " +
+                       slot("S", d - 2) + " = " + slot("S", d - 3) + "; " + slot("S", d - 3) + " = " + slot("S", d) + ";";
+                insn.depthAfter = d + 1;
+                break;
+            case 0x5C:
+                text = slot("S", d) + " = " + slot("S", d - 2) + "; " + slot("S", d + 1) + " = " + slot("S", d - 1) + ";";
+                insn.depthAfter = d + 2;
+                break;
+            case 0x5D:
+                text = slot("S", d + 1) + " = " + slot("S", d - 1) + "; " + slot("S", d) + " = " + slot("S", d - 2) + "; " +
+                       slot("S", d - 1) + " = " + slot("S", d - 3) + "; " + slot("S", d - 3) + " = " + slot("S", d) + "; " +
+                       slot("S", d - 2) + " = " + slot("S", d + 1) + ";";
+                insn.depthAfter = d + 2;
+                break;
+            case 0x5E:
+                text = slot("S", d + 1) + " = " + slot("S", d - 1) + "; " + slot("S", d) + " = " + slot("S", d - 2) + "; " +
+                       slot("S", d - 1) + " = " + slot("S", d - 3) + "; " + slot("S", d - 2) + " = " + slot("S", d - 4) + "; " +
+                       slot("S", d - 4) + " = " + slot("S", d) + "; " + slot("S", d - 3) + " = " + slot("S", d + 1) + ";";
+                insn.depthAfter = d + 2;
+                break;
+            default:
+                text = "{ int32_t tmp = " + slot("S", d - 1) + "; " + slot("S", d - 1) + " = " + slot("S", d - 2) + "; " +
+                       slot("S", d - 2) + " = tmp; }";
+                break;
+        }
+    }
+    else if(opcode >= 0x60 && opcode <= 0x73) {
+        char type = arithTypes[(opcode - 0x60) % 4];
+        std::string op = arithOps[(opcode - 0x60) / 4];
+        uint8_t slots = typeSlots(type);
+        std::string a = getValue(type, "S", d - 2 * slots);
+        std::string b = getValue(type, "S", d - slots);
+        std::string value;
+        if(type == 'I' || type == 'J') {
+            const char *u = (type == 'I') ? "uint32_t" : "uint64_t";
+            if(op == "div" || op == "rem")
+                value = std::string((type == 'I') ? "aotI" : "aotL") + op + "(execution, " + a + ", " + b + ")";
+            else
+                value = std::string("(") + cType(type) + ")((" + u + ")" + a + " " + (op == "add" ? "+" : op == "sub" ? "-" : "*") + " (" + u + ")" + b + ")";
+        }
+        else if(op == "rem")
+            value = std::string((type == 'F') ? "fmodf(" : "fmod(") + a + ", " + b + ")";
+        else
+            value = a + " " + (op == "add" ? "+" : op == "sub" ? "-" : op == "mul" ? "*" : "/") + " " + b;
+        text = setValue(type, "S", d - 2 * slots, value);
+        insn.depthAfter = d - slots;
+    }
+    else if(opcode >= 0x74 && opcode <= 0x77) {
+        char type = arithTypes[opcode - 0x74];
+        uint8_t slots = typeSlots(type);
+        std::string a = getValue(type, "S", d - slots);
+        if(type == 'I')
+            text = setValue(type, "S", d - slots, "(int32_t)(0u - (uint32_t)" + a + ")");
+        else if(type == 'J')
+            text = setValue(type, "S", d - slots, "(int64_t)(0ull - (uint64_t)" + a + ")");
+        else
+            text = setValue(type, "S", d - slots, "-" + a);
+    }
+    else if(opcode >= 0x78 && opcode <= 0x7D) {
+        char type = (opcode & 0x01) ? 'J' : 'I';
+        uint8_t slots = typeSlots(type);
+        std::string a = getValue(type, "S", d - 1 - slots);
+        std::string b = "(" + slot("S", d - 1) + ((type == 'I') ? " & 0x1F)" : " & 0x3F)");
+        const char *u = (type == 'I') ? "uint32_t" : "uint64_t";
+        std::string value;
+        if(opcode <= 0x79)
+            value = std::string("(") + cType(type) + ")((" + u + ")" + a + " << " + b + ")";
+        else if(opcode <= 0x7B)
+            value = std::string("(") + cType(type) + ")(" + a + " >> " + b + ")";
+        else
+            value = std::string("(") + cType(type) + ")((" + u + ")" + a + " >> " + b + ")";
+        text = setValue(type, "S", d - 1 - slots, value);
+        insn.depthAfter = d - 1;
+    }
+    else if(opcode >= 0x7E && opcode <= 0x83) {
+        char type = (opcode & 0x01) ? 'J' : 'I';
+        uint8_t slots = typeSlots(type);
+        const char *op = (opcode <= 0x7F) ? " & " : (opcode <= 0x81) ? " | " : " ^ ";
+        text = setValue(type, "S", d - 2 * slots, getValue(type, "S", d - 2 * slots) + op + getValue(type, "S", d - slots));
+        insn.depthAfter = d - slots;
+    }
+    else if(opcode == 0x84) {
+        text = slot("L", code[pc + 1]) + " = (int32_t)((uint32_t)" + slot("L", code[pc + 1]) + " + (uint32_t)" + std::to_string((int8_t)code[pc + 2]) + ");";
+        insn.length = 3;
+    }
+    else if(opcode >= 0x85 && opcode <= 0x93) {
+        static const char conversions[][3] = {
+            "IJ", "IF", "ID", "JI", "JF", "JD", "FI", "FJ", "FD", "DI", "DJ", "DF", "IB", "IC", "IS"
+        };
+        char from = conversions[opcode - 0x85][0];
+        char to = conversions[opcode - 0x85][1];
+        int32_t base = d - typeSlots(from);
+        std::string a = getValue(from, "S", base);
+        std::string value;
+        if(to == 'B' || to == 'C' || to == 'S') {
+            value = std::string("(int32_t)(") + ((to == 'B') ? "int8_t" : (to == 'C') ? "uint16_t" : "int16_t") + ")" + a;
+            to = 'I';
+        }
+        else if((from == 'F' || from == 'D') && (to == 'I' || to == 'J'))
+            value = std::string((to == 'I') ? "aotD2I(" : "aotD2L(") + a + ")";
+        else if(from == 'J' && to == 'I')
+            value = "(int32_t)(uint32_t)" + a;
+        else
+            value = std::string("(") + cType(to) + ")" + a;
+        text = setValue(to, "S", base, value);
+        insn.depthAfter = base + typeSlots(to);
+    }
+    else if(opcode >= 0x94 && opcode <= 0x98) {
+        char type = (opcode == 0x94) ? 'J' : (opcode <= 0x96) ? 'F' : 'D';
+        uint8_t slots = typeSlots(type);
+        std::string a = getValue(type, "S", d - 2 * slots);
+        std::string b = getValue(type, "S", d - slots);
+        if(type == 'J')
+            text = slot("S", d - 4) + " = aotLcmp(" + a + ", " + b + ");";
+        else
+            text = slot("S", d - 2 * slots) + " = aotFcmp(" + a + ", " + b + ", " + ((opcode == 0x95 || opcode == 0x97) ? "-1" : "1") + ");";
+        insn.depthAfter = d - 2 * slots + 1;
+    }
+    else if(opcode >= 0x99 && opcode <= 0xA4) {
+        uint32_t target = pc + readS2(code, pc + 1);
+        if(opcode <= 0x9E) {
+            text = "if(" + slot("S", d - 1) + " " + compares[opcode - 0x99] + " 0) goto L_" + std::to_string(target) + ";";
+            insn.depthAfter = d - 1;
+        }
+        else {
+            text = "if(" + slot("S", d - 2) + " " + compares[opcode - 0x9F] + " " + slot("S", d - 1) + ") goto L_" + std::to_string(target) + ";";
+            insn.depthAfter = d - 2;
+        }
+        insn.length = 3;
+        insn.targets.push_back(target);
+    }
+    else if(opcode == 0xA7 || opcode == 0xC8) {
+        uint32_t target = pc + ((opcode == 0xA7) ? readS2(code, pc + 1) : readS4(code, pc + 1));
+        text = "goto L_" + std::to_string(target) + ";";
+        insn.length = (opcode == 0xA7) ? 3 : 5;
+        insn.fallThrough = false;
+        insn.targets.push_back(target);
+    }
+    else if(opcode == 0xAA || opcode == 0xAB) {
+        uint32_t pos = (pc + 4) & ~0x03;
+        uint32_t defaultTarget = pc + readS4(code, pos);
+        text = "switch(" + slot("S", d - 1) + ") {";
+        if(opcode == 0xAA) {
+            int32_t low = readS4(code, pos + 4);
+            int32_t high = readS4(code, pos + 8);
+            pos += 12;
+            for(int64_t key = low; key <= high; key++, pos += 4) {
+                uint32_t target = pc + readS4(code, pos);
+                text += " case " + std::to_string(key) + ": goto L_" + std::to_string(target) + ";";
+                insn.targets.push_back(target);
+            }
+        }
+        else {
+            int32_t pairs = readS4(code, pos + 4);
+            pos += 8;
+            for(int32_t i = 0; i < pairs; i++, pos += 8) {
+                uint32_t target = pc + readS4(code, pos + 4);
+                text += " case " + std::to_string(readS4(code, pos)) + ": goto L_" + std::to_string(target) + ";";
+                insn.targets.push_back(target);
+            }
+        }
+        text += " default: goto L_" + std::to_string(defaultTarget) + "; }";
+        insn.targets.push_back(defaultTarget);
+        insn.length = pos - pc;
+        insn.depthAfter = d - 1;
+        insn.fallThrough = false;
+    }
+    else if(opcode >= 0xAC && opcode <= 0xAF) {
+        char type = loadStoreTypes[opcode - 0xAC];
+        text = "return " + getValue(type, "S", d - typeSlots(type)) + ";";
+        insn.fallThrough = false;
+    }
+    else if(opcode == 0xB1) {
+        text = "return;";
+        insn.fallThrough = false;
+    }
+    else if(opcode == 0xB8) {
+        uint32_t calleeIndex;
+        insn.length = 3;
+        AotMethod *callee = findCallee(cls, (code[pc + 1] << 8) | code[pc + 2], &calleeIndex);
+        if(callee == NULL || !callee->translate) {
+            reason = "calls a method that is not translated";
+            return false;
+        }
+        std::string types = parseDescriptor(callee->descriptor);
+        int32_t argSlots = getArgSlots(types);
+        int32_t base = d - argSlots;
+        char retType = normalizeType(types.back());
+        std::string call = functionName(classIndex, calleeIndex) + "(execution, ";
+        if(argSlots > 0) {
+            text = "{ int32_t callArgs[" + std::to_string(argSlots) + "] = {";
+            for(int32_t i = 0; i < argSlots; i++)
+                text += ((i > 0) ? ", " : "") + slot("S", base + i);
+            text += "}; ";
+            call += "callArgs)";
+        }
+        else
+            call += "0)";
+        if(retType == 'V')
+            text += call + ";";
+        else
+            text += setValue(retType, "S", base, call);
+        if(argSlots > 0)
+            text += " }";
+        insn.depthAfter = base + ((retType == 'V') ? 0 : typeSlots(retType));
+    }
+    else if(opcode == 0xC4) {
+        uint8_t wideOpcode = code[pc + 1];
+        uint16_t index = (code[pc + 2] << 8) | code[pc + 3];
+        if(wideOpcode == 0x84) {
+            text = slot("L", index) + " = (int32_t)((uint32_t)" + slot("L", index) + " + (uint32_t)" + std::to_string(readS2(code, pc + 4)) + ");";
+            insn.length = 6;
+        }
+        else if(wideOpcode >= 0x15 && wideOpcode <= 0x18) {
+            uint8_t slots = typeSlots(loadStoreTypes[wideOpcode - 0x15]);
+            text = slot("S", d) + " = " + slot("L", index) + ";";
+            if(slots == 2)
+                text += " " + slot("S", d + 1) + " = " + slot("L", index + 1) + ";";
+            insn.length = 4;
+            insn.depthAfter = d + slots;
+        }
+        else if(wideOpcode >= 0x36 && wideOpcode <= 0x39) {
+            uint8_t slots = typeSlots(loadStoreTypes[wideOpcode - 0x36]);
+            text = slot("L", index) + " = " + slot("S", d - slots) + ";";
+            if(slots == 2)
+                text += " " + slot("L", index + 1) + " = " + slot("S", d - 1) + ";";
+            insn.length = 4;
+            insn.depthAfter = d - slots;
+        }
+        else {
+            reason = "unsupported wide instruction";
+            return false;
+        }
+    }
+    else {
+        char buff[48];
+        snprintf(buff, sizeof(buff), "unsupported opcode 0x%02X", opcode);
+        reason = buff;
+        return false;
+    }
+    if(insn.depthAfter < 0 || insn.depthAfter > method.maxStack || d > method.maxStack) {
+        reason = "operand stack out of range";
+        return false;
+    }
+    for(uint32_t target : insn.targets) {
+        if(target >= code.size()) {
+            reason = "branch target out of range";
+            return false;
+        }
+    }
+    if(out != NULL && !text.empty())
+        *out += "    " + text + "\n";
+    return true;
+}
+
+/* Checks the method and computes the operand stack depth at every reachable instruction */
+static bool analyzeMethod(AotClass &cls, uint32_t classIndex, AotMethod &method) {
+    std::string types = parseDescriptor(method.descriptor);
+    if(!method.hasCode || (method.accessFlag & (ACC_NATIVE | ACC_ABSTRACT)))
+        method.reason = "no bytecode";
+    else if(!(method.accessFlag & ACC_STATIC) || method.name == "<clinit>")
+        method.reason = "not a static method";
+    else if(method.accessFlag & ACC_SYNCHRONIZED)
+        method.reason = "synchronized";
+    else if(method.exceptionTableLength > 0)
+        method.reason = "has exception handlers";
+    else if(types.empty())
+        method.reason = "non-primitive signature";
+    if(!method.reason.empty())
+        return false;
+
+    method.depth.assign(method.code.size(), DEPTH_UNKNOWN);
+    method.labels.clear();
+    std::vector<uint32_t> pending;
+    method.depth[0] = 0;
+    pending.push_back(0);
+    AotInsn insn;
+    while(!pending.empty()) {
+        uint32_t pc = pending.back();
+        pending.pop_back();
+        if(!translateInsn(cls, classIndex, method, pc, method.depth[pc], insn, NULL, method.reason))
+            return false;
+        std::vector<uint32_t> next = insn.targets;
+        for(uint32_t target : insn.targets)
+            method.labels.insert(target);
+        if(insn.fallThrough) {
+            if(pc + insn.length >= method.code.size()) {
+                method.reason = "falls off the end of the code";
+                return false;
+            }
+            next.push_back(pc + insn.length);
+        }
+        for(uint32_t target : next) {
+            if(method.depth[target] == DEPTH_UNKNOWN) {
+                method.depth[target] = insn.depthAfter;
+                pending.push_back(target);
+            }
+            else if(method.depth[target] != insn.depthAfter) {
+                method.reason = "inconsistent operand stack depth";
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static void emitMethod(FILE *out, AotClass &cls, uint32_t classIndex, uint32_t methodIndex) {
+    AotMethod &method = cls.methods[methodIndex];
+    std::string types = parseDescriptor(method.descriptor);
+    uint32_t argSlots = getArgSlots(types);
+    std::string body;
+    AotInsn insn;
+    std::string reason;
+
+    fprintf(out, "/* %s.%s%s */\n", cls.name.c_str(), method.name.c_str(), method.descriptor.c_str());
+    fprintf(out, "static %s %s(FlintExecution &execution, const int32_t *args) {\n", cType(types.back()), functionName(classIndex, methodIndex).c_str());
+    fprintf(out, "    int32_t L[%u];\n", (method.maxLocals > 0) ? method.maxLocals : 1);
+    fprintf(out, "    int32_t S[%u];\n", (method.maxStack > 0) ? method.maxStack : 1);
+    fprintf(out, "    (void)execution;\n");
+    for(uint32_t i = 0; i < argSlots; i++)
+        fprintf(out, "    L[%u] = args[%u];\n", i, i);
+    for(uint32_t pc = 0; pc < method.code.size(); pc += insn.length) {
+        if(method.depth[pc] == DEPTH_UNKNOWN) {
+            /* Unreachable code is skipped, decode it only for the length */
+            translateInsn(cls, classIndex, method, pc, 0, insn, NULL, reason);
+            continue;
+        }
+        if(method.labels.count(pc))
+            body += "L_" + std::to_string(pc) + ":\n";
+        translateInsn(cls, classIndex, method, pc, method.depth[pc], insn, &body, reason);
+    }
+    fprintf(out, "%s}\n\n", body.c_str());
+
+    fprintf(out, "static void %sNative(FlintExecution &execution) {\n", functionName(classIndex, methodIndex).c_str());
+    if(argSlots > 0)
+        fprintf(out, "    int32_t args[%u];\n", argSlots);
+    uint32_t argIndex = argSlots;
+    for(int32_t i = (int32_t)types.length() - 2; i >= 0; i--) {
+        char type = normalizeType(types[i]);
+        argIndex -= typeSlots(type);
+        switch(type) {
+            case 'J':
+                fprintf(out, "    aotSetLong(&args[%u], execution.stackPopInt64());\n", argIndex);
+                break;
+            case 'F':
+                fprintf(out, "    aotSetFloat(&args[%u], execution.stackPopFloat());\n", argIndex);
+                break;
+            case 'D':
+                fprintf(out, "    aotSetDouble(&args[%u], execution.stackPopDouble());\n", argIndex);
+                break;
+            default:
+                fprintf(out, "    args[%u] = execution.stackPopInt32();\n", argIndex);
+                break;
+        }
+    }
+    std::string call = functionName(classIndex, methodIndex) + "(execution, " + ((argSlots > 0) ? "args)" : "0)");
+    switch(normalizeType(types.back())) {
+        case 'I':
+            fprintf(out, "    execution.stackPushInt32(%s);\n", call.c_str());
+            break;
+        case 'J':
+            fprintf(out, "    execution.stackPushInt64(%s);\n", call.c_str());
+            break;
+        case 'F':
+            fprintf(out, "    execution.stackPushFloat(%s);\n", call.c_str());
+            break;
+        case 'D':
+            fprintf(out, "    execution.stackPushDouble(%s);\n", call.c_str());
+            break;
+        default:
+            fprintf(out, "    %s;\n", call.c_str());
+            break;
+    }
+    fprintf(out, "}\n\n");
+}
+
+static const char *const outputHeader =
+    "/* Generated by flint_aot, do not edit */\n"
+    "\n"
+    "#include <math.h>\n"
+    "#include <string.h>\n"
+    "#include \"flint.h\"\n"
+    "#include \"flint_native_class.h\"\n"
+    "\n"
+    "#if FLINT_AOT\n"
+    "\n"
+    "static inline int64_t aotGetLong(const int32_t *slot) {\n"
+    "    int64_t value;\n"
+    "    memcpy(&value, slot, sizeof(value));\n"
+    "    return value;\n"
+    "}\n"
+    "\n"
+    "static inline void aotSetLong(int32_t *slot, int64_t value) {\n"
+    "    memcpy(slot, &value, sizeof(value));\n"
+    "}\n"
+    "\n"
+    "static inline float aotGetFloat(const int32_t *slot) {\n"
+    "    float value;\n"
+    "    memcpy(&value, slot, sizeof(value));\n"
+    "    return value;\n"
+    "}\n"
+    "\n"
+    "static inline void aotSetFloat(int32_t *slot, float value) {\n"
+    "    memcpy(slot, &value, sizeof(value));\n"
+    "}\n"
+    "\n"
+    "static inline double aotGetDouble(const int32_t *slot) {\n"
+    "    double value;\n"
+    "    memcpy(&value, slot, sizeof(value));\n"
+    "    return value;\n"
+    "}\n"
+    "\n"
+    "static inline void aotSetDouble(int32_t *slot, double value) {\n"
+    "    memcpy(slot, &value, sizeof(value));\n"
+    "}\n"
+    "\n"
+    "static void aotDividedByZero(FlintExecution &execution) {\n"
+    "    FlintJavaString &strObj = execution.flint.newString(STR_AND_SIZE(\"Divided by zero\"));\n"
+    "    throw &execution.flint.newArithmeticException(&strObj);\n"
+    "}\n"
+    "\n"
+    "static inline int32_t aotIdiv(FlintExecution &execution, int32_t a, int32_t b) {\n"
+    "    if(b == 0)\n"
+    "        aotDividedByZero(execution);\n"
+    "    return (b == -1) ? (int32_t)(0u - (uint32_t)a) : (a / b);\n"
+    "}\n"
+    "\n"
+    "static inline int32_t aotIrem(FlintExecution &execution, int32_t a, int32_t b) {\n"
+    "    if(b == 0)\n"
+    "        aotDividedByZero(execution);\n"
+    "    return (b == -1) ? 0 : (a % b);\n"
+    "}\n"
+    "\n"
+    "static inline int64_t aotLdiv(FlintExecution &execution, int64_t a, int64_t b) {\n"
+    "    if(b == 0)\n"
+    "        aotDividedByZero(execution);\n"
+    "    return (b == -1) ? (int64_t)(0ull - (uint64_t)a) : (a / b);\n"
+    "}\n"
+    "\n"
+    "static inline int64_t aotLrem(FlintExecution &execution, int64_t a, int64_t b) {\n"
+    "    if(b == 0)\n"
+    "        aotDividedByZero(execution);\n"
+    "    return (b == -1) ? 0 : (a % b);\n"
+    "}\n"
+    "\n"
+    "static inline int32_t aotD2I(double value) {\n"
+    "    if(value != value)\n"
+    "        return 0;\n"
+    "    else if(value >= 2147483647.0)\n"
+    "        return 0x7FFFFFFF;\n"
+    "    else if(value <= -2147483648.0)\n"
+    "        return (int32_t)0x80000000;\n"
+    "    return (int32_t)value;\n"
+    "}\n"
+    "\n"
+    "static inline int64_t aotD2L(double value) {\n"
+    "    if(value != value)\n"
+    "        return 0;\n"
+    "    else if(value >= 9223372036854775807.0)\n"
+    "        return 0x7FFFFFFFFFFFFFFFLL;\n"
+    "    else if(value <= -9223372036854775808.0)\n"
+    "        return (int64_t)0x8000000000000000ULL;\n"
+    "    return (int64_t)value;\n"
+    "}\n"
+    "\n"
+    "static inline int32_t aotLcmp(int64_t a, int64_t b) {\n"
+    "    return (a > b) - (a < b);\n"
+    "}\n"
+    "\n"
+    "static inline int32_t aotFcmp(double a, double b, int32_t nanResult) {\n"
+    "    if(a != a || b != b)\n"
+    "        return nanResult;\n"
+    "    return (a > b) - (a < b);\n"
+    "}\n"
+    "\n";
+
+static bool isSelected(const AotClass &cls, const AotMethod &method, const std::vector<std::string> &packages, const std::set<std::string> &profile) {
+    if(packages.empty() && profile.empty())
+        return true;
+    if(profile.count(cls.name + "." + method.name + method.descriptor))
+        return true;
+    for(const std::string &package : packages) {
+        if(cls.name.compare(0, package.length() + 1, package + "/") == 0)
+            return true;
+    }
+    return false;
+}
+
+static void loadProfile(const char *fileName, std::set<std::string> &profile) {
+    FILE *file = fopen(fileName, "r");
+    if(file == NULL)
+        throw "can't open profile";
+    char line[1024];
+    while(fgets(line, sizeof(line), file)) {
+        std::string entry = line;
+        size_t end = entry.find_first_of("# \t\r\n");
+        entry = entry.substr(0, end);
+        if(!entry.empty())
+            profile.insert(entry);
+    }
+    fclose(file);
+}
+
+int main(int argc, char *argv[]) {
+    std::vector<std::string> packages;
+    std::set<std::string> profile;
+    std::vector<AotClass> classes;
+    const char *outputName = NULL;
+
+    try {
+        for(int i = 1; i < argc; i++) {
+            if(strcmp(argv[i], "-p") == 0 && i + 1 < argc) {
+                std::string package = argv[++i];
+                while(!package.empty() && package.back() == '/')
+                    package.pop_back();
+                packages.push_back(package);
+            }
+            else if(strcmp(argv[i], "-m") == 0 && i + 1 < argc)
+                loadProfile(argv[++i], profile);
+            else if(strcmp(argv[i], "-o") == 0 && i + 1 < argc)
+                outputName = argv[++i];
+            else if(argv[i][0] == '-')
+                throw "unknown option";
+            else {
+                classes.emplace_back();
+                loadClass(argv[i], classes.back());
+            }
+        }
+        if(outputName == NULL || classes.empty()) {
+            fprintf(stderr, "Usage: flint_aot [-p <package>]... [-m <profile>] -o <output.cpp> <class files>...\n");
+            return 1;
+        }
+
+        /* A method is dropped when one of its callees is, repeat until nothing changes */
+        for(AotClass &cls : classes) {
+            for(AotMethod &method : cls.methods)
+                method.translate = isSelected(cls, method, packages, profile);
+        }
+        bool changed = true;
+        while(changed) {
+            changed = false;
+            for(uint32_t c = 0; c < classes.size(); c++) {
+                for(AotMethod &method : classes[c].methods) {
+                    if(method.translate && !analyzeMethod(classes[c], c, method)) {
+                        method.translate = false;
+                        changed = true;
+                    }
+                }
+            }
+        }
+
+        FILE *out = fopen(outputName, "w");
+        if(out == NULL)
+            throw "can't create output file";
+        fputs(outputHeader, out);
+        std::vector<uint32_t> emitted;
+        for(uint32_t c = 0; c < classes.size(); c++) {
+            AotClass &cls = classes[c];
+            std::string table;
+            for(uint32_t m = 0; m < cls.methods.size(); m++) {
+                AotMethod &method = cls.methods[m];
+                if(!method.translate) {
+                    if(!method.reason.empty())
+                        fprintf(stderr, "flint_aot: skip %s.%s%s: %s\n", cls.name.c_str(), method.name.c_str(), method.descriptor.c_str(), method.reason.c_str());
+                    continue;
+                }
+                emitMethod(out, cls, c, m);
+                table += "    NATIVE_METHOD(" + constUtf8Literal(method.name) + ", " + constUtf8Literal(method.descriptor) + ", " + functionName(c, m) + "Native),\n";
+            }
+            if(table.empty())
+                continue;
+            fprintf(out, "static const char aotClassName%u[] = %s;\n\n", c, constUtf8Literal(cls.name).c_str());
+            fprintf(out, "static const FlintNativeMethod aotMethods%u[] = {\n%s};\n\n", c, table.c_str());
+            fprintf(out, "static const FlintNativeClass aotClass%u = NATIVE_CLASS(aotClassName%u, aotMethods%u);\n\n", c, c, c);
+            emitted.push_back(c);
+        }
+        fprintf(out, "const FlintNativeClass * const AOT_NATIVE_CLASS_LIST[%u] = {\n", emitted.empty() ? 1 : (uint32_t)emitted.size());
+        for(uint32_t c : emitted)
+            fprintf(out, "    &aotClass%u,\n", c);
+        if(emitted.empty())
+            fprintf(out, "    0,\n");
+        fprintf(out, "};\n\n");
+        fprintf(out, "const uint32_t AOT_NATIVE_CLASS_COUNT = %u;\n\n", (uint32_t)emitted.size());
+        fprintf(out, "#endif /* FLINT_AOT */\n");
+        fclose(out);
+    }
+    catch(const char *msg) {
+        fprintf(stderr, "flint_aot: %s\n", msg);
+        return 1;
+    }
+    return 0;
+}
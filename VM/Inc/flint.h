@@ -59,10 +59,15 @@ private:
     FlintConstString *constStringList;
     FlintConstUtf8Node *constUtf8List;
     uint32_t objectSizeToGc;
+    uint16_t interfaceIdCount;
+    FlintJavaThrowable *outOfMemoryError;
+    FlintJavaThrowable *stackOverflowError;
 
     Flint(void);
     Flint(const Flint &) = delete;
     void operator=(const Flint &) = delete;
+
+    friend class FlintJit;
 public:
     static void *malloc(uint32_t size);
     static void *realloc(void *p, uint32_t size);
@@ -85,6 +90,7 @@ public:
 
     FlintJavaObject &newObject(uint32_t size, FlintConstUtf8 &type, uint8_t dimensions = 0);
     FlintJavaObject &newObject(FlintConstUtf8 &type);
+    uint32_t getObjectSize(ClassData &classData);
     FlintInt8Array &newBooleanArray(uint32_t length);
     FlintInt8Array &newByteArray(uint32_t length);
     FlintInt16Array &newCharArray(uint32_t length);
@@ -112,6 +118,8 @@ public:
 
 private:
     FlintJavaThrowable &newThrowable(FlintJavaString *strObj, FlintConstUtf8 &excpType);
+    FlintJavaThrowable &newThrowable(const FlintVmMessage &message, FlintConstUtf8 &excpType);
+    FlintJavaThrowable *newVmError(const char *text, FlintConstUtf8 &excpType);
 public:
     FlintJavaThrowable &newException(FlintJavaString *strObj = 0);
     FlintJavaThrowable &newIOException(FlintJavaString *strObj = 0);
@@ -129,6 +137,19 @@ public:
     FlintJavaThrowable &newUnsupportedOperationException(FlintJavaString *strObj = 0);
     FlintJavaThrowable &newUnsatisfiedLinkErrorException(FlintJavaString *strObj = 0);
 
+    FlintJavaThrowable &newArithmeticException(const char *texts[], uint8_t count);
+    FlintJavaThrowable &newNullPointerException(const char *texts[], uint8_t count);
+    FlintJavaThrowable &newNegativeArraySizeException(const char *texts[], uint8_t count);
+    FlintJavaThrowable &newArrayIndexOutOfBoundsException(int32_t index, uint32_t length);
+    FlintJavaThrowable &newClassCastException(FlintJavaObject &obj, FlintConstUtf8 &type);
+
+    FlintJavaThrowable *getOutOfMemoryError(void) const;
+    FlintJavaThrowable *getStackOverflowError(void) const;
+
+    void setStackTraceEnabled(const char *className, uint16_t length, bool isEnabled);
+    bool isStackTraceEnabled(ClassData &classData);
+    FlintObjectArray &newStackTrace(FlintJavaThrowable &throwable);
+
     FlintJavaBoolean &newBoolean(bool value = false);
     FlintJavaByte &newByte(int8_t value = 0);
     FlintJavaCharacter &newCharacter(uint16_t value = 0);
@@ -140,13 +161,29 @@ public:
 
     void clearProtectObjectNew(FlintJavaObject &obj);
     void garbageCollectionProtectObject(FlintJavaObject &obj);
+#if FLINT_GC_CONSERVATIVE_STACK
+    void garbageCollectionProtectStacks(void);
+    bool isObject(uint32_t value);
+#endif
 
     void initStaticField(ClassData &classData);
     FlintFieldsData &getStaticFields(FlintConstUtf8 &className) const;
 
     FlintMethodInfo &findMethod(FlintConstMethod &constMethod);
 
+    void buildVtable(ClassData &classData);
+    uint16_t getVtableIndex(FlintConstMethod &constMethod);
+    void buildItable(ClassData &classData);
+    void resolveInterfaceMethod(FlintConstMethod &constMethod);
+
+    void markOverriddenMethods(FlintClassLoader &classLoader);
+    bool canDevirtualize(FlintConstMethod &constMethod);
+
+    void buildTypeInfo(ClassData &classData);
+    ClassData *findLoadedClass(const char *typeName, uint16_t length) const;
+    bool isSubclassOf(ClassData &classData, ClassData &superClass);
     bool isInstanceof(FlintJavaObject *obj, const char *typeName, uint16_t length);
+    bool isInstanceof(FlintJavaObject *obj, const char *typeName, uint16_t length, FlintConstClassCache &cache);
 
     void garbageCollection(void);
 
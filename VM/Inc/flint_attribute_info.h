@@ -55,12 +55,15 @@ typedef void (*FlintNativeMethodPtr)(class FlintExecution &execution);
 class FlintNativeAttribute : public FlintAttribute {
 public:
     FlintNativeMethodPtr nativeMethod;
+    const uint8_t argc;
+    const uint8_t retSlots;
 private:
     FlintNativeAttribute(FlintNativeMethodPtr nativeMethod);
     FlintNativeAttribute(const FlintNativeAttribute &) = delete;
     void operator=(const FlintNativeAttribute &) = delete;
 
     friend class FlintClassLoader;
+    friend class FlintMethodInfo;
 
     ~FlintNativeAttribute(void);
 };
@@ -72,11 +75,90 @@ public:
     const uint16_t handlerPc;
     const uint16_t catchType;
 private:
+    class ClassData *catchClass;
+
     FlintExceptionTable(uint16_t startPc, uint16_t endPc, uint16_t handlerPc, uint16_t catchType);
     FlintExceptionTable(const FlintExceptionTable &) = delete;
     void operator=(const FlintExceptionTable &) = delete;
 
     friend class FlintClassLoader;
+    friend class FlintExecution;
+};
+
+typedef struct {
+    uint16_t startPc;
+    uint16_t lineNumber;
+} FlintLineNumber;
+
+class FlintLineNumberAttribute : public FlintAttribute {
+public:
+    const uint16_t lineNumberTableLength;
+private:
+    FlintLineNumber lineNumberTable[];
+
+    FlintLineNumberAttribute(uint16_t lineNumberTableLength);
+    FlintLineNumberAttribute(const FlintLineNumberAttribute &) = delete;
+    void operator=(const FlintLineNumberAttribute &) = delete;
+
+    ~FlintLineNumberAttribute(void);
+
+    friend class FlintClassLoader;
+    friend class FlintCodeAttribute;
+};
+
+typedef struct {
+    uint16_t startPc;
+    uint16_t length;
+    uint16_t descriptorIndex;
+    uint16_t index;
+} FlintLocalVariable;
+
+class FlintLocalVariableAttribute : public FlintAttribute {
+public:
+    const uint16_t localVariableTableLength;
+private:
+    FlintLocalVariable localVariableTable[];
+
+    FlintLocalVariableAttribute(uint16_t localVariableTableLength);
+    FlintLocalVariableAttribute(const FlintLocalVariableAttribute &) = delete;
+    void operator=(const FlintLocalVariableAttribute &) = delete;
+
+    ~FlintLocalVariableAttribute(void);
+
+    friend class FlintClassLoader;
+    friend class FlintCodeAttribute;
+};
+
+/* Pairs the register code with the bytecode it came from, both pcs ascend through the table */
+typedef struct {
+    uint16_t regPc;
+    uint16_t codePc;
+} FlintRegPc;
+
+/* Marks the pc and return address of a frame running the register code */
+#define REG_PC_FLAG                 0x80000000
+
+typedef struct {
+    int32_t hash;
+    int32_t value;
+    uint16_t stringIndex;
+} FlintStringCase;
+
+class FlintStringSwitch {
+public:
+    const uint32_t endPc;
+    const uint16_t resultLocal;
+    const uint16_t caseCount;
+private:
+    FlintStringCase cases[];
+
+    FlintStringSwitch(uint32_t endPc, uint16_t resultLocal, uint16_t caseCount);
+    FlintStringSwitch(const FlintStringSwitch &) = delete;
+    void operator=(const FlintStringSwitch &) = delete;
+
+    friend class FlintCodeTranslator;
+public:
+    const FlintStringCase *findCases(int32_t hash, uint16_t &count) const;
 };
 
 class FlintCodeAttribute : public FlintAttribute {
@@ -86,8 +168,16 @@ public:
     const uint32_t codeLength;
     const uint16_t exceptionTableLength;
     const uint8_t *code;
+    const uint8_t *regCode;
 private:
     FlintExceptionTable *exceptionTable;
+    uint16_t handlerRangeCount;
+    uint16_t stringSwitchCount;
+    uint16_t regLength;
+    uint16_t regPcCount;
+    uint16_t *handlerIndex;
+    FlintStringSwitch **stringSwitches;
+    FlintRegPc *regPcTable;
     FlintAttribute *attributes;
 
     FlintCodeAttribute(uint16_t maxStack, uint16_t maxLocals);
@@ -96,13 +186,23 @@ private:
 
     void setCode(uint8_t *code, uint32_t length);
     void setExceptionTable(FlintExceptionTable *exceptionTable, uint16_t length);
+    void buildHandlerIndex(void);
     void addAttribute(FlintAttribute *attribute);
+    uint16_t addStringSwitch(FlintStringSwitch *stringSwitch);
+    void setRegCode(uint8_t *regCode, uint16_t regLength, FlintRegPc *regPcTable, uint16_t regPcCount);
 
     ~FlintCodeAttribute(void);
 
     friend class FlintClassLoader;
+    friend class FlintCodeTranslator;
 public:
     FlintExceptionTable &getException(uint16_t index) const;
+    const FlintStringSwitch &getStringSwitch(uint16_t index) const;
+    const uint16_t *getHandlers(uint32_t pc, uint16_t &count) const;
+    int32_t getLineNumber(uint32_t pc) const;
+    uint16_t getLocalDescriptorIndex(uint32_t pc, uint16_t localIndex) const;
+    uint32_t getCodePc(uint32_t regPc) const;
+    uint32_t getRegPc(uint32_t codePc) const;
 };
 
 class FlintBootstrapMethod {
@@ -8,6 +8,11 @@
 #include "flint_java_class.h"
 #include "flint_java_string.h"
 
+typedef struct {
+    class ClassData *classData;     /* The named class, or the element class of an array type */
+    class ClassData *arrayClass;    /* Element class of the last array object checked against it */
+} FlintConstClassCache;
+
 class FlintClassLoader {
 private:
     uint32_t magic;
@@ -36,11 +41,15 @@ private:
     FlintAttribute *readAttribute(void *file, bool isDummy = false);
     FlintAttribute *readAttributeCode(void *file);
     FlintAttribute *readAttributeBootstrapMethods(void *file);
+    FlintAttribute *readAttributeLineNumberTable(void *file);
+    FlintAttribute *readAttributeLocalVariableTable(void *file);
 protected:
     FlintClassLoader(class Flint &flint, const char *fileName);
     FlintClassLoader(class Flint &flint, const char *fileName, uint16_t length);
     FlintClassLoader(class Flint &flint, const FlintConstUtf8 &fileName);
 
+    void resetStaticAccess(void);
+
     ~FlintClassLoader(void);
 public:
     uint32_t getMagic(void) const;
@@ -65,6 +74,7 @@ public:
     FlintConstUtf8 &getConstUtf8Class(FlintConstPool &constPool) const;
     FlintJavaClass &getConstClass(class Flint &flint, uint16_t poolIndex);
     FlintJavaClass &getConstClass(class Flint &flint, FlintConstPool &constPool);
+    FlintConstClassCache &getConstClassCache(uint16_t poolIndex);
 
     FlintJavaString &getConstString(class Flint &flint, uint16_t poolIndex);
     FlintJavaString &getConstString(class Flint &flint, FlintConstPool &constPool);
@@ -95,7 +105,7 @@ public:
     FlintFieldInfo &getFieldInfo(FlintConstNameAndType &nameAndType) const;
 
     uint16_t getMethodsCount(void) const;
-    FlintMethodInfo &getMethodInfo(uint8_t methodIndex) const;
+    FlintMethodInfo &getMethodInfo(uint16_t methodIndex) const;
     FlintMethodInfo &getMethodInfo(FlintConstUtf8 &name, FlintConstUtf8 &descriptor) const;
     FlintMethodInfo &getMethodInfo(FlintConstNameAndType &nameAndType) const;
     FlintMethodInfo &getMainMethodInfo(void) const;
@@ -0,0 +1,142 @@
+
+#ifndef __FLINT_CODE_TRANSLATOR_H
+#define __FLINT_CODE_TRANSLATOR_H
+
+#include "flint_std_types.h"
+#include "flint_attribute_info.h"
+#include "flint_method_info.h"
+
+typedef struct __attribute__((packed)) {
+    int16_t value;
+} FlintUnalignedInt16;
+
+typedef struct __attribute__((packed)) {
+    int32_t value;
+} FlintUnalignedInt32;
+
+/* Operands of the translated code are stored in native byte order */
+#define CODE_TO_INT16(array)        (((const FlintUnalignedInt16 *)(array))->value)
+#define CODE_TO_UINT16(array)       ((uint16_t)CODE_TO_INT16(array))
+#define CODE_TO_INT32(array)        (((const FlintUnalignedInt32 *)(array))->value)
+
+/* The tables of tableswitch and lookupswitch are 4-byte aligned */
+#define CODE_TO_SWITCH_TABLE(code, pc)  ((const int32_t *)&(code)[((pc) + 4) & ~0x03])
+
+/* Operation of OP_IREG_ARITH and OP_IREG_ARITH_IMM */
+typedef enum : uint8_t {
+    IREG_ADD = 0,
+    IREG_SUB,
+    IREG_MUL,
+    IREG_AND,
+    IREG_OR,
+    IREG_XOR,
+    IREG_SHL,
+    IREG_SHR,
+    IREG_USHR,
+} FlintIntRegOp;
+
+/*
+ * Opcodes of the register code. Registers are one byte indexes into the locals of the frame,
+ * the operand stack slot at depth n is register maxLocals + 4 + n, pc operands are absolute register code pcs.
+ */
+typedef enum : uint8_t {
+    REG_MOVE = 0,           /* dst, src */
+    REG_CONST,              /* dst, int32 */
+    REG_ALDC,               /* dst, pool16 */
+    REG_IADD,               /* dst, src1, src2 */
+    REG_ISUB,
+    REG_IMUL,
+    REG_IDIV,
+    REG_IREM,
+    REG_IAND,
+    REG_IOR,
+    REG_IXOR,
+    REG_ISHL,
+    REG_ISHR,
+    REG_IUSHR,
+    REG_FADD,
+    REG_FSUB,
+    REG_FMUL,
+    REG_FDIV,
+    REG_FCMPL,
+    REG_FCMPG,
+    REG_IADD_IMM,           /* dst, src, int16 */
+    REG_INEG,               /* dst, src */
+    REG_FNEG,
+    REG_I2F,
+    REG_F2I,
+    REG_I2B,
+    REG_I2C,
+    REG_I2S,
+    REG_IFEQ,               /* src, pc16 */
+    REG_IFNE,
+    REG_IFLT,
+    REG_IFGE,
+    REG_IFGT,
+    REG_IFLE,
+    REG_IF_ICMPEQ,          /* src1, src2, pc16 */
+    REG_IF_ICMPNE,
+    REG_IF_ICMPLT,
+    REG_IF_ICMPGE,
+    REG_IF_ICMPGT,
+    REG_IF_ICMPLE,
+    REG_GOTO,               /* pc16 */
+    REG_TABLESWITCH,        /* src, default pc16, low32, high32, pc16[] */
+    REG_LOOKUPSWITCH,       /* src, default pc16, count16, {key32, pc16}[] sorted by key */
+    REG_IALOAD,             /* dst, array, index */
+    REG_AALOAD,
+    REG_BALOAD,
+    REG_CALOAD,
+    REG_SALOAD,
+    REG_IASTORE,            /* array, index, src */
+    REG_AASTORE,
+    REG_BASTORE,
+    REG_CASTORE,
+    REG_ARRAYLENGTH,        /* dst, array */
+    REG_IGETFIELD,          /* dst, obj, pool16 */
+    REG_AGETFIELD,
+    REG_IPUTFIELD,          /* obj, src, pool16 */
+    REG_BPUTFIELD,
+    REG_SPUTFIELD,
+    REG_APUTFIELD,
+    REG_GETSTATIC,          /* dst, pool16, quickened to one of the two below */
+    REG_IGETSTATIC_QUICK,
+    REG_AGETSTATIC_QUICK,
+    REG_PUTSTATIC,          /* src, pool16, quickened to one of the four below */
+    REG_IPUTSTATIC_QUICK,
+    REG_BPUTSTATIC_QUICK,
+    REG_SPUTSTATIC_QUICK,
+    REG_APUTSTATIC_QUICK,
+    REG_NEW,                /* dst, pool16 */
+    REG_NEWARRAY,           /* dst, count, atype */
+    REG_ANEWARRAY,          /* dst, count, pool16 */
+    REG_CHECKCAST,          /* src, pool16 */
+    REG_INSTANCEOF,         /* dst, src, pool16 */
+    REG_INVOKEVIRTUAL,      /* last argument, pool16 */
+    REG_INVOKESPECIAL,
+    REG_INVOKESTATIC,
+    REG_INVOKEINTERFACE,    /* last argument, pool16, count */
+    REG_IRETURN,            /* src */
+    REG_ARETURN,
+    REG_RETURN,
+    REG_ATHROW,             /* src */
+    REG_OPCODE_COUNT,
+} FlintRegOpCode;
+
+class FlintCodeTranslator {
+public:
+    static uint32_t getInstructionLength(const uint8_t *code, uint32_t pc);
+    static void translate(uint8_t *code, uint32_t codeLength);
+    static void fuse(FlintMethodInfo &methodInfo);
+    static FlintMethodInlineKind classify(const FlintMethodInfo &methodInfo, uint16_t *value);
+    static void translateToRegister(FlintMethodInfo &methodInfo);
+    static void resetStaticAccess(FlintMethodInfo &methodInfo);
+private:
+    static void fuseStringSwitch(FlintMethodInfo &methodInfo, uint8_t *code, uint32_t codeLength, const uint8_t *targets, uint32_t pc);
+
+    FlintCodeTranslator(void) = delete;
+    FlintCodeTranslator(const FlintCodeTranslator &) = delete;
+    void operator=(const FlintCodeTranslator &) = delete;
+};
+
+#endif /* __FLINT_CODE_TRANSLATOR_H */
@@ -22,6 +22,15 @@
 
 #define LENGTH(_array)          (sizeof(_array) / sizeof(_array[0]))
 
+/* Superinstruction set bits used by FLINT_SUPERINSTRUCTIONS */
+#define FLINT_SUPER_ALOAD_0_GETFIELD                0x01
+#define FLINT_SUPER_ILOAD_ILOAD_IADD_ISTORE         0x02
+#define FLINT_SUPER_IINC_GOTO                       0x04
+#define FLINT_SUPER_ALOAD_ARRAYLENGTH_IF_ICMPGE     0x08
+#define FLINT_SUPER_INT_REGISTER                    0x10
+#define FLINT_SUPER_STRING_SWITCH                   0x20
+#define FLINT_SUPER_ALL                             0x3F
+
 uint16_t Flint_Swap16(uint16_t value);
 uint32_t Flint_Swap32(uint32_t value);
 uint64_t Flint_Swap64(uint64_t value);
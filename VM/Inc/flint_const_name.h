@@ -22,9 +22,11 @@ extern const FlintConstUtf8 &threadClassName;
 extern const FlintConstUtf8 &booleanClassName;
 extern const FlintConstUtf8 &integerClassName;
 extern const FlintConstUtf8 &characterClassName;
+extern const FlintConstUtf8 &cloneableClassName;
 extern const FlintConstUtf8 &throwableClassName;
 extern const FlintConstUtf8 &exceptionClassName;
 extern const FlintConstUtf8 &bigIntegerClassName;
+extern const FlintConstUtf8 &serializableClassName;
 extern const FlintConstUtf8 &printStreamClassName;
 extern const FlintConstUtf8 &ioExceptionClassName;
 extern const FlintConstUtf8 &flintGraphicsClassName;
@@ -33,6 +35,9 @@ extern const FlintConstUtf8 &arrayStoreExceptionClassName;
 extern const FlintConstUtf8 &arithmeticExceptionClassName;
 extern const FlintConstUtf8 &nullPointerExceptionClassName;
 extern const FlintConstUtf8 &unsatisfiedLinkErrorClassName;
+extern const FlintConstUtf8 &outOfMemoryErrorClassName;
+extern const FlintConstUtf8 &stackOverflowErrorClassName;
+extern const FlintConstUtf8 &stackTraceElementClassName;
 extern const FlintConstUtf8 &interruptedExceptionClassName;
 extern const FlintConstUtf8 &classNotFoundExceptionClassName;
 extern const FlintConstUtf8 &illegalArgumentExceptionClassName;
@@ -6,6 +6,9 @@
 
 #define CONST_UTF8_HASH(utf8)       *(uint32_t *)&(utf8)
 
+#define VTABLE_INDEX_UNRESOLVED     0xFFFF
+#define VTABLE_INDEX_NONE           0xFFFE
+
 class FlintConstPool {
 public:
     volatile const FlintConstPoolTag tag;
@@ -52,6 +55,7 @@ public:
     FlintConstNameAndType &nameAndType;
 private:
     uint32_t fieldIndex;
+    void *staticValue;
 private:
     FlintConstField(FlintConstUtf8 &className, FlintConstNameAndType &nameAndType);
     FlintConstField(const FlintConstField &) = delete;
@@ -59,6 +63,8 @@ private:
 
     friend class FlintClassLoader;
     friend class FlintFieldsData;
+    friend class FlintExecution;
+    friend class FlintJit;
 };
 
 typedef struct {
@@ -73,15 +79,21 @@ public:
 private:
     class FlintMethodInfo *methodInfo;
     FlintParamInfo paramInfo;
+    uint16_t vtableIndex;
+    class FlintInlineCache *inlineCache;
 public:
     const FlintParamInfo &getParmInfo(void);
+    const class FlintInlineCache *getInlineCache(void) const;
 private:
     FlintConstMethod(FlintConstUtf8 &className, FlintConstNameAndType &nameAndType);
     FlintConstMethod(FlintConstUtf8 &className, FlintConstNameAndType &nameAndType, uint8_t argc, uint8_t retType);
     FlintConstMethod(const FlintConstMethod &) = delete;
     void operator=(const FlintConstMethod &) = delete;
 
+    static FlintParamInfo parseParamInfo(const FlintConstUtf8 &descriptor);
+
     friend class Flint;
+    friend class FlintMethodInfo;
     friend class FlintExecution;
     friend class FlintClassLoader;
 };
@@ -43,4 +43,83 @@
     #warning "DBG_CONSOLE_BUFFER_SIZE is not defined. Default value will be used"
 #endif /* DBG_CONSOLE_BUFFER_SIZE */
 
+#ifndef FLINT_GC_CONSERVATIVE_STACK
+    #define FLINT_GC_CONSERVATIVE_STACK 1
+    #warning "FLINT_GC_CONSERVATIVE_STACK is not defined. Default value will be used"
+#endif /* FLINT_GC_CONSERVATIVE_STACK */
+
+#ifndef FLINT_SUPERINSTRUCTIONS
+    #define FLINT_SUPERINSTRUCTIONS     FLINT_SUPER_ALL
+    #warning "FLINT_SUPERINSTRUCTIONS is not defined. Default value will be used"
+#endif /* FLINT_SUPERINSTRUCTIONS */
+
+#ifndef FLINT_REGISTER_IR
+    #define FLINT_REGISTER_IR           0
+    #warning "FLINT_REGISTER_IR is not defined. Default value will be used"
+#endif /* FLINT_REGISTER_IR */
+
+#ifndef FLINT_OPCODE_PROFILE
+    #define FLINT_OPCODE_PROFILE        0
+    #warning "FLINT_OPCODE_PROFILE is not defined. Default value will be used"
+#endif /* FLINT_OPCODE_PROFILE */
+
+#if FLINT_OPCODE_PROFILE
+    #ifndef FLINT_OPCODE_PROFILE_SIZE
+        #define FLINT_OPCODE_PROFILE_SIZE   1024
+        #warning "FLINT_OPCODE_PROFILE_SIZE is not defined. Default value will be used"
+    #endif /* FLINT_OPCODE_PROFILE_SIZE */
+    #if(FLINT_OPCODE_PROFILE_SIZE & (FLINT_OPCODE_PROFILE_SIZE - 1))
+        #error "FLINT_OPCODE_PROFILE_SIZE must be a power of 2"
+    #endif
+#endif /* FLINT_OPCODE_PROFILE */
+
+#ifndef FLINT_INLINE_TRIVIAL_METHODS
+    #define FLINT_INLINE_TRIVIAL_METHODS    1
+    #warning "FLINT_INLINE_TRIVIAL_METHODS is not defined. Default value will be used"
+#endif /* FLINT_INLINE_TRIVIAL_METHODS */
+
+#ifndef FLINT_AOT
+    #define FLINT_AOT                   0
+    #warning "FLINT_AOT is not defined. Default value will be used"
+#endif /* FLINT_AOT */
+
+#ifndef FLINT_JIT
+    #define FLINT_JIT                   0
+    #warning "FLINT_JIT is not defined. Default value will be used"
+#endif /* FLINT_JIT */
+
+#if FLINT_JIT
+    #ifndef FLINT_JIT_THRESHOLD
+        #define FLINT_JIT_THRESHOLD     1000
+        #warning "FLINT_JIT_THRESHOLD is not defined. Default value will be used"
+    #endif /* FLINT_JIT_THRESHOLD */
+    #if(FLINT_JIT_THRESHOLD >= 0xFFFF)
+        #error "FLINT_JIT_THRESHOLD must be less than 65535"
+    #endif
+    #if !defined(__x86_64__) || !defined(__ILP32__)
+        #error "FLINT_JIT only supports x86-64 hosts with 32-bit pointers (x32)"
+    #endif
+    #if !FLINT_GC_CONSERVATIVE_STACK
+        #error "FLINT_JIT requires FLINT_GC_CONSERVATIVE_STACK"
+    #endif
+#endif /* FLINT_JIT */
+
+#ifndef FLINT_INLINE_CACHE_SIZE
+    #define FLINT_INLINE_CACHE_SIZE     4
+    #warning "FLINT_INLINE_CACHE_SIZE is not defined. Default value will be used"
+#endif /* FLINT_INLINE_CACHE_SIZE */
+#if(FLINT_INLINE_CACHE_SIZE > 16)
+    #error "FLINT_INLINE_CACHE_SIZE must not be greater than 16"
+#endif
+
+#ifndef FLINT_INLINE_CACHE_PROFILE
+    #define FLINT_INLINE_CACHE_PROFILE  0
+    #warning "FLINT_INLINE_CACHE_PROFILE is not defined. Default value will be used"
+#endif /* FLINT_INLINE_CACHE_PROFILE */
+
+#ifndef FLINT_STACK_TRACE_DEPTH
+    #define FLINT_STACK_TRACE_DEPTH     32
+    #warning "FLINT_STACK_TRACE_DEPTH is not defined. Default value will be used"
+#endif /* FLINT_STACK_TRACE_DEPTH */
+
 #endif /* __FLINT_DEFAULT_CONF_H */
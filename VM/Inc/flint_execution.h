@@ -28,6 +28,7 @@ private:
     int32_t *locals;
     uint8_t *stackType;
     FlintJavaThread *onwerThread;
+    FlintJavaThrowable *pendingException;
 protected:
     FlintExecution(Flint &flint, FlintJavaThread *onwerThread);
     FlintExecution(Flint &flint, FlintJavaThread *onwerThread, uint32_t stackSize);
@@ -53,17 +54,35 @@ public:
     float stackPopFloat(void);
     double stackPopDouble(void);
     FlintJavaObject *stackPopObject(void);
+
+    void fillInStackTrace(bool isConstructing);
+    void throwException(FlintJavaThrowable *excp);
 private:
     void initNewContext(FlintMethodInfo &methodInfo, uint16_t argc);
 
     void stackInitExitPoint(uint32_t exitPc);
     void stackRestoreContext(void);
 
-    void invoke(FlintMethodInfo &methodInfo, uint8_t argc);
-    void invokeStatic(FlintConstMethod &constMethod);
-    void invokeSpecial(FlintConstMethod &constMethod);
-    void invokeVirtual(FlintConstMethod &constMethod);
-    void invokeInterface(FlintConstInterfaceMethod &interfaceMethod, uint8_t argc);
+    bool isClassInitialized(class ClassData &classData) const;
+    void endClassInit(class ClassData &classData, bool isCompleted);
+    void leaveStaticConstructor(bool isCompleted);
+
+    FlintMethodInfo *findVirtualMethod(FlintConstMethod &constMethod, class ClassData &classData);
+    FlintMethodInfo *findInterfaceMethod(FlintConstInterfaceMethod &interfaceMethod, class ClassData &classData);
+#if FLINT_INLINE_CACHE_SIZE
+    class FlintInlineCache &getInlineCache(FlintConstMethod &constMethod);
+#endif
+
+    FlintMethodInlineKind resolveSuperInit(FlintMethodInfo &methodInfo);
+    bool invokeInline(FlintMethodInfo &methodInfo, uint8_t argc);
+    void callNativeCode(FlintNativeMethodPtr nativeCode, int32_t retSp, uint8_t retSlots);
+    bool invokeError(const FlintConstUtf8 &methodName);
+    FlintMethodInfo *resolveMethod(FlintConstMethod &constMethod);
+    bool invoke(FlintMethodInfo &methodInfo, uint8_t argc);
+    bool invokeStatic(FlintConstMethod &constMethod);
+    bool invokeSpecial(FlintConstMethod &constMethod);
+    bool invokeVirtual(FlintConstMethod &constMethod);
+    bool invokeInterface(FlintConstInterfaceMethod &interfaceMethod, uint8_t argc);
 
     void run(void);
     void terminateRequest(void);
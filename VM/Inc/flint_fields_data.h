@@ -47,6 +47,7 @@ public:
     const uint16_t fields32Count;
     const uint16_t fields64Count;
     const uint16_t fieldsObjCount;
+    const FlintClassLoader &classLoader;
 
     FlintFieldData32 &getFieldData32(const char *fieldName) const;
     FlintFieldData32 &getFieldData32(const FlintConstUtf8 &fieldName) const;
@@ -80,16 +81,40 @@ private:
     friend class Flint;
     friend class ClassData;
     friend class FlintExecution;
+    friend class FlintJit;
 };
 
+typedef enum : uint8_t {
+    CLASS_UNINITIALIZED = 0,
+    CLASS_INITIALIZING,             /* <clinit> is running on the thread initOwnId */
+    CLASS_INITIALIZED,
+} FlintClassInitStatus;
+
+typedef struct {
+    const FlintClassLoader *interfaceClass;
+    FlintMethodInfo **methods;
+} FlintItableEntry;
+
 class ClassData : public FlintClassLoader {
 private:
     ClassData *next;
 public:
     uint32_t ownId;
-    uint32_t monitorCount : 31;
-    uint32_t isInitializing : 1;
+    uint32_t monitorCount;
+    uint32_t initOwnId;
+    volatile FlintClassInitStatus initStatus;
     FlintFieldsData *staticFieldsData;
+    FlintMethodInfo **vtable;
+    uint16_t vtableSize;
+    uint16_t itableSize;
+    FlintItableEntry *itable;
+    uint16_t superDepth;
+    uint16_t interfaceId;
+    uint16_t interfaceWords;
+    ClassData **superDisplay;       /* java/lang/Object first, this class at superDepth */
+    uint32_t *interfaceBits;        /* interfaceId bits of every implemented interface */
+    uint16_t objectSize;            /* data size of an instance, 0 until the first instance is created */
+    bool isStackTraceDisabled;
 private:
     ClassData(class Flint &flint, const char *fileName);
     ClassData(class Flint &flint, const char *fileName, uint16_t length);
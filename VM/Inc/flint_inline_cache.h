@@ -0,0 +1,43 @@
+
+#ifndef __FLINT_INLINE_CACHE_H
+#define __FLINT_INLINE_CACHE_H
+
+#include "flint_std_types.h"
+
+#if __has_include("flint_conf.h")
+#include "flint_conf.h"
+#endif
+#include "flint_default_conf.h"
+
+#if FLINT_INLINE_CACHE_SIZE
+
+#define INLINE_CACHE_MEGAMORPHIC    0xFF
+
+class FlintInlineCache {
+public:
+    uint8_t count;
+#if FLINT_INLINE_CACHE_PROFILE
+    uint32_t hitCount;
+    uint32_t missCount;
+#endif
+private:
+    const class FlintClassLoader *receiverClass[FLINT_INLINE_CACHE_SIZE];
+    class FlintMethodInfo *methodInfo[FLINT_INLINE_CACHE_SIZE];
+public:
+    bool isMegamorphic(void) const;
+    uint32_t getHitCount(void) const;
+    uint32_t getMissCount(void) const;
+
+    class FlintMethodInfo *find(const class FlintClassLoader *receiverClass);
+    void add(const class FlintClassLoader *receiverClass, class FlintMethodInfo *methodInfo);
+private:
+    FlintInlineCache(void);
+    FlintInlineCache(const FlintInlineCache &) = delete;
+    void operator=(const FlintInlineCache &) = delete;
+
+    friend class FlintExecution;
+};
+
+#endif /* FLINT_INLINE_CACHE_SIZE */
+
+#endif /* __FLINT_INLINE_CACHE_H */
@@ -41,6 +41,7 @@ protected:
     friend class Flint;
     friend class FlintExecution;
     friend class FlintDebugger;
+    friend class FlintJit;
 };
 
 #endif /* __FLINT_JAVA_OBJECT_H */
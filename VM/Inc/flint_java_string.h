@@ -16,6 +16,7 @@ public:
     bool equals(const char *text, uint32_t length) const;
     bool equals(const FlintConstUtf8 &utf8) const;
     bool equals(FlintJavaString &utf8) const;
+    int32_t hashCode(void) const;
     uint32_t getUft8BuffSize(void);
 
     static bool isLatin1(const char *utf8);
@@ -4,10 +4,36 @@
 
 #include "flint_java_string.h"
 
+typedef enum : uint8_t {
+    VM_MESSAGE_NONE = 0,
+    VM_MESSAGE_TEXT,                /* texts joined */
+    VM_MESSAGE_INDEX,               /* Index <index> out of bounds for length <length> */
+    VM_MESSAGE_CLASS_CAST,          /* fromType with dimensions cannot be cast to toType */
+} FlintVmMessageKind;
+
+/* Message of an exception raised by the VM, it becomes a string only when it is read */
+typedef struct {
+    FlintVmMessageKind kind;
+    uint8_t count;
+    int32_t index;
+    int32_t length;
+    const char *texts[5];
+    const FlintConstUtf8 *fromType;
+    const FlintConstUtf8 *toType;
+} FlintVmMessage;
+
+/* VM data kept after the fields of every throwable */
+typedef struct {
+    FlintVmMessage message;
+    uint8_t isTraceFilled;
+    class FlintInt32Array *backtrace;       /* method and pc of each frame, the innermost first */
+} FlintThrowableData;
+
 class FlintJavaThrowable : public FlintJavaObject {
 public:
-    FlintJavaString *getDetailMessage(void) const;
+    FlintJavaString *getDetailMessage(void);
     void setDetailMessage(FlintJavaString &strObj);
+    FlintThrowableData *getThrowableData(void) const;
 protected:
     FlintJavaThrowable(void) = delete;
     FlintJavaThrowable(const FlintJavaThrowable &) = delete;
@@ -0,0 +1,65 @@
+
+#ifndef __FLINT_JIT_H
+#define __FLINT_JIT_H
+
+#include "flint_std_types.h"
+#include "flint_method_info.h"
+
+#if __has_include("flint_conf.h")
+#include "flint_conf.h"
+#endif
+#include "flint_default_conf.h"
+
+#if FLINT_JIT
+
+/*
+ * Interpreter state the compiled code runs on. It works on the locals and operand stack of the frame in place
+ * and stores back the sp and the pc the interpreter resumes from, so both can take over at any instruction.
+ */
+typedef struct {
+    int32_t *locals;
+    int32_t *stack;
+    int32_t sp;
+    uint32_t pc;
+    const void ** volatile *opcodes;
+    const void **runOpcodes;
+    class FlintDebugger * volatile *debugger;
+} FlintJitFrame;
+
+class FlintJitCode {
+public:
+    const uint32_t codeLength;
+private:
+    uint8_t *native;
+    uint32_t entries[];
+
+    FlintJitCode(uint32_t codeLength);
+    FlintJitCode(const FlintJitCode &) = delete;
+    void operator=(const FlintJitCode &) = delete;
+
+    friend class FlintJit;
+};
+
+class FlintJit {
+public:
+    /* Counts an invocation or a backward branch and compiles the method when it reaches FLINT_JIT_THRESHOLD */
+    static void countHot(FlintMethodInfo &methodInfo);
+
+    /* Runs the compiled code from frame.pc, returns false if the interpreter has to run the instruction there */
+    static bool enter(class Flint &flint, const FlintJitCode &jitCode, FlintJitFrame &frame);
+
+    static void free(FlintJitCode *jitCode);
+private:
+    static FlintJitCode *compile(FlintMethodInfo &methodInfo);
+    static bool compileInstruction(class FlintJitBuffer &buff, const FlintMethodInfo &methodInfo, const uint8_t *code, uint32_t pc);
+    static bool loadLayout(FlintConstUtf8 &type);
+    static int32_t arrayLength(class FlintJavaObject *obj);
+
+    FlintJit(void) = delete;
+    FlintJit(const FlintJit &) = delete;
+    void operator=(const FlintJit &) = delete;
+};
+
+#endif /* FLINT_JIT */
+
+#endif /* __FLINT_JIT_H */
@@ -5,14 +5,40 @@
 #include "flint_const_pool.h"
 #include "flint_attribute_info.h"
 
+#if __has_include("flint_conf.h")
+#include "flint_conf.h"
+#endif
+#include "flint_default_conf.h"
+
+typedef enum : uint8_t {
+    METHOD_INLINE_NONE = 0,
+    METHOD_INLINE_EMPTY,            /* return */
+    METHOD_INLINE_CONST,            /* push a constant, xreturn */
+    METHOD_INLINE_GETTER,           /* aload_0, getfield, xreturn */
+    METHOD_INLINE_SETTER,           /* aload_0, xload_1, putfield, return */
+    METHOD_INLINE_SUPER_INIT,       /* aload_0, invokespecial <init>, return */
+} FlintMethodInlineKind;
+
 class FlintMethodInfo {
 public:
     const FlintMethodAccessFlag accessFlag;
     class FlintClassLoader &classLoader;
     FlintConstUtf8 &name;
     FlintConstUtf8 &descriptor;
+    const uint8_t argc;
+    const uint8_t retType;
+    const uint8_t retSlots;
+    const uint16_t frameSize;
+    const FlintMethodInlineKind inlineKind;
+    const uint16_t inlineValue;
+#if FLINT_JIT
+    uint16_t hotCount;
+    class FlintJitCode * volatile jitCode;
+#endif
 private:
     FlintAttribute *attributes;
+    FlintCodeAttribute *attributeCode;
+    FlintNativeAttribute *attributeNative;
 
     FlintMethodInfo(FlintClassLoader &classLoader, FlintMethodAccessFlag accessFlag, FlintConstUtf8 &name, FlintConstUtf8 &descriptor);
 
@@ -20,6 +46,7 @@ private:
     void operator=(const FlintMethodInfo &) = delete;
 
     void addAttribute(FlintAttribute *attribute);
+    bool bindNativeMethod(const class FlintNativeClass * const *classList, uint32_t count);
 
     friend class FlintClassLoader;
 public:
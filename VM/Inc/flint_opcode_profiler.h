@@ -0,0 +1,29 @@
+
+#ifndef __FLINT_OPCODE_PROFILER_H
+#define __FLINT_OPCODE_PROFILER_H
+
+#include "flint_std_types.h"
+
+class FlintOpcodeSequence {
+public:
+    uint8_t length;
+    uint8_t opcodes[3];
+    uint32_t count;
+};
+
+class FlintOpcodeProfiler {
+public:
+    /* history holds the last three executed opcodes, the newest one in the lowest byte */
+    static void record(uint32_t history);
+
+    static uint32_t getCount(const uint8_t *opcodes, uint8_t length);
+    static uint32_t getHotSequences(FlintOpcodeSequence *buff, uint32_t maxCount);
+    static void print(uint32_t maxCount);
+    static void reset(void);
+private:
+    FlintOpcodeProfiler(void) = delete;
+    FlintOpcodeProfiler(const FlintOpcodeProfiler &) = delete;
+    void operator=(const FlintOpcodeProfiler &) = delete;
+};
+
+#endif /* __FLINT_OPCODE_PROFILER_H */
@@ -232,6 +232,54 @@ typedef enum : uint8_t {
     OP_JSRW = 0xC9,
     OP_BREAKPOINT = 0xCA,
 
+    /* Quick opcodes, the interpreter rewrites the original opcodes into these after resolving them */
+    OP_LDC_QUICK = 0xCB,
+    OP_LDC_W_QUICK = 0xCC,
+    OP_ALDC_QUICK = 0xCD,
+    OP_ALDC_W_QUICK = 0xCE,
+    OP_LDC2_W_QUICK = 0xCF,
+
+    OP_IGETSTATIC_QUICK = 0xD0,
+    OP_LGETSTATIC_QUICK = 0xD1,
+    OP_AGETSTATIC_QUICK = 0xD2,
+    OP_BPUTSTATIC_QUICK = 0xD3,
+    OP_SPUTSTATIC_QUICK = 0xD4,
+    OP_IPUTSTATIC_QUICK = 0xD5,
+    OP_LPUTSTATIC_QUICK = 0xD6,
+    OP_APUTSTATIC_QUICK = 0xD7,
+
+    OP_IGETFIELD_QUICK = 0xD8,
+    OP_LGETFIELD_QUICK = 0xD9,
+    OP_AGETFIELD_QUICK = 0xDA,
+    OP_BPUTFIELD_QUICK = 0xDB,
+    OP_SPUTFIELD_QUICK = 0xDC,
+    OP_IPUTFIELD_QUICK = 0xDD,
+    OP_LPUTFIELD_QUICK = 0xDE,
+    OP_APUTFIELD_QUICK = 0xDF,
+
+    OP_INVOKEVIRTUAL_QUICK = 0xE0,
+    OP_INVOKESPECIAL_QUICK = 0xE1,
+    OP_INVOKESTATIC_QUICK = 0xE2,
+
+    /* Superinstructions, the class loader fuses hot opcode sequences into these */
+    OP_ALOAD_0_GETFIELD = 0xE4,
+    OP_ILOAD_ILOAD_IADD_ISTORE = 0xE5,
+    OP_ILOAD_ILOAD_IADD_ISTORE_W = 0xE6,
+    OP_IINC_GOTO = 0xE7,
+    OP_ALOAD_ARRAYLENGTH_IF_ICMPGE = 0xE8,
+    OP_ALOAD_N_ARRAYLENGTH_IF_ICMPGE = 0xE9,
+
+    /* invokevirtual bound to a single target by class hierarchy analysis */
+    OP_INVOKEVIRTUAL_DIRECT = 0xEA,
+
+    /* Register forms of int sequences, operands are local indexes instead of stack slots */
+    OP_IREG_ARITH = 0xEB,
+    OP_IREG_ARITH_IMM = 0xEC,
+    OP_IREG_IF_ICMP = 0xED,
+
+    /* String.hashCode followed by the lookupswitch and equals chain javac emits for a switch on strings */
+    OP_STRING_SWITCH = 0xEE,
+
     OP_EXIT = 0xFF,
 } FlintOpCode;
 
@@ -74,6 +74,12 @@ namespace FlintAPI {
         void sleep(uint32_t ms);
         void yield(void);
     };
+
+    namespace Jit {
+        /* The memory must be writable and executable, only used with FLINT_JIT */
+        void *allocCode(uint32_t size);
+        void freeCode(void *code);
+    };
 };
 
 #endif /* __FLINT_SYSTEM_API_H */
@@ -71,6 +71,7 @@ typedef enum : uint16_t {
     METHOD_ABSTRACT = 0x0400,
     METHOD_STRICT = 0x0800,
     METHOD_SYNTHETIC = 0x1000,
+    METHOD_OVERRIDDEN = 0x8000,
 } FlintMethodAccessFlag;
 
 typedef enum : uint16_t {
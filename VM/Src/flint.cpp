@@ -68,6 +68,9 @@ Flint::Flint(void) {
     constStringList = 0;
     objectSizeToGc = 0;
     constUtf8List = 0;
+    interfaceIdCount = 0;
+    outOfMemoryError = 0;
+    stackOverflowError = 0;
 }
 
 FlintDebugger *Flint::getDebugger(void) const {
@@ -86,6 +89,11 @@ void Flint::print(const char *text, uint32_t length, uint8_t coder) {
 }
 
 FlintExecution &Flint::newExecution(FlintJavaThread *onwerThread) {
+    /* The errors are created before they are needed, there would be no memory or stack left to create them later */
+    if(outOfMemoryError == 0)
+        outOfMemoryError = newVmError("not enough memory to allocate", *(FlintConstUtf8 *)&outOfMemoryErrorClassName);
+    if(stackOverflowError == 0)
+        stackOverflowError = newVmError("Stack overflow", *(FlintConstUtf8 *)&stackOverflowErrorClassName);
     FlintExecutionNode *newNode = (FlintExecutionNode *)Flint::malloc(sizeof(FlintExecutionNode));
     new (newNode)FlintExecutionNode(*this, onwerThread);
     lock();
@@ -98,6 +106,10 @@ FlintExecution &Flint::newExecution(FlintJavaThread *onwerThread) {
 }
 
 FlintExecution &Flint::newExecution(FlintJavaThread *onwerThread, uint32_t stackSize) {
+    if(outOfMemoryError == 0)
+        outOfMemoryError = newVmError("not enough memory to allocate", *(FlintConstUtf8 *)&outOfMemoryErrorClassName);
+    if(stackOverflowError == 0)
+        stackOverflowError = newVmError("Stack overflow", *(FlintConstUtf8 *)&stackOverflowErrorClassName);
     FlintExecutionNode *newNode = (FlintExecutionNode *)Flint::malloc(sizeof(FlintExecutionNode));
     new (newNode)FlintExecutionNode(*this, onwerThread, stackSize);
     lock();
@@ -136,7 +148,15 @@ FlintJavaObject &Flint::newObject(uint32_t size, FlintConstUtf8 &type, uint8_t d
     objectSizeToGc += size;
     if(objectSizeToGc >= OBJECT_SIZE_TO_GC)
         garbageCollection();
-    FlintJavaObject *newNode = (FlintJavaObject *)Flint::malloc(sizeof(FlintJavaObject) + size);
+    FlintJavaObject *newNode;
+    try {
+        newNode = (FlintJavaObject *)Flint::malloc(sizeof(FlintJavaObject) + size);
+    }
+    catch(FlintOutOfMemoryError *err) {
+        if(outOfMemoryError)
+            throw outOfMemoryError;
+        throw;
+    }
     new (newNode)FlintJavaObject(size, type, dimensions);
 
     Flint::lock();
@@ -151,16 +171,31 @@ FlintJavaObject &Flint::newObject(uint32_t size, FlintConstUtf8 &type, uint8_t d
 }
 
 FlintJavaObject &Flint::newObject(FlintConstUtf8 &type) {
-    FlintJavaObject &obj = newObject(sizeof(FlintFieldsData), type, 0);
-    memset(obj.data, 0, sizeof(FlintFieldsData));
+    ClassData &classData = *(ClassData *)&load(type);
+    uint32_t size = getObjectSize(classData);
+    FlintJavaObject &obj = newObject(size, type, 0);
+    memset(obj.data, 0, size);
 
     /* init field data */
     FlintFieldsData *fields = (FlintFieldsData *)obj.data;
-    new (fields)FlintFieldsData(*this, load(type), false);
+    new (fields)FlintFieldsData(*this, classData, false);
 
     return obj;
 }
 
+uint32_t Flint::getObjectSize(ClassData &classData) {
+    if(classData.objectSize == 0) {
+        /* Throwables keep their VM data after the fields */
+        bool isThrowable = (classData.getThisClass() == throwableClassName);
+        for(FlintClassLoader *node = &classData; !isThrowable && &node->getSuperClass();) {
+            isThrowable = (node->getSuperClass() == throwableClassName);
+            node = &load(node->getSuperClass());
+        }
+        classData.objectSize = sizeof(FlintFieldsData) + (isThrowable ? sizeof(FlintThrowableData) : 0);
+    }
+    return classData.objectSize;
+}
+
 FlintInt8Array &Flint::newBooleanArray(uint32_t length) {
     return *(FlintInt8Array *)&newObject(length, *(FlintConstUtf8 *)primTypeConstUtf8List[0], 1);
 }
@@ -491,6 +526,89 @@ FlintJavaThrowable &Flint::newThrowable(FlintJavaString *strObj, FlintConstUtf8
     return obj;
 }
 
+FlintJavaThrowable &Flint::newThrowable(const FlintVmMessage &message, FlintConstUtf8 &excpType) {
+    FlintJavaThrowable &obj = *(FlintJavaThrowable *)&newObject(excpType);
+
+    /* The message only becomes a string when it is read */
+    FlintThrowableData *throwableData = obj.getThrowableData();
+    if(throwableData)
+        throwableData->message = message;
+
+    return obj;
+}
+
+FlintJavaThrowable *Flint::newVmError(const char *text, FlintConstUtf8 &excpType) {
+    FlintVmMessage message = {};
+    message.kind = VM_MESSAGE_TEXT;
+    message.count = 1;
+    message.texts[0] = text;
+    try {
+        FlintJavaThrowable &obj = newThrowable(message, excpType);
+        /* The instance is shared by every throw, a trace would only describe the first one */
+        FlintThrowableData *throwableData = obj.getThrowableData();
+        if(throwableData)
+            throwableData->isTraceFilled = 1;
+        return &obj;
+    }
+    catch(...) {
+        return 0;
+    }
+}
+
+FlintJavaThrowable *Flint::getOutOfMemoryError(void) const {
+    return outOfMemoryError;
+}
+
+FlintJavaThrowable *Flint::getStackOverflowError(void) const {
+    return stackOverflowError;
+}
+
+void Flint::setStackTraceEnabled(const char *className, uint16_t length, bool isEnabled) {
+    ClassData &classData = *(ClassData *)&load(className, length);
+    classData.isStackTraceDisabled = !isEnabled;
+}
+
+bool Flint::isStackTraceEnabled(ClassData &classData) {
+    /* Disabling the trace of a class also disables it for its subclasses */
+    if(classData.superDisplay == 0)
+        buildTypeInfo(classData);
+    for(uint16_t i = classData.superDepth; i > 0; i--) {
+        if(classData.superDisplay[i]->isStackTraceDisabled)
+            return false;
+    }
+    return true;
+}
+
+FlintObjectArray &Flint::newStackTrace(FlintJavaThrowable &throwable) {
+    FlintThrowableData *throwableData = throwable.getThrowableData();
+    FlintInt32Array *backtrace = throwableData ? throwableData->backtrace : 0;
+    uint32_t count = backtrace ? (backtrace->getLength() / 2) : 0;
+    FlintObjectArray &array = newObjectArray(*(FlintConstUtf8 *)&stackTraceElementClassName, count);
+    memset(array.getData(), 0, count * sizeof(FlintJavaObject *));
+    for(uint32_t i = 0; i < count; i++) {
+        FlintMethodInfo &traceMethod = *(FlintMethodInfo *)backtrace->getData()[i * 2];
+        uint32_t tracePc = backtrace->getData()[i * 2 + 1];
+        FlintConstUtf8 &className = traceMethod.classLoader.getThisClass();
+        FlintJavaObject &element = newObject(*(FlintConstUtf8 *)&stackTraceElementClassName);
+        FlintFieldsData &fields = element.getFields();
+
+        /* The line number and the strings are only looked up here, when the trace is read */
+        FlintFieldObject *declaringClass = &fields.getFieldObject("declaringClass");
+        FlintFieldObject *methodName = &fields.getFieldObject("methodName");
+        FlintFieldData32 *lineNumber = &fields.getFieldData32("lineNumber");
+        Flint::lock();
+        if(declaringClass)
+            declaringClass->object = &getConstClass(className.text, className.length).getName();
+        if(methodName)
+            methodName->object = &getConstString(traceMethod.name);
+        Flint::unlock();
+        if(lineNumber)
+            lineNumber->value = traceMethod.getAttributeCode().getLineNumber(tracePc);
+        array.getData()[i] = &element;
+    }
+    return array;
+}
+
 FlintJavaThrowable &Flint::newException(FlintJavaString *strObj) {
     return newThrowable(strObj, *(FlintConstUtf8 *)&exceptionClassName);
 }
@@ -551,6 +669,44 @@ FlintJavaThrowable &Flint::newUnsatisfiedLinkErrorException(FlintJavaString *str
     return newThrowable(strObj, *(FlintConstUtf8 *)&unsatisfiedLinkErrorClassName);
 }
 
+static FlintVmMessage textMessage(const char *texts[], uint8_t count) {
+    FlintVmMessage message = {};
+    message.kind = VM_MESSAGE_TEXT;
+    message.count = (count < LENGTH(message.texts)) ? count : LENGTH(message.texts);
+    for(uint8_t i = 0; i < message.count; i++)
+        message.texts[i] = texts[i];
+    return message;
+}
+
+FlintJavaThrowable &Flint::newArithmeticException(const char *texts[], uint8_t count) {
+    return newThrowable(textMessage(texts, count), *(FlintConstUtf8 *)&arithmeticExceptionClassName);
+}
+
+FlintJavaThrowable &Flint::newNullPointerException(const char *texts[], uint8_t count) {
+    return newThrowable(textMessage(texts, count), *(FlintConstUtf8 *)&nullPointerExceptionClassName);
+}
+
+FlintJavaThrowable &Flint::newNegativeArraySizeException(const char *texts[], uint8_t count) {
+    return newThrowable(textMessage(texts, count), *(FlintConstUtf8 *)&negativeArraySizeExceptionClassName);
+}
+
+FlintJavaThrowable &Flint::newArrayIndexOutOfBoundsException(int32_t index, uint32_t length) {
+    FlintVmMessage message = {};
+    message.kind = VM_MESSAGE_INDEX;
+    message.index = index;
+    message.length = length;
+    return newThrowable(message, *(FlintConstUtf8 *)&arrayIndexOutOfBoundsExceptionClassName);
+}
+
+FlintJavaThrowable &Flint::newClassCastException(FlintJavaObject &obj, FlintConstUtf8 &type) {
+    FlintVmMessage message = {};
+    message.kind = VM_MESSAGE_CLASS_CAST;
+    message.count = obj.dimensions;
+    message.fromType = &obj.type;
+    message.toType = &type;
+    return newThrowable(message, *(FlintConstUtf8 *)&classCastExceptionClassName);
+}
+
 FlintJavaBoolean &Flint::newBoolean(bool value) {
     FlintJavaBoolean &obj = *(FlintJavaBoolean *)&newObject(*(FlintConstUtf8 *)&booleanClassName);
     obj.setValue(value);
@@ -616,6 +772,10 @@ void Flint::clearProtectObjectNew(FlintJavaObject &obj) {
             if(tmp && (tmp->getProtected() & 0x02))
                 clearProtectObjectNew(*tmp);
         }
+        FlintThrowableData *throwableData = ((FlintJavaThrowable &)obj).getThrowableData();
+        FlintJavaObject *backtrace = throwableData ? (FlintJavaObject *)throwableData->backtrace : 0;
+        if(backtrace && (backtrace->getProtected() & 0x02))
+            clearProtectObjectNew(*backtrace);
     }
     obj.clearProtected();
 }
@@ -638,9 +798,119 @@ void Flint::garbageCollectionProtectObject(FlintJavaObject &obj) {
             if(tmp && !tmp->getProtected())
                 garbageCollectionProtectObject(*tmp);
         }
+        FlintThrowableData *throwableData = ((FlintJavaThrowable &)obj).getThrowableData();
+        FlintJavaObject *backtrace = throwableData ? (FlintJavaObject *)throwableData->backtrace : 0;
+        if(backtrace && !backtrace->getProtected())
+            garbageCollectionProtectObject(*backtrace);
     }
 }
 
+#if FLINT_GC_CONSERVATIVE_STACK
+static void siftDown(uint32_t *values, uint32_t root, uint32_t end) {
+    while(root * 2 + 1 < end) {
+        uint32_t child = root * 2 + 1;
+        if(child + 1 < end && values[child] < values[child + 1])
+            child++;
+        if(values[root] >= values[child])
+            return;
+        uint32_t tmp = values[root];
+        values[root] = values[child];
+        values[child] = tmp;
+        root = child;
+    }
+}
+
+static void sortValues(uint32_t *values, uint32_t count) {
+    for(uint32_t i = count / 2; i > 0; i--)
+        siftDown(values, i - 1, count);
+    for(uint32_t end = count; end > 1; end--) {
+        uint32_t tmp = values[0];
+        values[0] = values[end - 1];
+        values[end - 1] = tmp;
+        siftDown(values, 0, end - 1);
+    }
+}
+
+static bool containsValue(const uint32_t *values, uint32_t count, uint32_t value) {
+    uint32_t low = 0;
+    while(low < count) {
+        uint32_t mid = (low + count) / 2;
+        if(values[mid] == value)
+            return true;
+        else if(values[mid] < value)
+            low = mid + 1;
+        else
+            count = mid;
+    }
+    return false;
+}
+
+bool Flint::isObject(uint32_t value) {
+    Flint::lock();
+    for(FlintJavaObject *node = objectList; node != 0; node = node->next) {
+        if((uint32_t)node == value) {
+            Flint::unlock();
+            return true;
+        }
+    }
+    Flint::unlock();
+    return false;
+}
+
+void Flint::garbageCollectionProtectStacks(void) {
+    /* Slots carry no type, any slot holding the address of a live object keeps that object alive */
+    if(objectList == 0)
+        return;
+    uint32_t minAddress = 0xFFFFFFFF;
+    uint32_t maxAddress = 0;
+    for(FlintJavaObject *node = objectList; node != 0; node = node->next) {
+        minAddress = FLINT_MIN(minAddress, (uint32_t)node);
+        maxAddress = FLINT_MAX(maxAddress, (uint32_t)node);
+    }
+    uint32_t count = 0;
+    for(FlintExecutionNode *node = executionList; node != 0; node = node->next) {
+        for(int32_t i = 0; i <= node->peakSp; i++) {
+            uint32_t value = node->stack[i];
+            if(minAddress <= value && value <= maxAddress)
+                count++;
+        }
+    }
+    if(count == 0)
+        return;
+    /* Not Flint::malloc, running out of memory here must not start another collection */
+    uint32_t *values = (uint32_t *)FlintAPI::System::malloc(count * sizeof(uint32_t));
+    if(values) {
+        count = 0;
+        for(FlintExecutionNode *node = executionList; node != 0; node = node->next) {
+            for(int32_t i = 0; i <= node->peakSp; i++) {
+                uint32_t value = node->stack[i];
+                if(minAddress <= value && value <= maxAddress)
+                    values[count++] = value;
+            }
+        }
+        sortValues(values, count);
+        for(FlintJavaObject *node = objectList; node != 0; node = node->next) {
+            if(!node->getProtected() && containsValue(values, count, (uint32_t)node))
+                garbageCollectionProtectObject(*node);
+        }
+        FlintAPI::System::free(values);
+    }
+    else {
+        /* Slow path without the sorted copy */
+        for(FlintJavaObject *node = objectList; node != 0; node = node->next) {
+            for(FlintExecutionNode *exec = executionList; exec != 0 && !node->getProtected(); exec = exec->next) {
+                for(int32_t i = 0; i <= exec->peakSp; i++) {
+                    if((uint32_t)exec->stack[i] == (uint32_t)node) {
+                        garbageCollectionProtectObject(*node);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+}
+#endif
+
 void Flint::garbageCollection(void) {
     Flint::lock();
     objectSizeToGc = 0;
@@ -662,9 +932,14 @@ void Flint::garbageCollection(void) {
             }
         }
     }
+    if(outOfMemoryError && !outOfMemoryError->getProtected())
+        garbageCollectionProtectObject(*outOfMemoryError);
+    if(stackOverflowError && !stackOverflowError->getProtected())
+        garbageCollectionProtectObject(*stackOverflowError);
     for(FlintExecutionNode *node = executionList; node != 0; node = node->next) {
         if(node->onwerThread && !node->onwerThread->getProtected())
             garbageCollectionProtectObject(*node->onwerThread);
+#if !FLINT_GC_CONSERVATIVE_STACK
         for(int32_t i = 0; i <= node->peakSp; i++) {
             if(node->getStackType(i) == STACK_TYPE_OBJECT) {
                 FlintJavaObject *obj = (FlintJavaObject *)node->stack[i];
@@ -672,7 +947,11 @@ void Flint::garbageCollection(void) {
                     garbageCollectionProtectObject(*obj);
             }
         }
+#endif
     }
+#if FLINT_GC_CONSERVATIVE_STACK
+    garbageCollectionProtectStacks();
+#endif
     for(FlintJavaObject *node = objectList; node != 0;) {
         FlintJavaObject *next = node->next;
         uint8_t prot = node->getProtected();
@@ -714,6 +993,8 @@ FlintClassLoader &Flint::load(const char *className, uint16_t length) {
         newNode = (ClassData *)Flint::malloc(sizeof(ClassData));
         newNode->staticFieldsData = 0;
         new (newNode)ClassData(*this, className, length);
+        /* Devirtualized call sites must see the overrides before any thread can use the new class */
+        markOverriddenMethods(*newNode);
         newNode->next = classDataList;
         classDataList = newNode;
         Flint::unlock();
@@ -746,6 +1027,7 @@ FlintClassLoader &Flint::load(FlintConstUtf8 &className) {
         newNode = (ClassData *)Flint::malloc(sizeof(ClassData));
         newNode->staticFieldsData = 0;
         new (newNode)ClassData(*this, className.text, className.length);
+        markOverriddenMethods(*newNode);
         newNode->next = classDataList;
         classDataList = newNode;
         Flint::unlock();
@@ -789,56 +1071,394 @@ FlintMethodInfo &Flint::findMethod(FlintConstMethod &constMethod) {
     throw "can't find the method";
 }
 
+void Flint::buildVtable(ClassData &classData) {
+    ClassData *superClass = 0;
+    if(&classData.getSuperClass()) {
+        superClass = (ClassData *)&load(classData.getSuperClass());
+        if(superClass->vtable == 0)
+            buildVtable(*superClass);
+    }
+    uint16_t superSize = superClass ? superClass->vtableSize : 0;
+    uint16_t methodsCount = classData.getMethodsCount();
+    uint16_t vtableSize = superSize;
+    FlintMethodInfo **vtable = (FlintMethodInfo **)Flint::malloc((superSize + methodsCount + 1) * sizeof(FlintMethodInfo *));
+    if(superSize)
+        memcpy(vtable, superClass->vtable, superSize * sizeof(FlintMethodInfo *));
+    for(uint16_t i = 0; i < methodsCount; i++) {
+        FlintMethodInfo &methodInfo = classData.getMethodInfo(i);
+        if((methodInfo.accessFlag & (METHOD_STATIC | METHOD_PRIVATE | METHOD_BRIDGE)) || methodInfo.name.text[0] == '<')
+            continue;
+        uint16_t index = 0;
+        while(index < superSize && (vtable[index]->name != methodInfo.name || vtable[index]->descriptor != methodInfo.descriptor))
+            index++;
+        if(index < superSize)
+            vtable[index] = &methodInfo;
+        else
+            vtable[vtableSize++] = &methodInfo;
+    }
+    if(vtableSize < superSize + methodsCount)
+        vtable = (FlintMethodInfo **)Flint::realloc(vtable, (vtableSize + 1) * sizeof(FlintMethodInfo *));
+    Flint::lock();
+    if(classData.vtable == 0) {
+        classData.vtableSize = vtableSize;
+        classData.vtable = vtable;
+        vtable = 0;
+    }
+    Flint::unlock();
+    if(vtable)
+        Flint::free(vtable);
+}
+
+uint16_t Flint::getVtableIndex(FlintConstMethod &constMethod) {
+    if(constMethod.className.text[0] == '[')
+        return VTABLE_INDEX_NONE;
+    ClassData &classData = *(ClassData *)&load(constMethod.className);
+    if(classData.vtable == 0)
+        buildVtable(classData);
+    for(uint16_t i = 0; i < classData.vtableSize; i++) {
+        FlintMethodInfo *methodInfo = classData.vtable[i];
+        if(methodInfo->name == constMethod.nameAndType.name && methodInfo->descriptor == constMethod.nameAndType.descriptor)
+            return i;
+    }
+    return VTABLE_INDEX_NONE;
+}
+
+static void addInterface(Flint &flint, ClassData &interfaceClass, ClassData **&list, uint16_t &count, uint16_t &capacity) {
+    for(uint16_t i = 0; i < count; i++) {
+        if(list[i] == &interfaceClass)
+            return;
+    }
+    if(count == capacity) {
+        capacity *= 2;
+        list = (ClassData **)Flint::realloc(list, capacity * sizeof(ClassData *));
+    }
+    list[count++] = &interfaceClass;
+    for(uint16_t i = 0; i < interfaceClass.getInterfacesCount(); i++)
+        addInterface(flint, *(ClassData *)&flint.load(interfaceClass.getInterface(i)), list, count, capacity);
+}
+
+static bool isSubInterface(Flint &flint, FlintClassLoader &interfaceClass, FlintClassLoader &superInterface) {
+    for(uint16_t i = 0; i < interfaceClass.getInterfacesCount(); i++) {
+        FlintClassLoader &loader = flint.load(interfaceClass.getInterface(i));
+        if(&loader == &superInterface || isSubInterface(flint, loader, superInterface))
+            return true;
+    }
+    return false;
+}
+
+static FlintMethodInfo *selectInterfaceTarget(Flint &flint, ClassData &classData, ClassData **list, uint16_t count, FlintMethodInfo &methodInfo) {
+    for(uint16_t i = 0; i < classData.vtableSize; i++) {
+        FlintMethodInfo *target = classData.vtable[i];
+        if(target->name == methodInfo.name && target->descriptor == methodInfo.descriptor) {
+            if(!(target->accessFlag & METHOD_ABSTRACT))
+                return target;
+            break;
+        }
+    }
+    /* No concrete class method, use the most specific default method */
+    FlintMethodInfo *target = 0;
+    for(uint16_t i = 0; i < count; i++) {
+        FlintMethodInfo *defaultMethod = &list[i]->getMethodInfo(methodInfo.name, methodInfo.descriptor);
+        if(defaultMethod == 0 || (defaultMethod->accessFlag & (METHOD_ABSTRACT | METHOD_STATIC | METHOD_PRIVATE)))
+            continue;
+        if(target == 0 || isSubInterface(flint, *list[i], target->classLoader))
+            target = defaultMethod;
+    }
+    return target;
+}
+
+static void freeItable(FlintItableEntry *itable, uint16_t count) {
+    for(uint16_t i = 0; i < count; i++) {
+        if(itable[i].methods)
+            Flint::free(itable[i].methods);
+    }
+    Flint::free(itable);
+}
+
+void Flint::buildItable(ClassData &classData) {
+    if(classData.vtable == 0)
+        buildVtable(classData);
+    uint16_t count = 0;
+    uint16_t capacity = 4;
+    ClassData **list = (ClassData **)Flint::malloc(capacity * sizeof(ClassData *));
+    FlintItableEntry *itable = 0;
+    try {
+        if(&classData.getSuperClass()) {
+            ClassData &superClass = *(ClassData *)&load(classData.getSuperClass());
+            if(superClass.itable == 0)
+                buildItable(superClass);
+            for(uint16_t i = 0; i < superClass.itableSize; i++)
+                addInterface(*this, *(ClassData *)superClass.itable[i].interfaceClass, list, count, capacity);
+        }
+        for(uint16_t i = 0; i < classData.getInterfacesCount(); i++)
+            addInterface(*this, *(ClassData *)&load(classData.getInterface(i)), list, count, capacity);
+
+        itable = (FlintItableEntry *)Flint::malloc((count + 1) * sizeof(FlintItableEntry));
+        memset(itable, 0, (count + 1) * sizeof(FlintItableEntry));
+        for(uint16_t i = 0; i < count; i++) {
+            ClassData &interfaceClass = *list[i];
+            uint16_t methodsCount = interfaceClass.getMethodsCount();
+            itable[i].interfaceClass = &interfaceClass;
+            if(methodsCount == 0)
+                continue;
+            itable[i].methods = (FlintMethodInfo **)Flint::malloc(methodsCount * sizeof(FlintMethodInfo *));
+            for(uint16_t k = 0; k < methodsCount; k++) {
+                FlintMethodInfo &methodInfo = interfaceClass.getMethodInfo(k);
+                if((methodInfo.accessFlag & (METHOD_STATIC | METHOD_PRIVATE)) || methodInfo.name.text[0] == '<')
+                    itable[i].methods[k] = 0;
+                else
+                    itable[i].methods[k] = selectInterfaceTarget(*this, classData, list, count, methodInfo);
+            }
+        }
+    }
+    catch(...) {
+        if(itable)
+            freeItable(itable, count);
+        Flint::free(list);
+        throw;
+    }
+    Flint::free(list);
+    Flint::lock();
+    if(classData.itable == 0) {
+        classData.itableSize = count;
+        classData.itable = itable;
+        itable = 0;
+    }
+    Flint::unlock();
+    if(itable)
+        freeItable(itable, count);
+}
+
+static FlintMethodInfo *findInterfaceMethod(Flint &flint, FlintClassLoader &loader, FlintConstNameAndType &nameAndType) {
+    FlintMethodInfo *methodInfo = &loader.getMethodInfo(nameAndType);
+    if(methodInfo && !(methodInfo->accessFlag & METHOD_STATIC))
+        return methodInfo;
+    for(uint16_t i = 0; i < loader.getInterfacesCount(); i++) {
+        methodInfo = findInterfaceMethod(flint, flint.load(loader.getInterface(i)), nameAndType);
+        if(methodInfo)
+            return methodInfo;
+    }
+    return 0;
+}
+
+void Flint::resolveInterfaceMethod(FlintConstMethod &constMethod) {
+    FlintMethodInfo *methodInfo = findInterfaceMethod(*this, load(constMethod.className), constMethod.nameAndType);
+    if(methodInfo == 0 || (methodInfo->accessFlag & METHOD_PRIVATE)) {
+        /* e.g. methods of java.lang.Object called through an interface */
+        constMethod.vtableIndex = VTABLE_INDEX_NONE;
+        return;
+    }
+    constMethod.methodInfo = methodInfo;
+    constMethod.vtableIndex = methodInfo - &methodInfo->classLoader.getMethodInfo((uint16_t)0);
+}
+
+void Flint::markOverriddenMethods(FlintClassLoader &classLoader) {
+    if(&classLoader.getSuperClass() == 0 || (classLoader.getAccessFlag() & CLASS_INTERFACE))
+        return;
+    try {
+        FlintClassLoader &superClass = load(classLoader.getSuperClass());
+        uint16_t methodsCount = classLoader.getMethodsCount();
+        for(uint16_t i = 0; i < methodsCount; i++) {
+            FlintMethodInfo &methodInfo = classLoader.getMethodInfo(i);
+            if((methodInfo.accessFlag & (METHOD_STATIC | METHOD_PRIVATE)) || methodInfo.name.text[0] == '<')
+                continue;
+            for(FlintClassLoader *loader = &superClass; loader != 0;) {
+                FlintMethodInfo *superMethod = &loader->getMethodInfo(methodInfo.name, methodInfo.descriptor);
+                if(superMethod && !(superMethod->accessFlag & (METHOD_STATIC | METHOD_PRIVATE))) {
+                    /* Call sites bound to this method by canDevirtualize go back to virtual dispatch */
+                    *(uint16_t *)&superMethod->accessFlag |= METHOD_OVERRIDDEN;
+                    break;
+                }
+                loader = &loader->getSuperClass() ? &load(loader->getSuperClass()) : (FlintClassLoader *)0;
+            }
+        }
+    }
+    catch(FlintLoadFileError *file) {
+        /* Without its superclass the class can not be instantiated, nothing to invalidate */
+    }
+}
+
+bool Flint::canDevirtualize(FlintConstMethod &constMethod) {
+    if(constMethod.className.text[0] == '[')
+        return false;
+    try {
+        if(constMethod.methodInfo == 0)
+            constMethod.methodInfo = &findMethod(constMethod);
+    }
+    catch(FlintLoadFileError *file) {
+        return false;
+    }
+    catch(const char *msg) {
+        return false;
+    }
+    FlintMethodInfo &methodInfo = *constMethod.methodInfo;
+    if(methodInfo.accessFlag & (METHOD_STATIC | METHOD_ABSTRACT | METHOD_SYNCHRONIZED))
+        return false;
+    if((methodInfo.accessFlag & (METHOD_FINAL | METHOD_PRIVATE)) || (methodInfo.classLoader.getAccessFlag() & CLASS_FINAL))
+        return true;
+    /* No loaded class overrides the method, so every receiver reaching this site runs it */
+    return !(methodInfo.accessFlag & METHOD_OVERRIDDEN);
+}
+
+void Flint::buildTypeInfo(ClassData &classData) {
+    ClassData *superClass = 0;
+    if(&classData.getSuperClass()) {
+        superClass = (ClassData *)&load(classData.getSuperClass());
+        if(superClass->superDisplay == 0)
+            buildTypeInfo(*superClass);
+    }
+    uint16_t interfaceId = 0;
+    if(classData.getAccessFlag() & CLASS_INTERFACE) {
+        Flint::lock();
+        if(classData.interfaceId == 0)
+            classData.interfaceId = ++interfaceIdCount;
+        interfaceId = classData.interfaceId;
+        Flint::unlock();
+    }
+    uint16_t interfaceWords = superClass ? superClass->interfaceWords : 0;
+    if(interfaceId && interfaceWords <= (interfaceId >> 5))
+        interfaceWords = (interfaceId >> 5) + 1;
+    uint16_t interfacesCount = classData.getInterfacesCount();
+    for(uint16_t i = 0; i < interfacesCount; i++) {
+        ClassData &interfaceClass = *(ClassData *)&load(classData.getInterface(i));
+        if(interfaceClass.superDisplay == 0)
+            buildTypeInfo(interfaceClass);
+        if(interfaceWords < interfaceClass.interfaceWords)
+            interfaceWords = interfaceClass.interfaceWords;
+    }
+
+    uint16_t depth = superClass ? (superClass->superDepth + 1) : 0;
+    ClassData **superDisplay = (ClassData **)Flint::malloc((depth + 1) * sizeof(ClassData *));
+    if(depth)
+        memcpy(superDisplay, superClass->superDisplay, depth * sizeof(ClassData *));
+    superDisplay[depth] = &classData;
+
+    uint32_t *interfaceBits = 0;
+    if(interfaceWords) {
+        try {
+            interfaceBits = (uint32_t *)Flint::malloc(interfaceWords * sizeof(uint32_t));
+        }
+        catch(...) {
+            Flint::free(superDisplay);
+            throw;
+        }
+        memset(interfaceBits, 0, interfaceWords * sizeof(uint32_t));
+        if(superClass) {
+            for(uint16_t k = 0; k < superClass->interfaceWords; k++)
+                interfaceBits[k] |= superClass->interfaceBits[k];
+        }
+        for(uint16_t i = 0; i < interfacesCount; i++) {
+            ClassData &interfaceClass = *(ClassData *)&load(classData.getInterface(i));
+            for(uint16_t k = 0; k < interfaceClass.interfaceWords; k++)
+                interfaceBits[k] |= interfaceClass.interfaceBits[k];
+        }
+        if(interfaceId)
+            interfaceBits[interfaceId >> 5] |= 1 << (interfaceId & 0x1F);
+    }
+
+    Flint::lock();
+    if(classData.superDisplay == 0) {
+        classData.superDepth = depth;
+        classData.interfaceWords = interfaceWords;
+        classData.interfaceBits = interfaceBits;
+        classData.superDisplay = superDisplay;
+        interfaceBits = 0;
+        superDisplay = 0;
+    }
+    Flint::unlock();
+    if(superDisplay)
+        Flint::free(superDisplay);
+    if(interfaceBits)
+        Flint::free(interfaceBits);
+}
+
+static bool isClassNameEquals(const FlintConstUtf8 &name, const char *text, uint16_t length) {
+    if(name.length != length)
+        return false;
+    for(uint16_t i = 0; i < length; i++) {
+        if(text[i] == name.text[i])
+            continue;
+        else if((text[i] == '.' && name.text[i] == '/') || (text[i] == '/' && name.text[i] == '.'))
+            continue;
+        return false;
+    }
+    return true;
+}
+
+ClassData *Flint::findLoadedClass(const char *typeName, uint16_t length) const {
+    for(ClassData *node = classDataList; node != 0; node = node->next) {
+        if(isClassNameEquals(node->getThisClass(), typeName, length))
+            return node;
+    }
+    return 0;
+}
+
+bool Flint::isSubclassOf(ClassData &classData, ClassData &superClass) {
+    if(&classData == &superClass)
+        return true;
+    if(classData.superDisplay == 0)
+        buildTypeInfo(classData);
+    if(superClass.superDisplay == 0)
+        buildTypeInfo(superClass);
+    if(superClass.getAccessFlag() & CLASS_INTERFACE) {
+        uint16_t id = superClass.interfaceId;
+        return ((id >> 5) < classData.interfaceWords) && (classData.interfaceBits[id >> 5] & (1 << (id & 0x1F)));
+    }
+    uint16_t depth = superClass.superDepth;
+    return (depth <= classData.superDepth) && (classData.superDisplay[depth] == &superClass);
+}
+
 bool Flint::isInstanceof(FlintJavaObject *obj, const char *typeName, uint16_t length) {
+    FlintConstClassCache cache = {0, 0};
+    return isInstanceof(obj, typeName, length, cache);
+}
+
+bool Flint::isInstanceof(FlintJavaObject *obj, const char *typeName, uint16_t length, FlintConstClassCache &cache) {
+    if(obj == 0)
+        return false;
     const char *text = typeName;
     while(*text == '[')
         text++;
     uint32_t dimensions = text - typeName;
     uint32_t len = length - dimensions;
-    if(*text == 'L') {
+    if(dimensions > 0 && *text == 'L') {
         text++;
         len -= 2;
     }
-    if(len == 16 && obj->dimensions >= dimensions) {
-        bool isEquals = true;
-        const char *text2 = objectClassName.text;
-        for(uint32_t i = 0; i < len; i++) {
-            if(text[i] == text2[i])
-                continue;
-            else if((text[i] == '.' && text2[i] == '/') || (text[i] == '/' && text2[i] == '.'))
-                continue;
-            isEquals = false;
-            break;
-        }
-        if(isEquals)
-            return true;
+    if(obj->dimensions != dimensions) {
+        if(obj->dimensions < dimensions)
+            return false;
+        /* The elements are arrays, which are only Object, Cloneable and Serializable */
+        return (
+            isClassNameEquals(objectClassName, text, len) ||
+            isClassNameEquals(cloneableClassName, text, len) ||
+            isClassNameEquals(serializableClassName, text, len)
+        );
     }
-    if(dimensions != obj->dimensions)
-        return false;
+    FlintConstUtf8 &objType = obj->type;
+    ClassData *objClass;
+    if(dimensions == 0)
+        objClass = (ClassData *)&obj->getFields().classLoader;
     else {
-        FlintConstUtf8 *objType = &obj->type;
-        if(FlintJavaObject::isPrimType(*objType) || ((len == 1) && (FlintJavaObject::convertToAType(text[0]))))
-            return (len == objType->length) && (text[0] == objType->text[0]);
-        while(1) {
-            if(len == objType->length) {
-                bool isEquals = true;
-                const char *text2 = objType->text;
-                for(uint32_t i = 0; i < len; i++) {
-                    if(text[i] == text2[i])
-                        continue;
-                    else if((text[i] == '.' && text2[i] == '/') || (text[i] == '/' && text2[i] == '.'))
-                        continue;
-                    isEquals = false;
-                    break;
-                }
-                if(isEquals)
-                    return true;
-            }
-            objType = &load(*objType).getSuperClass();
-            if(objType == 0)
-                return false;
+        if(FlintJavaObject::isPrimType(objType) || ((len == 1) && (FlintJavaObject::convertToAType(text[0]))))
+            return (len == objType.length) && (text[0] == objType.text[0]);
+        objClass = cache.arrayClass;
+        if(objClass == 0 || objClass->getThisClass() != objType) {
+            objClass = (ClassData *)&load(objType);
+            cache.arrayClass = objClass;
         }
     }
+    if(objClass->superDisplay == 0)
+        buildTypeInfo(*objClass);
+    /* Building the type info loads every supertype, so a type that is still not loaded is not one */
+    ClassData *classData = cache.classData;
+    if(classData == 0) {
+        classData = findLoadedClass(text, len);
+        if(classData == 0)
+            return false;
+        cache.classData = classData;
+    }
+    return isSubclassOf(*objClass, *classData);
 }
 
 void Flint::runToMain(const char *mainClass) {
@@ -880,8 +1500,10 @@ void Flint::freeObject(FlintJavaObject &obj) {
 }
 
 void Flint::clearAllStaticFields(void) {
-    for(ClassData *node = classDataList; node != 0; node = node->next)
+    for(ClassData *node = classDataList; node != 0; node = node->next) {
         node->clearStaticFields();
+        node->resetStaticAccess();
+    }
 }
 
 void Flint::freeAllObject(void) {
@@ -906,6 +1528,8 @@ void Flint::freeAllObject(void) {
     constClassList = 0;
     constStringList = 0;
     objectList = 0;
+    outOfMemoryError = 0;
+    stackOverflowError = 0;
     objectSizeToGc = 0;
     Flint::unlock();
 }
@@ -931,6 +1555,7 @@ void Flint::freeAllClassLoader(void) {
         node = next;
     }
     classDataList = 0;
+    interfaceIdCount = 0;
     Flint::unlock();
 }
 
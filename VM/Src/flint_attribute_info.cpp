@@ -14,10 +14,18 @@ FlintAttributeType FlintAttribute::parseAttributeType(const FlintConstUtf8 &name
             if(strncmp(name.text, "ConstantValue", name.length) == 0)
                 return ATTRIBUTE_CONSTANT_VALUE;
             break;
+        case 15:
+            if(strncmp(name.text, "LineNumberTable", name.length) == 0)
+                return ATTRIBUTE_LINE_NUMBER_TABLE;
+            break;
         case 16:
             if(strncmp(name.text, "BootstrapMethods", name.length) == 0)
                 return ATTRIBUTE_BOOTSTRAP_METHODS;
             break;
+        case 18:
+            if(strncmp(name.text, "LocalVariableTable", name.length) == 0)
+                return ATTRIBUTE_LOCAL_VARIABLE_TABLE;
+            break;
         default:
             break;
     }
@@ -32,7 +40,7 @@ FlintAttribute::~FlintAttribute(void) {
 
 }
 
-FlintNativeAttribute::FlintNativeAttribute(FlintNativeMethodPtr nativeMethod) : FlintAttribute(ATTRIBUTE_NATIVE), nativeMethod(nativeMethod) {
+FlintNativeAttribute::FlintNativeAttribute(FlintNativeMethodPtr nativeMethod) : FlintAttribute(ATTRIBUTE_NATIVE), nativeMethod(nativeMethod), argc(0), retSlots(0) {
 
 }
 
@@ -41,13 +49,32 @@ FlintNativeAttribute::~FlintNativeAttribute(void) {
 }
 
 FlintExceptionTable::FlintExceptionTable(uint16_t startPc, uint16_t endPc, uint16_t handlerPc, uint16_t catchType) :
-startPc(startPc), endPc(endPc), handlerPc(handlerPc), catchType(catchType) {
+startPc(startPc), endPc(endPc), handlerPc(handlerPc), catchType(catchType), catchClass(0) {
+
+}
+
+FlintLineNumberAttribute::FlintLineNumberAttribute(uint16_t lineNumberTableLength) :
+FlintAttribute(ATTRIBUTE_LINE_NUMBER_TABLE), lineNumberTableLength(lineNumberTableLength) {
+
+}
+
+FlintLineNumberAttribute::~FlintLineNumberAttribute(void) {
+
+}
+
+FlintLocalVariableAttribute::FlintLocalVariableAttribute(uint16_t localVariableTableLength) :
+FlintAttribute(ATTRIBUTE_LOCAL_VARIABLE_TABLE), localVariableTableLength(localVariableTableLength) {
+
+}
+
+FlintLocalVariableAttribute::~FlintLocalVariableAttribute(void) {
 
 }
 
 FlintCodeAttribute::FlintCodeAttribute(uint16_t maxStack, uint16_t maxLocals) :
 FlintAttribute(ATTRIBUTE_CODE), maxStack(maxStack), maxLocals(maxLocals), codeLength(0),
-exceptionTableLength(0), code(0), exceptionTable(0), attributes(0) {
+exceptionTableLength(0), code(0), regCode(0), exceptionTable(0), handlerRangeCount(0), stringSwitchCount(0), regLength(0), regPcCount(0),
+handlerIndex(0), stringSwitches(0), regPcTable(0), attributes(0) {
 
 }
 
@@ -66,17 +93,188 @@ void FlintCodeAttribute::addAttribute(FlintAttribute *attribute) {
     this->attributes = attribute;
 }
 
+uint16_t FlintCodeAttribute::addStringSwitch(FlintStringSwitch *stringSwitch) {
+    FlintStringSwitch **list = (FlintStringSwitch **)Flint::realloc(stringSwitches, (stringSwitchCount + 1) * sizeof(FlintStringSwitch *));
+    list[stringSwitchCount] = stringSwitch;
+    stringSwitches = list;
+    return stringSwitchCount++;
+}
+
+void FlintCodeAttribute::setRegCode(uint8_t *regCode, uint16_t regLength, FlintRegPc *regPcTable, uint16_t regPcCount) {
+    this->regCode = regCode;
+    this->regLength = regLength;
+    this->regPcTable = regPcTable;
+    this->regPcCount = regPcCount;
+}
+
+const FlintStringSwitch &FlintCodeAttribute::getStringSwitch(uint16_t index) const {
+    return *stringSwitches[index];
+}
+
 FlintExceptionTable &FlintCodeAttribute::getException(uint16_t index) const {
     if(index < exceptionTableLength)
         return exceptionTable[index];
     throw "index for FlintExceptionTable is invalid";
 }
 
+/*
+ * The boundaries of all handler ranges split the code into ranges covered by the same handlers.
+ * handlerIndex holds the sorted start pc of each range followed by the end of the last one,
+ * the offset of the first entry of each range and then the entries,
+ * which are exception table indexes kept in table order so the first match is still the one the JVM picks.
+ */
+void FlintCodeAttribute::buildHandlerIndex(void) {
+    uint16_t *bounds = (uint16_t *)Flint::malloc(exceptionTableLength * 2 * sizeof(uint16_t));
+    uint16_t boundsCount = 0;
+    for(uint16_t i = 0; i < exceptionTableLength * 2; i++) {
+        uint16_t pc = (i & 0x01) ? exceptionTable[i / 2].endPc : exceptionTable[i / 2].startPc;
+        uint16_t k = boundsCount;
+        while(k > 0 && bounds[k - 1] > pc)
+            k--;
+        if(k > 0 && bounds[k - 1] == pc)
+            continue;
+        memmove(&bounds[k + 1], &bounds[k], (boundsCount - k) * sizeof(uint16_t));
+        bounds[k] = pc;
+        boundsCount++;
+    }
+    uint16_t rangeCount = boundsCount - 1;
+    uint32_t entriesCount = 0;
+    for(uint16_t r = 0; r < rangeCount; r++) {
+        for(uint16_t i = 0; i < exceptionTableLength; i++) {
+            if(exceptionTable[i].startPc <= bounds[r] && bounds[r] < exceptionTable[i].endPc)
+                entriesCount++;
+        }
+    }
+    uint16_t *index;
+    try {
+        index = (uint16_t *)Flint::malloc((boundsCount * 2 + entriesCount) * sizeof(uint16_t));
+    }
+    catch(...) {
+        Flint::free(bounds);
+        throw;
+    }
+    uint16_t *starts = index;
+    uint16_t *firsts = &index[boundsCount];
+    uint16_t *entries = &index[boundsCount * 2];
+    uint16_t count = 0;
+    for(uint16_t r = 0; r < rangeCount; r++) {
+        starts[r] = bounds[r];
+        firsts[r] = count;
+        for(uint16_t i = 0; i < exceptionTableLength; i++) {
+            if(exceptionTable[i].startPc <= bounds[r] && bounds[r] < exceptionTable[i].endPc)
+                entries[count++] = i;
+        }
+    }
+    starts[rangeCount] = bounds[rangeCount];
+    firsts[rangeCount] = count;
+    Flint::free(bounds);
+    handlerIndex = index;
+    handlerRangeCount = rangeCount;
+}
+
+const uint16_t *FlintCodeAttribute::getHandlers(uint32_t pc, uint16_t &count) const {
+    int32_t low = 0;
+    int32_t high = handlerRangeCount - 1;
+    while(low <= high) {
+        int32_t mid = (low + high) >> 1;
+        if(handlerIndex[mid] <= pc)
+            low = mid + 1;
+        else
+            high = mid - 1;
+    }
+    /* high is the last range starting at or before pc */
+    if(high < 0 || pc >= handlerIndex[handlerRangeCount]) {
+        count = 0;
+        return 0;
+    }
+    const uint16_t *firsts = &handlerIndex[handlerRangeCount + 1];
+    count = firsts[high + 1] - firsts[high];
+    return &handlerIndex[(handlerRangeCount + 1) * 2 + firsts[high]];
+}
+
+int32_t FlintCodeAttribute::getLineNumber(uint32_t pc) const {
+    /* A method can have several tables, the entry with the nearest start pc wins */
+    int32_t lineNumber = -1;
+    int32_t startPc = -1;
+    for(FlintAttribute *node = attributes; node != 0; node = node->next) {
+        if(node->attributeType != ATTRIBUTE_LINE_NUMBER_TABLE)
+            continue;
+        FlintLineNumberAttribute &attribute = *(FlintLineNumberAttribute *)node;
+        for(uint16_t i = 0; i < attribute.lineNumberTableLength; i++) {
+            const FlintLineNumber &entry = attribute.lineNumberTable[i];
+            if(entry.startPc <= pc && (int32_t)entry.startPc > startPc) {
+                startPc = entry.startPc;
+                lineNumber = entry.lineNumber;
+            }
+        }
+    }
+    return lineNumber;
+}
+
+/* Returns 0 when no table describes the local at pc */
+uint16_t FlintCodeAttribute::getLocalDescriptorIndex(uint32_t pc, uint16_t localIndex) const {
+    for(FlintAttribute *node = attributes; node != 0; node = node->next) {
+        if(node->attributeType != ATTRIBUTE_LOCAL_VARIABLE_TABLE)
+            continue;
+        FlintLocalVariableAttribute &attribute = *(FlintLocalVariableAttribute *)node;
+        for(uint16_t i = 0; i < attribute.localVariableTableLength; i++) {
+            const FlintLocalVariable &entry = attribute.localVariableTable[i];
+            if(entry.index == localIndex && entry.startPc <= pc && pc < (uint32_t)(entry.startPc + entry.length))
+                return entry.descriptorIndex;
+        }
+    }
+    return 0;
+}
+
+/*
+ * The table has an entry for every block start and every instruction that can throw or call,
+ * the last entry at or before regPc is the bytecode instruction that regPc belongs to.
+ */
+uint32_t FlintCodeAttribute::getCodePc(uint32_t regPc) const {
+    int32_t low = 0;
+    int32_t high = regPcCount - 1;
+    while(low <= high) {
+        int32_t mid = (low + high) >> 1;
+        if(regPcTable[mid].regPc <= regPc)
+            low = mid + 1;
+        else
+            high = mid - 1;
+    }
+    return (high >= 0) ? regPcTable[high].codePc : 0;
+}
+
+/* Only block starts, such as exception handlers, are looked up by their bytecode pc */
+uint32_t FlintCodeAttribute::getRegPc(uint32_t codePc) const {
+    int32_t low = 0;
+    int32_t high = regPcCount - 1;
+    while(low <= high) {
+        int32_t mid = (low + high) >> 1;
+        if(regPcTable[mid].codePc < codePc)
+            low = mid + 1;
+        else if(regPcTable[mid].codePc > codePc)
+            high = mid - 1;
+        else
+            return regPcTable[mid].regPc;
+    }
+    throw "no register code at the pc";
+}
+
 FlintCodeAttribute::~FlintCodeAttribute(void) {
     if(code)
         Flint::free((void *)code);
+    if(regCode)
+        Flint::free((void *)regCode);
+    if(regPcTable)
+        Flint::free(regPcTable);
     if(exceptionTable)
         Flint::free((void *)exceptionTable);
+    if(handlerIndex)
+        Flint::free(handlerIndex);
+    if(stringSwitches) {
+        for(uint16_t i = 0; i < stringSwitchCount; i++)
+            Flint::free(stringSwitches[i]);
+        Flint::free(stringSwitches);
+    }
     for(FlintAttribute *node = attributes; node != 0;) {
         FlintAttribute *next = node->next;
         node->~FlintAttribute();
@@ -85,6 +283,29 @@ FlintCodeAttribute::~FlintCodeAttribute(void) {
     }
 }
 
+FlintStringSwitch::FlintStringSwitch(uint32_t endPc, uint16_t resultLocal, uint16_t caseCount) :
+endPc(endPc), resultLocal(resultLocal), caseCount(caseCount) {
+
+}
+
+const FlintStringCase *FlintStringSwitch::findCases(int32_t hash, uint16_t &count) const {
+    /* Cases are sorted by hash like the keys of the lookupswitch they come from, strings with the same hash are adjacent */
+    int32_t low = 0;
+    int32_t high = caseCount - 1;
+    while(low <= high) {
+        int32_t mid = (low + high) >> 1;
+        if(cases[mid].hash < hash)
+            low = mid + 1;
+        else
+            high = mid - 1;
+    }
+    uint16_t end = low;
+    while(end < caseCount && cases[end].hash == hash)
+        end++;
+    count = end - low;
+    return &cases[low];
+}
+
 FlintBootstrapMethod::FlintBootstrapMethod(uint16_t bootstrapMethodRef, uint16_t numBootstrapArguments) :
 bootstrapMethodRef(bootstrapMethodRef), numBootstrapArguments(numBootstrapArguments) {
 
@@ -5,6 +5,8 @@
 #include "flint_opcodes.h"
 #include "flint_system_api.h"
 #include "flint_class_loader.h"
+#include "flint_native_class.h"
+#include "flint_code_translator.h"
 
 #if __has_include("flint_conf.h")
 #include "flint_conf.h"
@@ -14,6 +16,7 @@
 typedef struct {
     FlintConstUtf8 *constUtf8Class;
     FlintJavaClass *constClass;
+    FlintConstClassCache classCache;
 } ConstClassValue;
 
 static void *ClassLoader_Open(const char *fileName) {
@@ -89,6 +92,30 @@ static uint64_t ClassLoader_ReadUInt64(void *file) {
     return Flint_Swap64(temp);
 }
 
+static ConstClassValue &ClassLoader_GetConstClassValue(FlintClassLoader &classLoader, FlintConstPool &constPool) {
+    if(constPool.tag & 0x80) {
+        Flint::lock();
+        if(constPool.tag & 0x80) {
+            try {
+                FlintConstUtf8 &constUtf8Class = classLoader.getConstUtf8(constPool.value);
+                ConstClassValue *constClassValue = (ConstClassValue *)Flint::malloc(sizeof(ConstClassValue));
+                constClassValue->constUtf8Class = &constUtf8Class;
+                constClassValue->constClass = 0;
+                constClassValue->classCache.classData = 0;
+                constClassValue->classCache.arrayClass = 0;
+                *(uint32_t *)&constPool.value = (uint32_t)constClassValue;
+                *(FlintConstPoolTag *)&constPool.tag = CONST_CLASS;
+            }
+            catch(...) {
+                Flint::unlock();
+                throw;
+            }
+        }
+        Flint::unlock();
+    }
+    return *(ConstClassValue *)constPool.value;
+}
+
 static void ClassLoader_Seek(void *file, int32_t offset) {
     if(FlintAPI::IO::fseek(file, FlintAPI::IO::ftell(file) + offset) != FILE_RESULT_OK)
         throw "read file error";
@@ -270,6 +297,36 @@ void FlintClassLoader::readFile(Flint &flint, void *file) {
                     if(attr != 0)
                         methods[loadedCount].addAttribute(attr);
                 }
+                /* Some library methods must see VM state the bytecode can't, they run natively even in debug mode */
+                if((flag & (METHOD_NATIVE | METHOD_ABSTRACT)) == 0) {
+                    if(methods[loadedCount].bindNativeMethod(OVERRIDE_NATIVE_CLASS_LIST, LENGTH(OVERRIDE_NATIVE_CLASS_LIST)))
+                        flag = (FlintMethodAccessFlag)(flag | METHOD_NATIVE);
+                }
+#if FLINT_AOT
+                /* Methods translated ahead of time run as native methods, debug mode keeps the bytecode */
+                if(!flint.getDebugger() && (flag & (METHOD_NATIVE | METHOD_ABSTRACT | METHOD_SYNCHRONIZED)) == 0) {
+                    if(methods[loadedCount].bindNativeMethod(AOT_NATIVE_CLASS_LIST, AOT_NATIVE_CLASS_COUNT))
+                        flag = (FlintMethodAccessFlag)(flag | METHOD_NATIVE);
+                }
+#endif
+#if FLINT_INLINE_TRIVIAL_METHODS
+                /* Trivial methods run at the call site without a frame, debug mode keeps the frames for breakpoints */
+                if(!flint.getDebugger() && (flag & (METHOD_NATIVE | METHOD_ABSTRACT)) == 0) {
+                    uint16_t inlineValue = 0;
+                    *(FlintMethodInlineKind *)&methods[loadedCount].inlineKind = FlintCodeTranslator::classify(methods[loadedCount], &inlineValue);
+                    *(uint16_t *)&methods[loadedCount].inlineValue = inlineValue;
+                }
+#endif
+#if (FLINT_REGISTER_IR && !FLINT_OPCODE_PROFILE)
+                /* The debugger steps through the bytecode, so methods keep it in debug mode */
+                if(!flint.getDebugger() && (flag & (METHOD_NATIVE | METHOD_ABSTRACT)) == 0)
+                    FlintCodeTranslator::translateToRegister(methods[loadedCount]);
+#endif
+#if (FLINT_SUPERINSTRUCTIONS && !FLINT_OPCODE_PROFILE)
+                /* Breakpoints can only stop at the start of a superinstruction so fusion is skipped in debug mode */
+                if(!flint.getDebugger() && (flag & (METHOD_NATIVE | METHOD_ABSTRACT)) == 0)
+                    FlintCodeTranslator::fuse(methods[loadedCount]);
+#endif
                 loadedCount++;
             }
         }
@@ -309,6 +366,14 @@ FlintAttribute *FlintClassLoader::readAttribute(void *file, bool isDummy) {
             return readAttributeCode(file);
         case ATTRIBUTE_BOOTSTRAP_METHODS:
             return readAttributeBootstrapMethods(file);
+#if FLINT_STACK_TRACE_DEPTH
+        case ATTRIBUTE_LINE_NUMBER_TABLE:
+            return readAttributeLineNumberTable(file);
+#endif
+#if FLINT_GC_CONSERVATIVE_STACK
+        case ATTRIBUTE_LOCAL_VARIABLE_TABLE:
+            return readAttributeLocalVariableTable(file);
+#endif
         default:
             ClassLoader_Seek(file, length);
             return 0;
@@ -323,6 +388,7 @@ FlintAttribute *FlintClassLoader::readAttributeCode(void *file) {
     uint8_t *code = (uint8_t *)Flint::malloc(codeLength + 1);
     new (attribute)FlintCodeAttribute(maxStack, maxLocals);
     ClassLoader_Read(file, code, codeLength);
+    FlintCodeTranslator::translate(code, codeLength);
     code[codeLength] = OP_EXIT;
     attribute->setCode(code, codeLength);
     uint16_t exceptionTableLength = ClassLoader_ReadUInt16(file);
@@ -336,6 +402,7 @@ FlintAttribute *FlintClassLoader::readAttributeCode(void *file) {
             uint16_t catchType = ClassLoader_ReadUInt16(file);
             new (&exceptionTable[i])FlintExceptionTable(startPc, endPc, handlerPc, catchType);
         }
+        attribute->buildHandlerIndex();
     }
     uint16_t attrbutesCount = ClassLoader_ReadUInt16(file);
     while(attrbutesCount--) {
@@ -362,6 +429,31 @@ FlintAttribute *FlintClassLoader::readAttributeBootstrapMethods(void *file) {
     return attribute;
 }
 
+FlintAttribute *FlintClassLoader::readAttributeLineNumberTable(void *file) {
+    uint16_t lineNumberTableLength = ClassLoader_ReadUInt16(file);
+    FlintLineNumberAttribute *attribute = (FlintLineNumberAttribute *)Flint::malloc(sizeof(FlintLineNumberAttribute) + lineNumberTableLength * sizeof(FlintLineNumber));
+    new (attribute)FlintLineNumberAttribute(lineNumberTableLength);
+    for(uint16_t i = 0; i < lineNumberTableLength; i++) {
+        attribute->lineNumberTable[i].startPc = ClassLoader_ReadUInt16(file);
+        attribute->lineNumberTable[i].lineNumber = ClassLoader_ReadUInt16(file);
+    }
+    return attribute;
+}
+
+FlintAttribute *FlintClassLoader::readAttributeLocalVariableTable(void *file) {
+    uint16_t localVariableTableLength = ClassLoader_ReadUInt16(file);
+    FlintLocalVariableAttribute *attribute = (FlintLocalVariableAttribute *)Flint::malloc(sizeof(FlintLocalVariableAttribute) + localVariableTableLength * sizeof(FlintLocalVariable));
+    new (attribute)FlintLocalVariableAttribute(localVariableTableLength);
+    for(uint16_t i = 0; i < localVariableTableLength; i++) {
+        attribute->localVariableTable[i].startPc = ClassLoader_ReadUInt16(file);
+        attribute->localVariableTable[i].length = ClassLoader_ReadUInt16(file);
+        ClassLoader_ReadUInt16(file);
+        attribute->localVariableTable[i].descriptorIndex = ClassLoader_ReadUInt16(file);
+        attribute->localVariableTable[i].index = ClassLoader_ReadUInt16(file);
+    }
+    return attribute;
+}
+
 uint32_t FlintClassLoader::getMagic(void) const {
     return magic;
 }
@@ -479,42 +571,20 @@ FlintConstUtf8 &FlintClassLoader::getConstUtf8Class(FlintConstPool &constPool) c
 
 FlintJavaClass &FlintClassLoader::getConstClass(Flint &flint, uint16_t poolIndex) {
     poolIndex--;
-    if(poolIndex < poolCount && (poolTable[poolIndex].tag & 0x7F) == CONST_CLASS) {
-        if(poolTable[poolIndex].tag & 0x80) {
-            Flint::lock();
-            if(poolTable[poolIndex].tag & 0x80) {
-                try {
-                    FlintConstUtf8 &constUtf8Class = getConstUtf8(poolTable[poolIndex].value);
-                    ConstClassValue *constClassValue = (ConstClassValue *)Flint::malloc(sizeof(ConstClassValue));
-                    constClassValue->constUtf8Class = &constUtf8Class;
-                    constClassValue->constClass = &flint.getConstClass(constUtf8Class.text, constUtf8Class.length);
-                    *(uint32_t *)&poolTable[poolIndex].value = (uint32_t)constClassValue;
-                    *(FlintConstPoolTag *)&poolTable[poolIndex].tag = CONST_CLASS;
-                }
-                catch(...) {
-                    Flint::unlock();
-                    throw;
-                }
-            }
-            Flint::unlock();
-        }
-        return *((ConstClassValue *)poolTable[poolIndex].value)->constClass;
-    }
+    if(poolIndex < poolCount && (poolTable[poolIndex].tag & 0x7F) == CONST_CLASS)
+        return getConstClass(flint, poolTable[poolIndex]);
     throw "index for const class is invalid";
 }
 
 FlintJavaClass &FlintClassLoader::getConstClass(Flint &flint, FlintConstPool &constPool) {
     if((constPool.tag & 0x7F) == CONST_CLASS) {
-        if(constPool.tag & 0x80) {
+        ConstClassValue &constClassValue = ClassLoader_GetConstClassValue(*this, constPool);
+        if(constClassValue.constClass == 0) {
             Flint::lock();
-            if(constPool.tag & 0x80) {
+            if(constClassValue.constClass == 0) {
                 try {
-                    FlintConstUtf8 &constUtf8Class = getConstUtf8(constPool.value);
-                    ConstClassValue *constClassValue = (ConstClassValue *)Flint::malloc(sizeof(ConstClassValue));
-                    constClassValue->constUtf8Class = &constUtf8Class;
-                    constClassValue->constClass = &flint.getConstClass(constUtf8Class.text, constUtf8Class.length);
-                    *(uint32_t *)&constPool.value = (uint32_t)constClassValue;
-                    *(FlintConstPoolTag *)&constPool.tag = CONST_CLASS;
+                    FlintConstUtf8 &constUtf8Class = *constClassValue.constUtf8Class;
+                    constClassValue.constClass = &flint.getConstClass(constUtf8Class.text, constUtf8Class.length);
                 }
                 catch(...) {
                     Flint::unlock();
@@ -523,11 +593,18 @@ FlintJavaClass &FlintClassLoader::getConstClass(Flint &flint, FlintConstPool &co
             }
             Flint::unlock();
         }
-        return *((ConstClassValue *)constPool.value)->constClass;
+        return *constClassValue.constClass;
     }
     throw "const pool tag is not class tag";
 }
 
+FlintConstClassCache &FlintClassLoader::getConstClassCache(uint16_t poolIndex) {
+    poolIndex--;
+    if(poolIndex < poolCount && (poolTable[poolIndex].tag & 0x7F) == CONST_CLASS)
+        return ClassLoader_GetConstClassValue(*this, poolTable[poolIndex]).classCache;
+    throw "index for const class is invalid";
+}
+
 FlintJavaString &FlintClassLoader::getConstString(Flint &flint, uint16_t poolIndex) {
     poolIndex--;
     if(poolIndex < poolCount && (poolTable[poolIndex].tag & 0x7F) == CONST_STRING) {
@@ -762,7 +839,7 @@ uint16_t FlintClassLoader::getMethodsCount(void) const {
     return methodsCount;
 }
 
-FlintMethodInfo &FlintClassLoader::getMethodInfo(uint8_t methodIndex) const {
+FlintMethodInfo &FlintClassLoader::getMethodInfo(uint16_t methodIndex) const {
     if(methodIndex < methodsCount)
         return methods[methodIndex];
     throw "index for method info is invalid";
@@ -806,15 +883,33 @@ FlintMethodInfo &FlintClassLoader::getStaticConstructor(void) const {
     return getMethodInfo(*(FlintConstNameAndType *)nameAndType);
 }
 
+/* Called when the static fields are freed, nothing may keep pointing into them or skip the initialization of their class */
+void FlintClassLoader::resetStaticAccess(void) {
+    for(uint32_t i = 0; i < poolCount; i++) {
+        if(poolTable[i].tag == CONST_FIELD)
+            ((FlintConstField *)poolTable[i].value)->staticValue = 0;
+    }
+    for(uint16_t i = 0; i < methodsCount; i++) {
+        if((methods[i].accessFlag & (METHOD_NATIVE | METHOD_ABSTRACT)) == 0)
+            FlintCodeTranslator::resetStaticAccess(methods[i]);
+    }
+}
+
 FlintClassLoader::~FlintClassLoader(void) {
     if(poolCount) {
         for(uint32_t i = 0; i < poolCount; i++) {
             switch (poolTable[i].tag) {
                 case CONST_UTF8:
                     break;
-                case CONST_FIELD:
                 case CONST_METHOD:
-                case CONST_INTERFACE_METHOD:
+                case CONST_INTERFACE_METHOD: {
+                    FlintConstMethod *constMethod = (FlintConstMethod *)poolTable[i].value;
+                    if(constMethod->inlineCache)
+                        Flint::free(constMethod->inlineCache);
+                    Flint::free(constMethod);
+                    break;
+                }
+                case CONST_FIELD:
                 case CONST_NAME_AND_TYPE:
                 case CONST_INVOKE_DYNAMIC:
                     Flint::free((void *)poolTable[i].value);
@@ -0,0 +1,1634 @@
+
+#include <new>
+#include <string.h>
+#include "flint.h"
+#include "flint_opcodes.h"
+#include "flint_const_name.h"
+#include "flint_class_loader.h"
+#include "flint_code_translator.h"
+
+#if __has_include("flint_conf.h")
+#include "flint_conf.h"
+#endif
+#include "flint_default_conf.h"
+
+static void translateInt16(uint8_t *array) {
+    int16_t value = (int16_t)((array[0] << 8) | array[1]);
+    ((FlintUnalignedInt16 *)array)->value = value;
+}
+
+static void translateInt32(uint8_t *array) {
+    int32_t value = (int32_t)(((uint32_t)array[0] << 24) | (array[1] << 16) | (array[2] << 8) | array[3]);
+    ((FlintUnalignedInt32 *)array)->value = value;
+}
+
+uint32_t FlintCodeTranslator::getInstructionLength(const uint8_t *code, uint32_t pc) {
+    switch(code[pc]) {
+        case OP_BIPUSH:
+        case OP_LDC:
+        case OP_ILOAD:
+        case OP_LLOAD:
+        case OP_FLOAD:
+        case OP_DLOAD:
+        case OP_ALOAD:
+        case OP_ISTORE:
+        case OP_LSTORE:
+        case OP_FSTORE:
+        case OP_DSTORE:
+        case OP_ASTORE:
+        case OP_RET:
+        case OP_NEWARRAY:
+        case OP_LDC_QUICK:
+        case OP_ALDC_QUICK:
+        case OP_ALOAD_ARRAYLENGTH_IF_ICMPGE:
+        case OP_ALOAD_N_ARRAYLENGTH_IF_ICMPGE:
+            return 2;
+        case OP_SIPUSH:
+        case OP_LDC_W:
+        case OP_LDC2_W:
+        case OP_IINC:
+        case OP_IFEQ:
+        case OP_IFNE:
+        case OP_IFLT:
+        case OP_IFGE:
+        case OP_IFGT:
+        case OP_IFLE:
+        case OP_IF_ICMPEQ:
+        case OP_IF_ICMPNE:
+        case OP_IF_ICMPLT:
+        case OP_IF_ICMPGE:
+        case OP_IF_ICMPGT:
+        case OP_IF_ICMPLE:
+        case OP_IF_ACMPEQ:
+        case OP_IF_ACMPNE:
+        case OP_GOTO:
+        case OP_JSR:
+        case OP_GETSTATIC:
+        case OP_PUTSTATIC:
+        case OP_GETFIELD:
+        case OP_PUTFIELD:
+        case OP_INVOKEVIRTUAL:
+        case OP_INVOKESPECIAL:
+        case OP_INVOKESTATIC:
+        case OP_NEW:
+        case OP_ANEWARRAY:
+        case OP_CHECKCAST:
+        case OP_INSTANCEOF:
+        case OP_IFNULL:
+        case OP_IFNONNULL:
+        case OP_IINC_GOTO:
+        case OP_STRING_SWITCH:
+            return 3;
+        case OP_MULTIANEWARRAY:
+        case OP_ILOAD_ILOAD_IADD_ISTORE:
+            return 4;
+        case OP_ILOAD_ILOAD_IADD_ISTORE_W:
+            return code[pc + 4];
+        case OP_IREG_ARITH:
+            return code[pc + 3];
+        case OP_IREG_ARITH_IMM:
+            return 4 + (code[pc + 2] >> 4);
+        case OP_IREG_IF_ICMP:
+            return 5 + (code[pc + 2] >> 4);
+        case OP_INVOKEINTERFACE:
+        case OP_INVOKEDYNAMIC:
+        case OP_GOTO_W:
+        case OP_JSRW:
+            return 5;
+        case OP_WIDE:
+            return (code[pc + 1] == OP_IINC) ? 6 : 4;
+        case OP_TABLESWITCH: {
+            const int32_t *table = CODE_TO_SWITCH_TABLE(code, pc);
+            return (const uint8_t *)&table[3 + table[2] - table[1] + 1] - &code[pc];
+        }
+        case OP_LOOKUPSWITCH: {
+            const int32_t *table = CODE_TO_SWITCH_TABLE(code, pc);
+            return (const uint8_t *)&table[2 + table[1] * 2] - &code[pc];
+        }
+        default:
+            if(OP_LDC_W_QUICK <= code[pc] && code[pc] <= OP_INVOKESTATIC_QUICK)
+                return 3;
+            return 1;
+    }
+}
+
+void FlintCodeTranslator::translate(uint8_t *code, uint32_t codeLength) {
+    uint32_t pc = 0;
+    while(pc < codeLength) {
+        switch(code[pc]) {
+            case OP_SIPUSH:
+            case OP_LDC_W:
+            case OP_LDC2_W:
+            case OP_IFEQ:
+            case OP_IFNE:
+            case OP_IFLT:
+            case OP_IFGE:
+            case OP_IFGT:
+            case OP_IFLE:
+            case OP_IF_ICMPEQ:
+            case OP_IF_ICMPNE:
+            case OP_IF_ICMPLT:
+            case OP_IF_ICMPGE:
+            case OP_IF_ICMPGT:
+            case OP_IF_ICMPLE:
+            case OP_IF_ACMPEQ:
+            case OP_IF_ACMPNE:
+            case OP_GOTO:
+            case OP_JSR:
+            case OP_GETSTATIC:
+            case OP_PUTSTATIC:
+            case OP_GETFIELD:
+            case OP_PUTFIELD:
+            case OP_INVOKEVIRTUAL:
+            case OP_INVOKESPECIAL:
+            case OP_INVOKESTATIC:
+            case OP_INVOKEINTERFACE:
+            case OP_INVOKEDYNAMIC:
+            case OP_NEW:
+            case OP_ANEWARRAY:
+            case OP_CHECKCAST:
+            case OP_INSTANCEOF:
+            case OP_MULTIANEWARRAY:
+            case OP_IFNULL:
+            case OP_IFNONNULL:
+                translateInt16(&code[pc + 1]);
+                break;
+            case OP_GOTO_W:
+            case OP_JSRW:
+                translateInt32(&code[pc + 1]);
+                break;
+            case OP_WIDE:
+                translateInt16(&code[pc + 2]);
+                if(code[pc + 1] == OP_IINC)
+                    translateInt16(&code[pc + 4]);
+                break;
+            case OP_TABLESWITCH: {
+                uint8_t *table = (uint8_t *)CODE_TO_SWITCH_TABLE(code, pc);
+                translateInt32(&table[0]);
+                translateInt32(&table[4]);
+                translateInt32(&table[8]);
+                uint32_t count = ((int32_t *)table)[2] - ((int32_t *)table)[1] + 1;
+                for(uint32_t i = 0; i < count; i++)
+                    translateInt32(&table[12 + i * 4]);
+                break;
+            }
+            case OP_LOOKUPSWITCH: {
+                uint8_t *table = (uint8_t *)CODE_TO_SWITCH_TABLE(code, pc);
+                translateInt32(&table[0]);
+                translateInt32(&table[4]);
+                uint32_t count = ((int32_t *)table)[1] * 2;
+                for(uint32_t i = 0; i < count; i++)
+                    translateInt32(&table[8 + i * 4]);
+                break;
+            }
+            default:
+                break;
+        }
+        pc += getInstructionLength(code, pc);
+    }
+}
+
+#if (FLINT_SUPERINSTRUCTIONS || FLINT_REGISTER_IR)
+
+static void markBranchTarget(uint8_t *targets, uint32_t codeLength, int32_t pc) {
+    if(0 <= pc && (uint32_t)pc < codeLength)
+        targets[pc / 8] |= 1 << (pc % 8);
+}
+
+static bool isBranchTarget(const uint8_t *targets, uint32_t pc) {
+    return (targets[pc / 8] >> (pc % 8)) & 0x01;
+}
+
+static uint8_t *findBranchTargets(const FlintCodeAttribute &attribute) {
+    const uint8_t *code = attribute.code;
+    uint32_t codeLength = attribute.codeLength;
+    uint8_t *targets = (uint8_t *)Flint::malloc((codeLength + 7) / 8);
+    memset(targets, 0, (codeLength + 7) / 8);
+    for(uint16_t i = 0; i < attribute.exceptionTableLength; i++)
+        markBranchTarget(targets, codeLength, attribute.getException(i).handlerPc);
+    for(uint32_t pc = 0; pc < codeLength; pc += FlintCodeTranslator::getInstructionLength(code, pc)) {
+        switch(code[pc]) {
+            case OP_IFEQ:
+            case OP_IFNE:
+            case OP_IFLT:
+            case OP_IFGE:
+            case OP_IFGT:
+            case OP_IFLE:
+            case OP_IF_ICMPEQ:
+            case OP_IF_ICMPNE:
+            case OP_IF_ICMPLT:
+            case OP_IF_ICMPGE:
+            case OP_IF_ICMPGT:
+            case OP_IF_ICMPLE:
+            case OP_IF_ACMPEQ:
+            case OP_IF_ACMPNE:
+            case OP_GOTO:
+            case OP_IFNULL:
+            case OP_IFNONNULL:
+                markBranchTarget(targets, codeLength, pc + CODE_TO_INT16(&code[pc + 1]));
+                break;
+            case OP_JSR:
+                markBranchTarget(targets, codeLength, pc + CODE_TO_INT16(&code[pc + 1]));
+                markBranchTarget(targets, codeLength, pc + 3);
+                break;
+            case OP_GOTO_W:
+                markBranchTarget(targets, codeLength, pc + CODE_TO_INT32(&code[pc + 1]));
+                break;
+            case OP_JSRW:
+                markBranchTarget(targets, codeLength, pc + CODE_TO_INT32(&code[pc + 1]));
+                markBranchTarget(targets, codeLength, pc + 5);
+                break;
+            case OP_TABLESWITCH: {
+                const int32_t *table = CODE_TO_SWITCH_TABLE(code, pc);
+                markBranchTarget(targets, codeLength, pc + table[0]);
+                uint32_t count = table[2] - table[1] + 1;
+                for(uint32_t i = 0; i < count; i++)
+                    markBranchTarget(targets, codeLength, pc + table[3 + i]);
+                break;
+            }
+            case OP_LOOKUPSWITCH: {
+                const int32_t *table = CODE_TO_SWITCH_TABLE(code, pc);
+                markBranchTarget(targets, codeLength, pc + table[0]);
+                for(int32_t i = 0; i < table[1]; i++)
+                    markBranchTarget(targets, codeLength, pc + table[3 + i * 2]);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+    return targets;
+}
+
+#endif /* (FLINT_SUPERINSTRUCTIONS || FLINT_REGISTER_IR) */
+
+#if FLINT_SUPERINSTRUCTIONS
+
+#if (FLINT_SUPERINSTRUCTIONS & FLINT_SUPER_ALOAD_0_GETFIELD)
+static void fuseAload0Getfield(uint8_t *code, uint32_t codeLength, const uint8_t *targets, uint32_t pc) {
+    /* Only the aload_0 is replaced, the getfield is still quickened by the interpreter */
+    if(code[pc] != OP_ALOAD_0 || (pc + 1) >= codeLength)
+        return;
+    if(code[pc + 1] != OP_GETFIELD || isBranchTarget(targets, pc + 1))
+        return;
+    code[pc] = OP_ALOAD_0_GETFIELD;
+}
+#endif
+
+#if (FLINT_SUPERINSTRUCTIONS & (FLINT_SUPER_ILOAD_ILOAD_IADD_ISTORE | FLINT_SUPER_INT_REGISTER))
+static uint8_t getLocalIndex(const uint8_t *code, uint32_t pc, uint8_t longOpCode, uint8_t shortOpCode) {
+    return (code[pc] == longOpCode) ? code[pc + 1] : (code[pc] - shortOpCode);
+}
+
+static bool isIntLoad(uint8_t opcode) {
+    return (opcode == OP_ILOAD) || (OP_ILOAD_0 <= opcode && opcode <= OP_ILOAD_3);
+}
+
+static bool isIntStore(uint8_t opcode) {
+    return (opcode == OP_ISTORE) || (OP_ISTORE_0 <= opcode && opcode <= OP_ISTORE_3);
+}
+#endif
+
+#if (FLINT_SUPERINSTRUCTIONS & FLINT_SUPER_ILOAD_ILOAD_IADD_ISTORE)
+
+static void fuseIloadIloadIaddIstore(uint8_t *code, uint32_t codeLength, const uint8_t *targets, uint32_t pc) {
+    if(!isIntLoad(code[pc]))
+        return;
+    uint32_t pc2 = pc + FlintCodeTranslator::getInstructionLength(code, pc);
+    if(pc2 >= codeLength || !isIntLoad(code[pc2]) || isBranchTarget(targets, pc2))
+        return;
+    uint32_t pc3 = pc2 + FlintCodeTranslator::getInstructionLength(code, pc2);
+    if(pc3 >= codeLength || code[pc3] != OP_IADD || isBranchTarget(targets, pc3))
+        return;
+    uint32_t pc4 = pc3 + 1;
+    if(pc4 >= codeLength || !isIntStore(code[pc4]) || isBranchTarget(targets, pc4))
+        return;
+    uint8_t length = pc4 + FlintCodeTranslator::getInstructionLength(code, pc4) - pc;
+    uint8_t index1 = getLocalIndex(code, pc, OP_ILOAD, OP_ILOAD_0);
+    uint8_t index2 = getLocalIndex(code, pc2, OP_ILOAD, OP_ILOAD_0);
+    uint8_t index3 = getLocalIndex(code, pc4, OP_ISTORE, OP_ISTORE_0);
+    /* [opcode][index1][index2][index3] or [opcode][index1][index2][index3][length] */
+    code[pc + 1] = index1;
+    code[pc + 2] = index2;
+    code[pc + 3] = index3;
+    if(length == 4)
+        code[pc] = OP_ILOAD_ILOAD_IADD_ISTORE;
+    else {
+        code[pc + 4] = length;
+        code[pc] = OP_ILOAD_ILOAD_IADD_ISTORE_W;
+    }
+}
+#endif
+
+
+#if (FLINT_SUPERINSTRUCTIONS & FLINT_SUPER_INT_REGISTER)
+static bool getIntRegOp(uint8_t opcode, uint8_t *kind) {
+    switch(opcode) {
+        case OP_IADD: *kind = IREG_ADD; return true;
+        case OP_ISUB: *kind = IREG_SUB; return true;
+        case OP_IMUL: *kind = IREG_MUL; return true;
+        case OP_IAND: *kind = IREG_AND; return true;
+        case OP_IOR: *kind = IREG_OR; return true;
+        case OP_IXOR: *kind = IREG_XOR; return true;
+        case OP_ISHL: *kind = IREG_SHL; return true;
+        case OP_ISHR: *kind = IREG_SHR; return true;
+        case OP_IUSHR: *kind = IREG_USHR; return true;
+        default: return false;
+    }
+}
+
+static bool getIntImmediate(const uint8_t *code, uint32_t pc, int8_t *value) {
+    if(OP_ICONST_M1 <= code[pc] && code[pc] <= OP_ICONST_5)
+        *value = code[pc] - OP_ICONST_0;
+    else if(code[pc] == OP_BIPUSH)
+        *value = (int8_t)code[pc + 1];
+    else
+        return false;
+    return true;
+}
+
+/*
+ * iload a, iload b|iconst k, <op>, istore c       ->  locals[c] = locals[a] <op> (locals[b]|k)
+ * iload a, iload b, if_icmp<cond>                 ->  compare locals[a] and locals[b] and branch
+ * The fused instruction keeps the start pc and length of the sequence, none of the replaced opcodes can throw
+ * and no branch lands inside it, so exception ranges and debugger pc mapping stay valid.
+ * Local indexes are packed in 4 bits, sequences using higher locals are left as they are.
+ */
+static void fuseIntRegister(uint8_t *code, uint32_t codeLength, const uint8_t *targets, uint32_t pc) {
+    if(!isIntLoad(code[pc]))
+        return;
+    uint8_t index1 = getLocalIndex(code, pc, OP_ILOAD, OP_ILOAD_0);
+    uint32_t pc2 = pc + FlintCodeTranslator::getInstructionLength(code, pc);
+    if(index1 > 0x0F || pc2 >= codeLength || isBranchTarget(targets, pc2))
+        return;
+    int8_t immediate = 0;
+    bool isImmediate = getIntImmediate(code, pc2, &immediate);
+    if(!isImmediate && !isIntLoad(code[pc2]))
+        return;
+    uint8_t index2 = isImmediate ? 0 : getLocalIndex(code, pc2, OP_ILOAD, OP_ILOAD_0);
+    uint32_t pc3 = pc2 + FlintCodeTranslator::getInstructionLength(code, pc2);
+    if(index2 > 0x0F || pc3 >= codeLength || isBranchTarget(targets, pc3))
+        return;
+    if(!isImmediate && OP_IF_ICMPEQ <= code[pc3] && code[pc3] <= OP_IF_ICMPLE) {
+        /* [opcode][index1 << 4 | index2][(length - 5) << 4 | cond][offset] */
+        uint32_t length = pc3 + 3 - pc;
+        int32_t offset = (int32_t)(pc3 - pc) + CODE_TO_INT16(&code[pc3 + 1]);
+        if(offset < -32768 || offset > 32767)
+            return;
+        uint8_t cond = code[pc3] - OP_IF_ICMPEQ;
+        code[pc + 1] = (index1 << 4) | index2;
+        code[pc + 2] = ((length - 5) << 4) | cond;
+        ((FlintUnalignedInt16 *)&code[pc + 3])->value = offset;
+        code[pc] = OP_IREG_IF_ICMP;
+        return;
+    }
+    uint8_t kind;
+    if(!getIntRegOp(code[pc3], &kind))
+        return;
+    uint32_t pc4 = pc3 + 1;
+    if(pc4 >= codeLength || !isIntStore(code[pc4]) || isBranchTarget(targets, pc4))
+        return;
+    uint8_t index3 = getLocalIndex(code, pc4, OP_ISTORE, OP_ISTORE_0);
+    uint32_t length = pc4 + FlintCodeTranslator::getInstructionLength(code, pc4) - pc;
+    if(index3 > 0x0F)
+        return;
+    if(isImmediate) {
+        /* [opcode][index1 << 4 | index3][(length - 4) << 4 | kind][immediate] */
+        code[pc + 1] = (index1 << 4) | index3;
+        code[pc + 2] = ((length - 4) << 4) | kind;
+        code[pc + 3] = (uint8_t)immediate;
+        code[pc] = OP_IREG_ARITH_IMM;
+    }
+    else {
+        /* [opcode][index1 << 4 | index2][index3 << 4 | kind][length] */
+        code[pc + 1] = (index1 << 4) | index2;
+        code[pc + 2] = (index3 << 4) | kind;
+        code[pc + 3] = length;
+        code[pc] = OP_IREG_ARITH;
+    }
+}
+#endif
+
+
+#if (FLINT_SUPERINSTRUCTIONS & FLINT_SUPER_IINC_GOTO)
+static void fuseIincGoto(uint8_t *code, uint32_t codeLength, const uint8_t *targets, uint32_t pc) {
+    if(code[pc] != OP_IINC || (pc + 3) >= codeLength)
+        return;
+    if(code[pc + 3] != OP_GOTO || isBranchTarget(targets, pc + 3))
+        return;
+    code[pc] = OP_IINC_GOTO;
+}
+#endif
+
+
+#if (FLINT_SUPERINSTRUCTIONS & FLINT_SUPER_ALOAD_ARRAYLENGTH_IF_ICMPGE)
+static void fuseAloadArraylengthIfIcmpge(uint8_t *code, uint32_t codeLength, const uint8_t *targets, uint32_t pc) {
+    uint32_t pc2;
+    if(code[pc] == OP_ALOAD)
+        pc2 = pc + 2;
+    else if(OP_ALOAD_0 <= code[pc] && code[pc] <= OP_ALOAD_3)
+        pc2 = pc + 1;
+    else
+        return;
+    if((pc2 + 1) >= codeLength || code[pc2] != OP_ARRAYLENGTH || isBranchTarget(targets, pc2))
+        return;
+    if(code[pc2 + 1] != OP_IF_ICMPGE || isBranchTarget(targets, pc2 + 1))
+        return;
+    if(code[pc] == OP_ALOAD)
+        code[pc] = OP_ALOAD_ARRAYLENGTH_IF_ICMPGE;
+    else {
+        /* The local index is stored in place of the arraylength */
+        code[pc + 1] = code[pc] - OP_ALOAD_0;
+        code[pc] = OP_ALOAD_N_ARRAYLENGTH_IF_ICMPGE;
+    }
+}
+#endif
+
+
+#if (FLINT_SUPERINSTRUCTIONS & FLINT_SUPER_STRING_SWITCH)
+static const FlintConstUtf8 &hashCodeName = *(const FlintConstUtf8 *)"\x08\x00\x6D\x04""hashCode";
+static const FlintConstUtf8 &hashCodeDescriptor = *(const FlintConstUtf8 *)"\x03\x00\xD0\x51""()I";
+static const FlintConstUtf8 &equalsName = *(const FlintConstUtf8 *)"\x06\x00\xAD\x2D""equals";
+static const FlintConstUtf8 &equalsDescriptor = *(const FlintConstUtf8 *)"\x15\x00\x08\xBB""(Ljava/lang/Object;)Z";
+
+typedef struct {
+    int32_t value;
+    uint32_t nextPc;
+    uint32_t endPc;
+    uint16_t stringIndex;
+    uint16_t resultLocal;
+} FlintStringCaseBlock;
+
+static bool getAloadIndex(const uint8_t *code, uint32_t pc, uint16_t *index) {
+    if(code[pc] == OP_ALOAD)
+        *index = code[pc + 1];
+    else if(OP_ALOAD_0 <= code[pc] && code[pc] <= OP_ALOAD_3)
+        *index = code[pc] - OP_ALOAD_0;
+    else
+        return false;
+    return true;
+}
+
+static bool isStringMethod(FlintClassLoader &classLoader, uint16_t poolIndex, const FlintConstUtf8 &name, const FlintConstUtf8 &descriptor) {
+    if((classLoader.getConstPool(poolIndex).tag & 0x7F) != CONST_METHOD)
+        return false;
+    FlintConstMethod &constMethod = classLoader.getConstMethod(poolIndex);
+    if(constMethod.className != stringClassName)
+        return false;
+    return (constMethod.nameAndType.name == name) && (constMethod.nameAndType.descriptor == descriptor);
+}
+
+/* aload s, ldc "case", invokevirtual String.equals, ifeq next, iconst|bipush|sipush value, istore result, [goto end] */
+static bool readStringCase(FlintClassLoader &classLoader, const uint8_t *code, uint32_t codeLength, uint32_t pc, uint16_t stringLocal, FlintStringCaseBlock *block) {
+    uint16_t local;
+    if(pc >= codeLength || !getAloadIndex(code, pc, &local) || local != stringLocal)
+        return false;
+    pc += FlintCodeTranslator::getInstructionLength(code, pc);
+    if(pc >= codeLength)
+        return false;
+    if(code[pc] == OP_LDC)
+        block->stringIndex = code[pc + 1];
+    else if(code[pc] == OP_LDC_W)
+        block->stringIndex = CODE_TO_UINT16(&code[pc + 1]);
+    else
+        return false;
+    if((classLoader.getConstPool(block->stringIndex).tag & 0x7F) != CONST_STRING)
+        return false;
+    pc += FlintCodeTranslator::getInstructionLength(code, pc);
+    if(pc >= codeLength || code[pc] != OP_INVOKEVIRTUAL)
+        return false;
+    if(!isStringMethod(classLoader, CODE_TO_UINT16(&code[pc + 1]), equalsName, equalsDescriptor))
+        return false;
+    pc += 3;
+    if(pc >= codeLength || code[pc] != OP_IFEQ)
+        return false;
+    block->nextPc = pc + CODE_TO_INT16(&code[pc + 1]);
+    pc += 3;
+    if(pc >= codeLength)
+        return false;
+    if(OP_ICONST_M1 <= code[pc] && code[pc] <= OP_ICONST_5)
+        block->value = code[pc] - OP_ICONST_0;
+    else if(code[pc] == OP_BIPUSH)
+        block->value = (int8_t)code[pc + 1];
+    else if(code[pc] == OP_SIPUSH)
+        block->value = CODE_TO_INT16(&code[pc + 1]);
+    else
+        return false;
+    pc += FlintCodeTranslator::getInstructionLength(code, pc);
+    if(pc >= codeLength)
+        return false;
+    if(code[pc] == OP_ISTORE)
+        block->resultLocal = code[pc + 1];
+    else if(OP_ISTORE_0 <= code[pc] && code[pc] <= OP_ISTORE_3)
+        block->resultLocal = code[pc] - OP_ISTORE_0;
+    else
+        return false;
+    pc += FlintCodeTranslator::getInstructionLength(code, pc);
+    block->endPc = (pc < codeLength && code[pc] == OP_GOTO) ? (pc + CODE_TO_INT16(&code[pc + 1])) : pc;
+    return true;
+}
+
+/* Returns the number of cases, 0 if the code after the lookupswitch is not what javac emits for a switch on strings */
+static uint16_t scanStringSwitch(FlintClassLoader &classLoader, const uint8_t *code, uint32_t codeLength, uint32_t switchPc, uint16_t stringLocal, FlintStringCase *cases, uint16_t *resultLocal) {
+    const int32_t *table = CODE_TO_SWITCH_TABLE(code, switchPc);
+    uint32_t endPc = switchPc + table[0];
+    uint32_t count = 0;
+    for(int32_t i = 0; i < table[1]; i++) {
+        uint32_t casePc = switchPc + table[3 + i * 2];
+        /* Strings with the same hash are chained through the ifeq of the previous one */
+        while(casePc != endPc) {
+            FlintStringCaseBlock block;
+            if(!readStringCase(classLoader, code, codeLength, casePc, stringLocal, &block))
+                return 0;
+            if(block.endPc != endPc || block.nextPc <= casePc || count == 0xFFFF)
+                return 0;
+            if(count == 0)
+                *resultLocal = block.resultLocal;
+            else if(block.resultLocal != *resultLocal)
+                return 0;
+            if(cases) {
+                cases[count].hash = table[2 + i * 2];
+                cases[count].value = block.value;
+                cases[count].stringIndex = block.stringIndex;
+            }
+            count++;
+            casePc = block.nextPc;
+        }
+    }
+    return count;
+}
+
+/*
+ * aload s, invokevirtual String.hashCode, lookupswitch and the equals chain of its cases
+ * become one hashed lookup that stores the case index and continues where javac switches on it.
+ * Only the hashCode call is replaced, the rest of the code is left for the null string path.
+ */
+void FlintCodeTranslator::fuseStringSwitch(FlintMethodInfo &methodInfo, uint8_t *code, uint32_t codeLength, const uint8_t *targets, uint32_t pc) {
+    uint16_t stringLocal;
+    if(!getAloadIndex(code, pc, &stringLocal))
+        return;
+    uint32_t pc2 = pc + getInstructionLength(code, pc);
+    if((pc2 + 3) >= codeLength || code[pc2] != OP_INVOKEVIRTUAL || code[pc2 + 3] != OP_LOOKUPSWITCH)
+        return;
+    if(isBranchTarget(targets, pc2) || isBranchTarget(targets, pc2 + 3))
+        return;
+    FlintClassLoader &classLoader = methodInfo.classLoader;
+    if(!isStringMethod(classLoader, CODE_TO_UINT16(&code[pc2 + 1]), hashCodeName, hashCodeDescriptor))
+        return;
+    uint32_t switchPc = pc2 + 3;
+    uint16_t resultLocal;
+    uint16_t count = scanStringSwitch(classLoader, code, codeLength, switchPc, stringLocal, 0, &resultLocal);
+    if(count == 0)
+        return;
+    const int32_t *table = CODE_TO_SWITCH_TABLE(code, switchPc);
+    FlintStringSwitch *stringSwitch = (FlintStringSwitch *)Flint::malloc(sizeof(FlintStringSwitch) + count * sizeof(FlintStringCase));
+    new (stringSwitch)FlintStringSwitch(switchPc + table[0], resultLocal, count);
+    scanStringSwitch(classLoader, code, codeLength, switchPc, stringLocal, stringSwitch->cases, &resultLocal);
+    uint16_t index;
+    try {
+        index = methodInfo.getAttributeCode().addStringSwitch(stringSwitch);
+    }
+    catch(...) {
+        Flint::free(stringSwitch);
+        throw;
+    }
+    ((FlintUnalignedInt16 *)&code[pc2 + 1])->value = index;
+    code[pc2] = OP_STRING_SWITCH;
+}
+#endif
+
+
+#endif /* FLINT_SUPERINSTRUCTIONS */
+
+void FlintCodeTranslator::fuse(FlintMethodInfo &methodInfo) {
+#if FLINT_SUPERINSTRUCTIONS
+    FlintCodeAttribute &attribute = methodInfo.getAttributeCode();
+    /* Methods with register code never run their bytecode */
+    if(attribute.regCode)
+        return;
+    uint8_t *code = (uint8_t *)attribute.code;
+    uint32_t codeLength = attribute.codeLength;
+    uint8_t *targets = findBranchTargets(attribute);
+    uint32_t pc = 0;
+    while(pc < codeLength) {
+#if (FLINT_SUPERINSTRUCTIONS & FLINT_SUPER_ALOAD_0_GETFIELD)
+        fuseAload0Getfield(code, codeLength, targets, pc);
+#endif
+#if (FLINT_SUPERINSTRUCTIONS & FLINT_SUPER_ILOAD_ILOAD_IADD_ISTORE)
+        fuseIloadIloadIaddIstore(code, codeLength, targets, pc);
+#endif
+#if (FLINT_SUPERINSTRUCTIONS & FLINT_SUPER_INT_REGISTER)
+        fuseIntRegister(code, codeLength, targets, pc);
+#endif
+#if (FLINT_SUPERINSTRUCTIONS & FLINT_SUPER_IINC_GOTO)
+        fuseIincGoto(code, codeLength, targets, pc);
+#endif
+#if (FLINT_SUPERINSTRUCTIONS & FLINT_SUPER_ALOAD_ARRAYLENGTH_IF_ICMPGE)
+        fuseAloadArraylengthIfIcmpge(code, codeLength, targets, pc);
+#endif
+#if (FLINT_SUPERINSTRUCTIONS & FLINT_SUPER_STRING_SWITCH)
+        try {
+            fuseStringSwitch(methodInfo, code, codeLength, targets, pc);
+        }
+        catch(...) {
+            Flint::free(targets);
+            throw;
+        }
+#endif
+        pc += getInstructionLength(code, pc);
+    }
+    Flint::free(targets);
+#else
+    (void)methodInfo;
+#endif /* FLINT_SUPERINSTRUCTIONS */
+}
+
+FlintMethodInlineKind FlintCodeTranslator::classify(const FlintMethodInfo &methodInfo, uint16_t *value) {
+    if(methodInfo.accessFlag & (METHOD_NATIVE | METHOD_ABSTRACT | METHOD_SYNCHRONIZED))
+        return METHOD_INLINE_NONE;
+    /* <clinit> needs its frame to end the class initialization */
+    if((methodInfo.accessFlag & METHOD_STATIC) && methodInfo.name.text[0] == '<')
+        return METHOD_INLINE_NONE;
+    const FlintCodeAttribute &attribute = methodInfo.getAttributeCode();
+    const uint8_t *code = attribute.code;
+    uint32_t codeLength = attribute.codeLength;
+    bool isStatic = (methodInfo.accessFlag & METHOD_STATIC) ? true : false;
+    if(codeLength == 1 && code[0] == OP_RETURN)
+        return METHOD_INLINE_EMPTY;
+    if(attribute.exceptionTableLength)
+        return METHOD_INLINE_NONE;
+    if(codeLength == 2 || codeLength == 3 || codeLength == 4) {
+        uint8_t retOpcode = code[codeLength - 1];
+        int32_t constValue;
+        if(code[0] >= OP_ICONST_M1 && code[0] <= OP_ICONST_5 && codeLength == 2)
+            constValue = code[0] - OP_ICONST_0;
+        else if(code[0] == OP_BIPUSH && codeLength == 3)
+            constValue = (int8_t)code[1];
+        else if(code[0] == OP_SIPUSH && codeLength == 4)
+            constValue = CODE_TO_INT16(&code[1]);
+        else if((code[0] == OP_LCONST_0 || code[0] == OP_LCONST_1) && codeLength == 2 && retOpcode == OP_LRETURN) {
+            *value = code[0] - OP_LCONST_0;
+            return METHOD_INLINE_CONST;
+        }
+        else if(code[0] == OP_ACONST_NULL && codeLength == 2 && retOpcode == OP_ARETURN) {
+            *value = 0;
+            return METHOD_INLINE_CONST;
+        }
+        else
+            return METHOD_INLINE_NONE;
+        if(retOpcode != OP_IRETURN)
+            return METHOD_INLINE_NONE;
+        *value = (uint16_t)constValue;
+        return METHOD_INLINE_CONST;
+    }
+    if(isStatic || code[0] != OP_ALOAD_0)
+        return METHOD_INLINE_NONE;
+    if(codeLength == 5 && code[1] == OP_GETFIELD && code[4] >= OP_IRETURN && code[4] <= OP_ARETURN) {
+        *value = CODE_TO_UINT16(&code[2]);
+        return METHOD_INLINE_GETTER;
+    }
+    if(codeLength == 5 && code[1] == OP_INVOKESPECIAL && code[4] == OP_RETURN && methodInfo.argc == 1 && methodInfo.name.text[0] == '<') {
+        *value = CODE_TO_UINT16(&code[2]);
+        return METHOD_INLINE_SUPER_INIT;
+    }
+    if(codeLength == 6 && code[5] == OP_RETURN && code[2] == OP_PUTFIELD) {
+        switch(code[1]) {
+            case OP_ILOAD_1:
+            case OP_LLOAD_1:
+            case OP_FLOAD_1:
+            case OP_DLOAD_1:
+            case OP_ALOAD_1:
+                *value = CODE_TO_UINT16(&code[3]);
+                return METHOD_INLINE_SETTER;
+            default:
+                break;
+        }
+    }
+    return METHOD_INLINE_NONE;
+}
+
+#if FLINT_REGISTER_IR
+
+#define REG_DEPTH_UNKNOWN           0xFFFF
+
+typedef enum : uint8_t {
+    REG_ENTRY_SLOT = 0,             /* The value is in its operand slot */
+    REG_ENTRY_LOCAL,                /* The value is still in a local, it is moved to the slot only when needed */
+    REG_ENTRY_CONST,                /* The value is a constant that is not written yet */
+} FlintRegEntryKind;
+
+typedef struct {
+    FlintRegEntryKind kind;
+    uint8_t local;
+    int32_t value;
+} FlintRegEntry;
+
+typedef struct {
+    uint32_t offset;
+    uint32_t codePc;
+} FlintRegFixup;
+
+/* The register code only keeps 32-bit values in the slots, so long and double are left to the stack interpreter */
+static bool hasWideValue(const FlintConstUtf8 &descriptor) {
+    const char *text = descriptor.text;
+    for(uint16_t i = 0; i < descriptor.length; i++) {
+        if(text[i] == 'L') {
+            while(i < descriptor.length && text[i] != ';')
+                i++;
+        }
+        else if(text[i] == 'J' || text[i] == 'D')
+            return true;
+    }
+    return false;
+}
+
+static bool getStoreIndex(const uint8_t *code, uint32_t pc, uint8_t *index) {
+    switch(code[pc]) {
+        case OP_ISTORE:
+        case OP_FSTORE:
+        case OP_ASTORE:
+            *index = code[pc + 1];
+            return true;
+        case OP_ISTORE_0: case OP_ISTORE_1: case OP_ISTORE_2: case OP_ISTORE_3:
+            *index = code[pc] - OP_ISTORE_0;
+            return true;
+        case OP_FSTORE_0: case OP_FSTORE_1: case OP_FSTORE_2: case OP_FSTORE_3:
+            *index = code[pc] - OP_FSTORE_0;
+            return true;
+        case OP_ASTORE_0: case OP_ASTORE_1: case OP_ASTORE_2: case OP_ASTORE_3:
+            *index = code[pc] - OP_ASTORE_0;
+            return true;
+        default:
+            return false;
+    }
+}
+
+static bool getLoadIndex(const uint8_t *code, uint32_t pc, uint8_t *index) {
+    switch(code[pc]) {
+        case OP_ILOAD:
+        case OP_FLOAD:
+        case OP_ALOAD:
+            *index = code[pc + 1];
+            return true;
+        case OP_ILOAD_0: case OP_ILOAD_1: case OP_ILOAD_2: case OP_ILOAD_3:
+            *index = code[pc] - OP_ILOAD_0;
+            return true;
+        case OP_FLOAD_0: case OP_FLOAD_1: case OP_FLOAD_2: case OP_FLOAD_3:
+            *index = code[pc] - OP_FLOAD_0;
+            return true;
+        case OP_ALOAD_0: case OP_ALOAD_1: case OP_ALOAD_2: case OP_ALOAD_3:
+            *index = code[pc] - OP_ALOAD_0;
+            return true;
+        default:
+            return false;
+    }
+}
+
+/*
+ * Walks the bytecode once with an abstract operand stack. Loads and constants stay pending until
+ * an instruction needs them, so most operands are read straight from the locals.
+ */
+class FlintRegBuilder {
+private:
+    FlintMethodInfo &methodInfo;
+    const FlintCodeAttribute &attribute;
+    const uint8_t tempBase;
+    uint8_t *targets;
+    uint16_t *depths;
+    FlintRegEntry *entries;
+    uint16_t depth;
+    uint8_t *regCode;
+    uint32_t regLength;
+    uint32_t regCapacity;
+    FlintRegPc *pcTable;
+    uint32_t pcCount;
+    uint32_t pcCapacity;
+    FlintRegFixup *fixups;
+    uint32_t fixupCount;
+    uint32_t fixupCapacity;
+
+    FlintRegBuilder(const FlintRegBuilder &) = delete;
+    void operator=(const FlintRegBuilder &) = delete;
+
+    uint8_t *reserve(uint32_t size);
+    void emit8(uint8_t value);
+    void emit16(int32_t value);
+    void emit32(int32_t value);
+    void addPc(uint32_t codePc);
+    bool addBranch(uint32_t codePc);
+    bool push(FlintRegEntryKind kind, uint8_t local, int32_t value);
+    uint8_t use(uint16_t index);
+    void flush(uint16_t from);
+    void flushLocal(uint8_t local);
+    uint8_t result(uint32_t &nextPc);
+    bool startBlock(uint32_t pc, bool isReachable);
+    bool translateInvoke(uint32_t pc);
+    bool translateInstruction(uint32_t pc, uint32_t &nextPc, bool &isReachable);
+    bool resolveBranches(void);
+public:
+    FlintRegBuilder(FlintMethodInfo &methodInfo);
+
+    bool build(void);
+    void release(uint8_t **regCode, uint16_t *regLength, FlintRegPc **pcTable, uint16_t *pcCount);
+
+    ~FlintRegBuilder(void);
+};
+
+FlintRegBuilder::FlintRegBuilder(FlintMethodInfo &methodInfo) :
+methodInfo(methodInfo), attribute(methodInfo.getAttributeCode()), tempBase(attribute.maxLocals + 4), targets(0), depths(0),
+entries(0), depth(0), regCode(0), regLength(0), regCapacity(0), pcTable(0), pcCount(0), pcCapacity(0), fixups(0),
+fixupCount(0), fixupCapacity(0) {
+
+}
+
+uint8_t *FlintRegBuilder::reserve(uint32_t size) {
+    if(regLength + size > regCapacity) {
+        regCapacity = (regCapacity * 2 > regLength + size) ? (regCapacity * 2) : (regLength + size);
+        regCode = (uint8_t *)Flint::realloc(regCode, regCapacity);
+    }
+    uint8_t *ret = &regCode[regLength];
+    regLength += size;
+    return ret;
+}
+
+void FlintRegBuilder::emit8(uint8_t value) {
+    *reserve(1) = value;
+}
+
+void FlintRegBuilder::emit16(int32_t value) {
+    ((FlintUnalignedInt16 *)reserve(2))->value = (int16_t)value;
+}
+
+void FlintRegBuilder::emit32(int32_t value) {
+    ((FlintUnalignedInt32 *)reserve(4))->value = value;
+}
+
+void FlintRegBuilder::addPc(uint32_t codePc) {
+    if(pcCount && pcTable[pcCount - 1].codePc == codePc)
+        return;
+    if(pcCount == pcCapacity) {
+        pcCapacity *= 2;
+        pcTable = (FlintRegPc *)Flint::realloc(pcTable, pcCapacity * sizeof(FlintRegPc));
+    }
+    pcTable[pcCount].regPc = (uint16_t)regLength;
+    pcTable[pcCount].codePc = (uint16_t)codePc;
+    pcCount++;
+}
+
+bool FlintRegBuilder::addBranch(uint32_t codePc) {
+    if(codePc >= attribute.codeLength)
+        return false;
+    if(depths[codePc] == REG_DEPTH_UNKNOWN)
+        depths[codePc] = depth;
+    else if(depths[codePc] != depth)
+        return false;
+    if(fixupCount == fixupCapacity) {
+        fixupCapacity *= 2;
+        fixups = (FlintRegFixup *)Flint::realloc(fixups, fixupCapacity * sizeof(FlintRegFixup));
+    }
+    fixups[fixupCount].offset = regLength;
+    fixups[fixupCount].codePc = codePc;
+    fixupCount++;
+    emit16(0);
+    return true;
+}
+
+bool FlintRegBuilder::push(FlintRegEntryKind kind, uint8_t local, int32_t value) {
+    if(depth >= attribute.maxStack)
+        return false;
+    entries[depth].kind = kind;
+    entries[depth].local = local;
+    entries[depth].value = value;
+    depth++;
+    return true;
+}
+
+uint8_t FlintRegBuilder::use(uint16_t index) {
+    FlintRegEntry &entry = entries[index];
+    if(entry.kind == REG_ENTRY_LOCAL)
+        return entry.local;
+    if(entry.kind == REG_ENTRY_CONST) {
+        emit8(REG_CONST);
+        emit8(tempBase + index);
+        emit32(entry.value);
+        entry.kind = REG_ENTRY_SLOT;
+    }
+    return tempBase + index;
+}
+
+void FlintRegBuilder::flush(uint16_t from) {
+    for(uint16_t i = from; i < depth; i++) {
+        if(entries[i].kind == REG_ENTRY_LOCAL) {
+            emit8(REG_MOVE);
+            emit8(tempBase + i);
+            emit8(entries[i].local);
+            entries[i].kind = REG_ENTRY_SLOT;
+        }
+        else if(entries[i].kind == REG_ENTRY_CONST)
+            use(i);
+    }
+}
+
+void FlintRegBuilder::flushLocal(uint8_t local) {
+    for(uint16_t i = 0; i < depth; i++) {
+        if(entries[i].kind == REG_ENTRY_LOCAL && entries[i].local == local) {
+            emit8(REG_MOVE);
+            emit8(tempBase + i);
+            emit8(local);
+            entries[i].kind = REG_ENTRY_SLOT;
+        }
+    }
+}
+
+/* Picks the register of a result, a store that follows in the same block takes the value directly */
+uint8_t FlintRegBuilder::result(uint32_t &nextPc) {
+    uint8_t local;
+    if(nextPc < attribute.codeLength && !isBranchTarget(targets, nextPc) && getStoreIndex(attribute.code, nextPc, &local)) {
+        flushLocal(local);
+        nextPc += FlintCodeTranslator::getInstructionLength(attribute.code, nextPc);
+        return local;
+    }
+    push(REG_ENTRY_SLOT, 0, 0);
+    return tempBase + depth - 1;
+}
+
+bool FlintRegBuilder::startBlock(uint32_t pc, bool isReachable) {
+    if(isReachable) {
+        flush(0);
+        if(depths[pc] == REG_DEPTH_UNKNOWN)
+            depths[pc] = depth;
+        else if(depths[pc] != depth)
+            return false;
+    }
+    else {
+        /* Only reached by a branch that comes later, javac leaves the operand stack empty there */
+        if(depths[pc] == REG_DEPTH_UNKNOWN)
+            depths[pc] = 0;
+        depth = depths[pc];
+        if(depth > attribute.maxStack)
+            return false;
+        for(uint16_t i = 0; i < depth; i++)
+            entries[i].kind = REG_ENTRY_SLOT;
+    }
+    addPc(pc);
+    return true;
+}
+
+bool FlintRegBuilder::translateInvoke(uint32_t pc) {
+    const uint8_t *code = attribute.code;
+    uint8_t opcode = code[pc];
+    uint16_t poolIndex = CODE_TO_UINT16(&code[pc + 1]);
+    FlintClassLoader &classLoader = methodInfo.classLoader;
+    uint8_t tag = classLoader.getConstPool(poolIndex).tag & 0x7F;
+    if(tag != ((opcode == OP_INVOKEINTERFACE) ? CONST_INTERFACE_METHOD : CONST_METHOD))
+        return false;
+    FlintConstMethod &constMethod = (opcode == OP_INVOKEINTERFACE) ? classLoader.getConstInterfaceMethod(poolIndex) : classLoader.getConstMethod(poolIndex);
+    if(hasWideValue(constMethod.nameAndType.descriptor))
+        return false;
+    const FlintParamInfo &paramInfo = constMethod.getParmInfo();
+    uint16_t argc = paramInfo.argc + ((opcode == OP_INVOKESTATIC) ? 0 : 1);
+    if(argc > depth)
+        return false;
+    addPc(pc);
+    /* The arguments become the locals of the callee, so they must be in their slots */
+    flush(depth - argc);
+    switch(opcode) {
+        case OP_INVOKEVIRTUAL:
+            emit8(REG_INVOKEVIRTUAL);
+            break;
+        case OP_INVOKESPECIAL:
+            emit8(REG_INVOKESPECIAL);
+            break;
+        case OP_INVOKESTATIC:
+            emit8(REG_INVOKESTATIC);
+            break;
+        default:
+            emit8(REG_INVOKEINTERFACE);
+            break;
+    }
+    emit8(tempBase + depth - 1);
+    emit16(poolIndex);
+    if(opcode == OP_INVOKEINTERFACE)
+        emit8(argc);
+    depth -= argc;
+    /* The callee leaves its result at the slot of its first argument */
+    if(paramInfo.retType != 'V')
+        return push(REG_ENTRY_SLOT, 0, 0);
+    return true;
+}
+
+bool FlintRegBuilder::translateInstruction(uint32_t pc, uint32_t &nextPc, bool &isReachable) {
+    const uint8_t *code = attribute.code;
+    FlintClassLoader &classLoader = methodInfo.classLoader;
+    uint8_t opcode = code[pc];
+    uint8_t local;
+    if(getLoadIndex(code, pc, &local))
+        return push(REG_ENTRY_LOCAL, local, 0);
+    if(getStoreIndex(code, pc, &local)) {
+        if(depth == 0)
+            return false;
+        flushLocal(local);
+        FlintRegEntry &entry = entries[depth - 1];
+        if(entry.kind == REG_ENTRY_CONST) {
+            emit8(REG_CONST);
+            emit8(local);
+            emit32(entry.value);
+        }
+        else {
+            emit8(REG_MOVE);
+            emit8(local);
+            emit8((entry.kind == REG_ENTRY_LOCAL) ? entry.local : (tempBase + depth - 1));
+        }
+        depth--;
+        return true;
+    }
+    switch(opcode) {
+        case OP_NOP:
+            return true;
+        case OP_ACONST_NULL:
+            return push(REG_ENTRY_CONST, 0, 0);
+        case OP_ICONST_M1: case OP_ICONST_0: case OP_ICONST_1: case OP_ICONST_2:
+        case OP_ICONST_3: case OP_ICONST_4: case OP_ICONST_5:
+            return push(REG_ENTRY_CONST, 0, opcode - OP_ICONST_0);
+        case OP_FCONST_0: case OP_FCONST_1: case OP_FCONST_2: {
+            float value = opcode - OP_FCONST_0;
+            return push(REG_ENTRY_CONST, 0, *(int32_t *)&value);
+        }
+        case OP_BIPUSH:
+            return push(REG_ENTRY_CONST, 0, (int8_t)code[pc + 1]);
+        case OP_SIPUSH:
+            return push(REG_ENTRY_CONST, 0, CODE_TO_INT16(&code[pc + 1]));
+        case OP_LDC:
+        case OP_LDC_W: {
+            uint16_t poolIndex = (opcode == OP_LDC) ? code[pc + 1] : CODE_TO_UINT16(&code[pc + 1]);
+            FlintConstPool &constPool = classLoader.getConstPool(poolIndex);
+            switch(constPool.tag & 0x7F) {
+                case CONST_INTEGER:
+                case CONST_FLOAT:
+                    return push(REG_ENTRY_CONST, 0, constPool.value);
+                case CONST_STRING: {
+                    if(depth >= attribute.maxStack)
+                        return false;
+                    addPc(pc);
+                    uint8_t dst = result(nextPc);
+                    emit8(REG_ALDC);
+                    emit8(dst);
+                    emit16(poolIndex);
+                    return true;
+                }
+                default:
+                    return false;
+            }
+        }
+        case OP_POP:
+            if(depth == 0)
+                return false;
+            depth--;
+            return true;
+        case OP_DUP: {
+            if(depth == 0 || depth >= attribute.maxStack)
+                return false;
+            FlintRegEntry &entry = entries[depth - 1];
+            if(entry.kind != REG_ENTRY_SLOT)
+                return push(entry.kind, entry.local, entry.value);
+            emit8(REG_MOVE);
+            emit8(tempBase + depth);
+            emit8(tempBase + depth - 1);
+            return push(REG_ENTRY_SLOT, 0, 0);
+        }
+        case OP_DUP_X1: {
+            if(depth < 2 || depth >= attribute.maxStack)
+                return false;
+            flush(depth - 2);
+            uint8_t top = tempBase + depth;
+            emit8(REG_MOVE); emit8(top); emit8(top - 1);
+            emit8(REG_MOVE); emit8(top - 1); emit8(top - 2);
+            emit8(REG_MOVE); emit8(top - 2); emit8(top);
+            return push(REG_ENTRY_SLOT, 0, 0);
+        }
+        case OP_IADD:
+        case OP_ISUB: {
+            if(depth < 2)
+                return false;
+            FlintRegEntry &entry = entries[depth - 1];
+            if(entry.kind == REG_ENTRY_CONST) {
+                int32_t value = (opcode == OP_IADD) ? entry.value : -entry.value;
+                if(-32768 <= value && value <= 32767) {
+                    uint8_t src = use(depth - 2);
+                    depth -= 2;
+                    uint8_t dst = result(nextPc);
+                    emit8(REG_IADD_IMM);
+                    emit8(dst);
+                    emit8(src);
+                    emit16(value);
+                    return true;
+                }
+            }
+            opcode = (opcode == OP_IADD) ? REG_IADD : REG_ISUB;
+            goto binary_op;
+        }
+        case OP_IMUL: opcode = REG_IMUL; goto binary_op;
+        case OP_IDIV: opcode = REG_IDIV; addPc(pc); goto binary_op;
+        case OP_IREM: opcode = REG_IREM; addPc(pc); goto binary_op;
+        case OP_IAND: opcode = REG_IAND; goto binary_op;
+        case OP_IOR: opcode = REG_IOR; goto binary_op;
+        case OP_IXOR: opcode = REG_IXOR; goto binary_op;
+        case OP_ISHL: opcode = REG_ISHL; goto binary_op;
+        case OP_ISHR: opcode = REG_ISHR; goto binary_op;
+        case OP_IUSHR: opcode = REG_IUSHR; goto binary_op;
+        case OP_FADD: opcode = REG_FADD; goto binary_op;
+        case OP_FSUB: opcode = REG_FSUB; goto binary_op;
+        case OP_FMUL: opcode = REG_FMUL; goto binary_op;
+        case OP_FDIV: opcode = REG_FDIV; goto binary_op;
+        case OP_FCMPL: opcode = REG_FCMPL; goto binary_op;
+        case OP_FCMPG: opcode = REG_FCMPG; goto binary_op;
+        case OP_IALOAD: case OP_FALOAD: opcode = REG_IALOAD; addPc(pc); goto binary_op;
+        case OP_AALOAD: opcode = REG_AALOAD; addPc(pc); goto binary_op;
+        case OP_BALOAD: opcode = REG_BALOAD; addPc(pc); goto binary_op;
+        case OP_CALOAD: opcode = REG_CALOAD; addPc(pc); goto binary_op;
+        case OP_SALOAD: opcode = REG_SALOAD; addPc(pc); goto binary_op;
+        binary_op: {
+            if(depth < 2)
+                return false;
+            uint8_t src2 = use(depth - 1);
+            uint8_t src1 = use(depth - 2);
+            depth -= 2;
+            uint8_t dst = result(nextPc);
+            emit8(opcode);
+            emit8(dst);
+            emit8(src1);
+            emit8(src2);
+            return true;
+        }
+        case OP_INEG: opcode = REG_INEG; goto unary_op;
+        case OP_FNEG: opcode = REG_FNEG; goto unary_op;
+        case OP_I2F: opcode = REG_I2F; goto unary_op;
+        case OP_F2I: opcode = REG_F2I; goto unary_op;
+        case OP_I2B: opcode = REG_I2B; goto unary_op;
+        case OP_I2C: opcode = REG_I2C; goto unary_op;
+        case OP_I2S: opcode = REG_I2S; goto unary_op;
+        case OP_ARRAYLENGTH: opcode = REG_ARRAYLENGTH; addPc(pc); goto unary_op;
+        unary_op: {
+            if(depth < 1)
+                return false;
+            uint8_t src = use(depth - 1);
+            depth--;
+            uint8_t dst = result(nextPc);
+            emit8(opcode);
+            emit8(dst);
+            emit8(src);
+            return true;
+        }
+        case OP_IINC:
+            flushLocal(code[pc + 1]);
+            emit8(REG_IADD_IMM);
+            emit8(code[pc + 1]);
+            emit8(code[pc + 1]);
+            emit16((int8_t)code[pc + 2]);
+            return true;
+        case OP_IASTORE: case OP_FASTORE: opcode = REG_IASTORE; goto array_store;
+        case OP_AASTORE: opcode = REG_AASTORE; goto array_store;
+        case OP_BASTORE: opcode = REG_BASTORE; goto array_store;
+        case OP_CASTORE: case OP_SASTORE: opcode = REG_CASTORE; goto array_store;
+        array_store: {
+            if(depth < 3)
+                return false;
+            addPc(pc);
+            uint8_t value = use(depth - 1);
+            uint8_t index = use(depth - 2);
+            uint8_t array = use(depth - 3);
+            depth -= 3;
+            emit8(opcode);
+            emit8(array);
+            emit8(index);
+            emit8(value);
+            return true;
+        }
+        case OP_IFEQ: case OP_IFNE: case OP_IFLT: case OP_IFGE: case OP_IFGT: case OP_IFLE:
+            opcode = REG_IFEQ + (opcode - OP_IFEQ);
+            goto if_op;
+        case OP_IFNULL:
+            opcode = REG_IFEQ;
+            goto if_op;
+        case OP_IFNONNULL:
+            opcode = REG_IFNE;
+            goto if_op;
+        if_op: {
+            if(depth < 1)
+                return false;
+            uint8_t src = use(depth - 1);
+            depth--;
+            flush(0);
+            emit8(opcode);
+            emit8(src);
+            return addBranch(pc + CODE_TO_INT16(&code[pc + 1]));
+        }
+        case OP_IF_ICMPEQ: case OP_IF_ICMPNE: case OP_IF_ICMPLT: case OP_IF_ICMPGE: case OP_IF_ICMPGT: case OP_IF_ICMPLE:
+            opcode = REG_IF_ICMPEQ + (opcode - OP_IF_ICMPEQ);
+            goto if_cmp_op;
+        case OP_IF_ACMPEQ: case OP_IF_ACMPNE:
+            opcode = REG_IF_ICMPEQ + (opcode - OP_IF_ACMPEQ);
+            goto if_cmp_op;
+        if_cmp_op: {
+            if(depth < 2)
+                return false;
+            /* A compare with zero only needs one register */
+            if(entries[depth - 1].kind == REG_ENTRY_CONST && entries[depth - 1].value == 0) {
+                opcode = REG_IFEQ + (opcode - REG_IF_ICMPEQ);
+                depth--;
+                goto if_op;
+            }
+            uint8_t src2 = use(depth - 1);
+            uint8_t src1 = use(depth - 2);
+            depth -= 2;
+            flush(0);
+            emit8(opcode);
+            emit8(src1);
+            emit8(src2);
+            return addBranch(pc + CODE_TO_INT16(&code[pc + 1]));
+        }
+        case OP_GOTO:
+        case OP_GOTO_W:
+            flush(0);
+            emit8(REG_GOTO);
+            isReachable = false;
+            return addBranch(pc + ((opcode == OP_GOTO) ? CODE_TO_INT16(&code[pc + 1]) : CODE_TO_INT32(&code[pc + 1])));
+        case OP_TABLESWITCH: {
+            if(depth < 1)
+                return false;
+            const int32_t *table = CODE_TO_SWITCH_TABLE(code, pc);
+            uint8_t src = use(depth - 1);
+            depth--;
+            flush(0);
+            emit8(REG_TABLESWITCH);
+            emit8(src);
+            if(!addBranch(pc + table[0]))
+                return false;
+            emit32(table[1]);
+            emit32(table[2]);
+            uint32_t count = table[2] - table[1] + 1;
+            for(uint32_t i = 0; i < count; i++) {
+                if(!addBranch(pc + table[3 + i]))
+                    return false;
+            }
+            isReachable = false;
+            return true;
+        }
+        case OP_LOOKUPSWITCH: {
+            const int32_t *table = CODE_TO_SWITCH_TABLE(code, pc);
+            if(depth < 1 || table[1] < 0 || table[1] > 0xFFFF)
+                return false;
+            uint8_t src = use(depth - 1);
+            depth--;
+            flush(0);
+            emit8(REG_LOOKUPSWITCH);
+            emit8(src);
+            if(!addBranch(pc + table[0]))
+                return false;
+            emit16(table[1]);
+            for(int32_t i = 0; i < table[1]; i++) {
+                emit32(table[2 + i * 2]);
+                if(!addBranch(pc + table[3 + i * 2]))
+                    return false;
+            }
+            isReachable = false;
+            return true;
+        }
+        case OP_IRETURN:
+        case OP_FRETURN:
+        case OP_ARETURN:
+            if(depth < 1)
+                return false;
+            emit8((opcode == OP_ARETURN) ? REG_ARETURN : REG_IRETURN);
+            emit8(use(depth - 1));
+            isReachable = false;
+            return true;
+        case OP_RETURN:
+            emit8(REG_RETURN);
+            isReachable = false;
+            return true;
+        case OP_ATHROW:
+            if(depth < 1)
+                return false;
+            addPc(pc);
+            emit8(REG_ATHROW);
+            emit8(use(depth - 1));
+            isReachable = false;
+            return true;
+        case OP_GETSTATIC:
+        case OP_PUTSTATIC:
+        case OP_GETFIELD:
+        case OP_PUTFIELD: {
+            uint16_t poolIndex = CODE_TO_UINT16(&code[pc + 1]);
+            if((classLoader.getConstPool(poolIndex).tag & 0x7F) != CONST_FIELD)
+                return false;
+            char type = classLoader.getConstField(poolIndex).nameAndType.descriptor.text[0];
+            if(type == 'J' || type == 'D')
+                return false;
+            bool isObject = (type == 'L' || type == '[');
+            addPc(pc);
+            if(opcode == OP_GETSTATIC) {
+                if(depth >= attribute.maxStack)
+                    return false;
+                uint8_t dst = result(nextPc);
+                emit8(REG_GETSTATIC);
+                emit8(dst);
+            }
+            else if(opcode == OP_PUTSTATIC) {
+                if(depth < 1)
+                    return false;
+                uint8_t src = use(depth - 1);
+                depth--;
+                emit8(REG_PUTSTATIC);
+                emit8(src);
+            }
+            else if(opcode == OP_GETFIELD) {
+                if(depth < 1)
+                    return false;
+                uint8_t obj = use(depth - 1);
+                depth--;
+                uint8_t dst = result(nextPc);
+                emit8(isObject ? REG_AGETFIELD : REG_IGETFIELD);
+                emit8(dst);
+                emit8(obj);
+            }
+            else {
+                if(depth < 2)
+                    return false;
+                uint8_t src = use(depth - 1);
+                uint8_t obj = use(depth - 2);
+                depth -= 2;
+                if(isObject)
+                    emit8(REG_APUTFIELD);
+                else if(type == 'Z' || type == 'B')
+                    emit8(REG_BPUTFIELD);
+                else if(type == 'C' || type == 'S')
+                    emit8(REG_SPUTFIELD);
+                else
+                    emit8(REG_IPUTFIELD);
+                emit8(obj);
+                emit8(src);
+            }
+            emit16(poolIndex);
+            return true;
+        }
+        case OP_INVOKEVIRTUAL:
+        case OP_INVOKESPECIAL:
+        case OP_INVOKESTATIC:
+        case OP_INVOKEINTERFACE:
+            return translateInvoke(pc);
+        case OP_NEW: {
+            if(depth >= attribute.maxStack)
+                return false;
+            addPc(pc);
+            uint8_t dst = result(nextPc);
+            emit8(REG_NEW);
+            emit8(dst);
+            emit16(CODE_TO_INT16(&code[pc + 1]));
+            return true;
+        }
+        case OP_NEWARRAY:
+        case OP_ANEWARRAY: {
+            if(depth < 1)
+                return false;
+            addPc(pc);
+            uint8_t count = use(depth - 1);
+            depth--;
+            uint8_t dst = result(nextPc);
+            emit8((opcode == OP_NEWARRAY) ? REG_NEWARRAY : REG_ANEWARRAY);
+            emit8(dst);
+            emit8(count);
+            if(opcode == OP_NEWARRAY)
+                emit8(code[pc + 1]);
+            else
+                emit16(CODE_TO_INT16(&code[pc + 1]));
+            return true;
+        }
+        case OP_CHECKCAST:
+            if(depth < 1)
+                return false;
+            addPc(pc);
+            emit8(REG_CHECKCAST);
+            emit8(use(depth - 1));
+            emit16(CODE_TO_INT16(&code[pc + 1]));
+            return true;
+        case OP_INSTANCEOF: {
+            if(depth < 1)
+                return false;
+            addPc(pc);
+            uint8_t src = use(depth - 1);
+            depth--;
+            uint8_t dst = result(nextPc);
+            emit8(REG_INSTANCEOF);
+            emit8(dst);
+            emit8(src);
+            emit16(CODE_TO_INT16(&code[pc + 1]));
+            return true;
+        }
+        default:
+            /* long, double, subroutines, monitors and the rarer stack shuffles stay on the stack interpreter */
+            return false;
+    }
+}
+
+bool FlintRegBuilder::resolveBranches(void) {
+    if(regLength > 0xFFFF)
+        return false;
+    for(uint32_t i = 0; i < fixupCount; i++) {
+        /* Every branch target is a block start, so it has an entry in the table */
+        int32_t low = 0;
+        int32_t high = pcCount - 1;
+        int32_t regPc = -1;
+        while(low <= high) {
+            int32_t mid = (low + high) >> 1;
+            if(pcTable[mid].codePc < fixups[i].codePc)
+                low = mid + 1;
+            else if(pcTable[mid].codePc > fixups[i].codePc)
+                high = mid - 1;
+            else {
+                regPc = pcTable[mid].regPc;
+                break;
+            }
+        }
+        if(regPc < 0)
+            return false;
+        ((FlintUnalignedInt16 *)&regCode[fixups[i].offset])->value = (int16_t)regPc;
+    }
+    return true;
+}
+
+bool FlintRegBuilder::build(void) {
+    const uint8_t *code = attribute.code;
+    uint32_t codeLength = attribute.codeLength;
+    targets = findBranchTargets(attribute);
+    /* The method entry is a block start too, so the table always maps pc 0 */
+    markBranchTarget(targets, codeLength, 0);
+    depths = (uint16_t *)Flint::malloc(codeLength * sizeof(uint16_t));
+    for(uint32_t i = 0; i < codeLength; i++)
+        depths[i] = REG_DEPTH_UNKNOWN;
+    /* Handlers start with the thrown object as the only operand */
+    for(uint16_t i = 0; i < attribute.exceptionTableLength; i++) {
+        uint32_t handlerPc = attribute.getException(i).handlerPc;
+        if(handlerPc < codeLength)
+            depths[handlerPc] = 1;
+    }
+    entries = (FlintRegEntry *)Flint::malloc((attribute.maxStack + 1) * sizeof(FlintRegEntry));
+    regCapacity = codeLength + 16;
+    regCode = (uint8_t *)Flint::malloc(regCapacity);
+    pcCapacity = 16;
+    pcTable = (FlintRegPc *)Flint::malloc(pcCapacity * sizeof(FlintRegPc));
+    fixupCapacity = 16;
+    fixups = (FlintRegFixup *)Flint::malloc(fixupCapacity * sizeof(FlintRegFixup));
+
+    bool isReachable = true;
+    uint32_t pc = 0;
+    while(pc < codeLength) {
+        uint32_t nextPc = pc + FlintCodeTranslator::getInstructionLength(code, pc);
+        if(isBranchTarget(targets, pc)) {
+            if(!startBlock(pc, isReachable))
+                return false;
+            isReachable = true;
+        }
+        else if(!isReachable) {
+            pc = nextPc;
+            continue;
+        }
+        if(!translateInstruction(pc, nextPc, isReachable))
+            return false;
+        pc = nextPc;
+    }
+    /* Running off the end of the code is not valid bytecode */
+    if(isReachable)
+        return false;
+    return resolveBranches();
+}
+
+void FlintRegBuilder::release(uint8_t **regCode, uint16_t *regLength, FlintRegPc **pcTable, uint16_t *pcCount) {
+    *regCode = (uint8_t *)Flint::realloc(this->regCode, this->regLength);
+    *regLength = this->regLength;
+    *pcTable = (FlintRegPc *)Flint::realloc(this->pcTable, this->pcCount * sizeof(FlintRegPc));
+    *pcCount = this->pcCount;
+    this->regCode = 0;
+    this->pcTable = 0;
+}
+
+FlintRegBuilder::~FlintRegBuilder(void) {
+    if(targets)
+        Flint::free(targets);
+    if(depths)
+        Flint::free(depths);
+    if(entries)
+        Flint::free(entries);
+    if(regCode)
+        Flint::free(regCode);
+    if(pcTable)
+        Flint::free(pcTable);
+    if(fixups)
+        Flint::free(fixups);
+}
+
+static uint32_t getRegInstructionLength(const uint8_t *regCode, uint32_t pc) {
+    uint8_t opcode = regCode[pc];
+    if(REG_IADD <= opcode && opcode <= REG_FCMPG)
+        return 4;
+    if(REG_INEG <= opcode && opcode <= REG_I2S)
+        return 3;
+    if(REG_IFEQ <= opcode && opcode <= REG_IFLE)
+        return 4;
+    if(REG_IF_ICMPEQ <= opcode && opcode <= REG_IF_ICMPLE)
+        return 5;
+    if(REG_IALOAD <= opcode && opcode <= REG_CASTORE)
+        return 4;
+    if(REG_GETSTATIC <= opcode && opcode <= REG_APUTSTATIC_QUICK)
+        return 4;
+    switch(opcode) {
+        case REG_MOVE:
+        case REG_GOTO:
+        case REG_ARRAYLENGTH:
+            return 3;
+        case REG_CONST:
+            return 6;
+        case REG_IADD_IMM:
+        case REG_IGETFIELD:
+        case REG_AGETFIELD:
+        case REG_IPUTFIELD:
+        case REG_BPUTFIELD:
+        case REG_SPUTFIELD:
+        case REG_APUTFIELD:
+        case REG_ANEWARRAY:
+        case REG_INSTANCEOF:
+        case REG_INVOKEINTERFACE:
+            return 5;
+        case REG_TABLESWITCH:
+            return 12 + (CODE_TO_INT32(&regCode[pc + 8]) - CODE_TO_INT32(&regCode[pc + 4]) + 1) * 2;
+        case REG_LOOKUPSWITCH:
+            return 6 + CODE_TO_UINT16(&regCode[pc + 4]) * 6;
+        case REG_IRETURN:
+        case REG_ARETURN:
+        case REG_ATHROW:
+            return 2;
+        case REG_RETURN:
+            return 1;
+        default:
+            /* REG_ALDC, REG_NEW, REG_NEWARRAY, REG_CHECKCAST and the other invokes */
+            return 4;
+    }
+}
+
+#endif /* FLINT_REGISTER_IR */
+
+void FlintCodeTranslator::translateToRegister(FlintMethodInfo &methodInfo) {
+#if FLINT_REGISTER_IR
+    FlintCodeAttribute &attribute = methodInfo.getAttributeCode();
+    /* Registers are one byte, so the whole frame must fit in 256 slots */
+    if((attribute.maxLocals + 4 + attribute.maxStack) > 256 || attribute.codeLength == 0)
+        return;
+    FlintRegBuilder builder(methodInfo);
+    if(!builder.build())
+        return;
+    uint8_t *regCode;
+    uint16_t regLength;
+    FlintRegPc *regPcTable;
+    uint16_t regPcCount;
+    builder.release(&regCode, &regLength, &regPcTable, &regPcCount);
+    attribute.setRegCode(regCode, regLength, regPcTable, regPcCount);
+#else
+    (void)methodInfo;
+#endif
+}
+
+/* Static field sites cache the field slot and static calls skip the initialization check once they are quickened */
+void FlintCodeTranslator::resetStaticAccess(FlintMethodInfo &methodInfo) {
+    FlintCodeAttribute &attribute = methodInfo.getAttributeCode();
+    uint8_t *code = (uint8_t *)attribute.code;
+    for(uint32_t pc = 0; pc < attribute.codeLength; pc += getInstructionLength(code, pc)) {
+        switch(code[pc]) {
+            case OP_IGETSTATIC_QUICK:
+            case OP_LGETSTATIC_QUICK:
+            case OP_AGETSTATIC_QUICK:
+                code[pc] = OP_GETSTATIC;
+                break;
+            case OP_BPUTSTATIC_QUICK:
+            case OP_SPUTSTATIC_QUICK:
+            case OP_IPUTSTATIC_QUICK:
+            case OP_LPUTSTATIC_QUICK:
+            case OP_APUTSTATIC_QUICK:
+                code[pc] = OP_PUTSTATIC;
+                break;
+            case OP_INVOKESTATIC_QUICK:
+                code[pc] = OP_INVOKESTATIC;
+                break;
+            default:
+                break;
+        }
+    }
+#if FLINT_REGISTER_IR
+    uint8_t *regCode = (uint8_t *)attribute.regCode;
+    for(uint32_t pc = 0; pc < attribute.regLength; pc += getRegInstructionLength(regCode, pc)) {
+        if(REG_IGETSTATIC_QUICK <= regCode[pc] && regCode[pc] <= REG_AGETSTATIC_QUICK)
+            regCode[pc] = REG_GETSTATIC;
+        else if(REG_IPUTSTATIC_QUICK <= regCode[pc] && regCode[pc] <= REG_APUTSTATIC_QUICK)
+            regCode[pc] = REG_PUTSTATIC;
+    }
+#endif
+}
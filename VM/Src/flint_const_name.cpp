@@ -28,9 +28,11 @@ const FlintConstUtf8 &booleanClassName = *(const FlintConstUtf8 *)"\x11\x00\x4B\
 const FlintConstUtf8 &integerClassName = *(const FlintConstUtf8 *)"\x11\x00\x35\x08""java/lang/Integer";
 const FlintConstUtf8 &arrayClassName = *(const FlintConstUtf8 *)"\x17\x00\xBD\xBC""java/lang/reflect/Array";
 const FlintConstUtf8 &characterClassName = *(const FlintConstUtf8 *)"\x13\x00\x92\x49""java/lang/Character";
+const FlintConstUtf8 &cloneableClassName = *(const FlintConstUtf8 *)"\x13\x00\x29\xC4""java/lang/Cloneable";
 const FlintConstUtf8 &throwableClassName = *(const FlintConstUtf8 *)"\x13\x00\xB7\x14""java/lang/Throwable";
 const FlintConstUtf8 &exceptionClassName = *(const FlintConstUtf8 *)"\x13\x00\xF6\xDA""java/lang/Exception";
 const FlintConstUtf8 &bigIntegerClassName = *(const FlintConstUtf8 *)"\x14\x00\x72\xF5""java/math/BigInteger";
+const FlintConstUtf8 &serializableClassName = *(const FlintConstUtf8 *)"\x14\x00\xB9\x6F""java/io/Serializable";
 const FlintConstUtf8 &printStreamClassName = *(const FlintConstUtf8 *)"\x13\x00\x34\x38""java/io/PrintStream";
 const FlintConstUtf8 &ioExceptionClassName = *(const FlintConstUtf8 *)"\x15\x00\xE3\x8E""java/lang/IOException";
 const FlintConstUtf8 &flintGraphicsClassName = *(const FlintConstUtf8 *)"\x16\x00\x9C\xA2""flint/drawing/Graphics";
@@ -39,6 +41,9 @@ const FlintConstUtf8 &arrayStoreExceptionClassName = *(const FlintConstUtf8 *)"\
 const FlintConstUtf8 &arithmeticExceptionClassName = *(const FlintConstUtf8 *)"\x1D\x00\x19\x72""java/lang/ArithmeticException";
 const FlintConstUtf8 &nullPointerExceptionClassName = *(const FlintConstUtf8 *)"\x1E\x00\x0F\xCB""java/lang/NullPointerException";
 const FlintConstUtf8 &unsatisfiedLinkErrorClassName = *(const FlintConstUtf8 *)"\x1E\x00\x77\x94""java/lang/UnsatisfiedLinkError";
+const FlintConstUtf8 &outOfMemoryErrorClassName = *(const FlintConstUtf8 *)"\x1A\x00\xD8\x3A""java/lang/OutOfMemoryError";
+const FlintConstUtf8 &stackOverflowErrorClassName = *(const FlintConstUtf8 *)"\x1C\x00\xCF\x7A""java/lang/StackOverflowError";
+const FlintConstUtf8 &stackTraceElementClassName = *(const FlintConstUtf8 *)"\x1B\x00\x7E\x57""java/lang/StackTraceElement";
 const FlintConstUtf8 &interruptedExceptionClassName = *(const FlintConstUtf8 *)"\x1E\x00\x19\x97""java/lang/InterruptedException";
 const FlintConstUtf8 &classNotFoundExceptionClassName = *(const FlintConstUtf8 *)"\x20\x00\xFD\xFC""java/lang/ClassNotFoundException";
 const FlintConstUtf8 &illegalArgumentExceptionClassName = *(const FlintConstUtf8 *)"\x22\x00\x6D\x2A""java/lang/IllegalArgumentException";
@@ -3,39 +3,6 @@
 #include "flint_common.h"
 #include "flint_const_pool.h"
 
-static FlintParamInfo parseParamInfo(const FlintConstUtf8 &descriptor) {
-    const char *text = descriptor.text;
-    FlintParamInfo retVal = {0, 0};
-    if(*text != '(')
-        throw "the descriptor is not a description of the method";
-    text++;
-    while(*text) {
-        if(*text == ')') {
-            retVal.retType = text[1];
-            return retVal;
-        }
-        else if(*text == '[')
-            text++;
-        else {
-            retVal.argc += (*text == 'J' || *text == 'D') ? 2 : 1;
-            if(*text++ == 'L') {
-                while(*text) {
-                    if(*text == ')') {
-                        retVal.retType = text[1];
-                        return retVal;
-                    }
-                    else if(*text == ';') {
-                        text++;
-                        break;
-                    }
-                    text++;
-                }
-            }
-        }
-    }
-    throw "descriptor is invalid";
-}
-
 bool FlintConstUtf8::operator==(const FlintConstUtf8 &another) const {
     if(this == &another)
         return true;
@@ -62,25 +29,62 @@ name(name), descriptor(descriptor) {
 }
 
 FlintConstField::FlintConstField(FlintConstUtf8 &className, FlintConstNameAndType &nameAndType) :
-className(className), nameAndType(nameAndType), fieldIndex(0) {
+className(className), nameAndType(nameAndType), fieldIndex(0), staticValue(0) {
 
 }
 
 FlintConstMethod::FlintConstMethod(FlintConstUtf8 &className, FlintConstNameAndType &nameAndType) :
-className(className), nameAndType(nameAndType), methodInfo(0) {
+className(className), nameAndType(nameAndType), methodInfo(0), vtableIndex(VTABLE_INDEX_UNRESOLVED), inlineCache(0) {
     paramInfo = parseParamInfo(nameAndType.descriptor);
 }
 
 FlintConstMethod::FlintConstMethod(FlintConstUtf8 &className, FlintConstNameAndType &nameAndType, uint8_t argc, uint8_t retType) :
-className(className), nameAndType(nameAndType), methodInfo(0) {
+className(className), nameAndType(nameAndType), methodInfo(0), vtableIndex(VTABLE_INDEX_UNRESOLVED), inlineCache(0) {
     paramInfo.argc = argc;
     paramInfo.retType = retType;
 }
 
+FlintParamInfo FlintConstMethod::parseParamInfo(const FlintConstUtf8 &descriptor) {
+    const char *text = descriptor.text;
+    FlintParamInfo retVal = {0, 0};
+    if(*text != '(')
+        throw "the descriptor is not a description of the method";
+    text++;
+    while(*text) {
+        if(*text == ')') {
+            retVal.retType = text[1];
+            return retVal;
+        }
+        else if(*text == '[')
+            text++;
+        else {
+            retVal.argc += (*text == 'J' || *text == 'D') ? 2 : 1;
+            if(*text++ == 'L') {
+                while(*text) {
+                    if(*text == ')') {
+                        retVal.retType = text[1];
+                        return retVal;
+                    }
+                    else if(*text == ';') {
+                        text++;
+                        break;
+                    }
+                    text++;
+                }
+            }
+        }
+    }
+    throw "descriptor is invalid";
+}
+
 const FlintParamInfo &FlintConstMethod::getParmInfo() {
     return paramInfo;
 }
 
+const FlintInlineCache *FlintConstMethod::getInlineCache(void) const {
+    return inlineCache;
+}
+
 bool FlintConstNameAndType::operator==(const FlintConstNameAndType &another) const {
     if((name == another.name) &&  (descriptor == another.descriptor))
         return true;
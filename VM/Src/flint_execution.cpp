@@ -6,6 +6,10 @@
 #include "flint_execution.h"
 #include "flint_const_name.h"
 #include "flint_system_api.h"
+#include "flint_code_translator.h"
+#include "flint_opcode_profiler.h"
+#include "flint_inline_cache.h"
+#include "flint_jit.h"
 
 #if __has_include("flint_conf.h")
 #include "flint_conf.h"
@@ -15,11 +19,247 @@
 #define FLOAT_NAN                   0x7FC00000
 #define DOUBLE_NAN                  0x7FF8000000000000
 
-#define ARRAY_TO_INT16(array)       (int16_t)(((array)[0] << 8) | (array)[1])
-#define ARRAY_TO_INT32(array)       (int32_t)(((array)[0] << 24) | ((array)[1] << 16) | ((array)[2] << 8) | (array)[3])
+/*
+ * run() keeps pc, sp, code, locals, stack and stackType in local variables.
+ * The macros below work on those locals, SAVE_REGISTERS/LOAD_REGISTERS sync them with the execution
+ * around anything that reads or changes the frame (invoke, return, exception dispatch and the debugger).
+ */
+#define SAVE_REGISTERS() do {                       \
+    this->pc = pc;                                  \
+    this->sp = sp;                                  \
+} while(0)
+
+#define LOAD_REGISTERS() do {                       \
+    pc = this->pc;                                  \
+    sp = this->sp;                                  \
+    code = this->code;                              \
+    locals = this->locals;                          \
+} while(0)
+
+/* Reference bits of the stack slots, not kept when the GC scans the stacks conservatively */
+#if FLINT_GC_CONSERVATIVE_STACK
+#define SET_STACK_OBJECT(_index)    ((void)(_index))
+#define CLEAR_STACK_OBJECT(_index)  ((void)(_index))
+#define IS_STACK_OBJECT(_index)     ((void)(_index), false)
+#else
+#define SET_STACK_OBJECT(_index)    (stackType[(_index) / 8] |= (1 << ((_index) % 8)))
+#define CLEAR_STACK_OBJECT(_index)  (stackType[(_index) / 8] &= ~(1 << ((_index) % 8)))
+#define IS_STACK_OBJECT(_index)     (stackType[(_index) / 8] & (1 << ((_index) % 8)))
+#endif
+
+#define STACK_PUSH(_value) do {                     \
+    sp++;                                           \
+    stack[sp] = (_value).value;                     \
+    if((_value).type == STACK_TYPE_OBJECT)          \
+        SET_STACK_OBJECT(sp);                       \
+    else                                            \
+        CLEAR_STACK_OBJECT(sp);                     \
+} while(0)
+
+#define STACK_PUSH_INT32(_value) do {               \
+    int32_t tmp = (_value);                         \
+    sp++;                                           \
+    stack[sp] = tmp;                                \
+    CLEAR_STACK_OBJECT(sp);                         \
+} while(0)
+
+#define STACK_PUSH_INT64(_value) do {               \
+    int64_t tmp = (_value);                         \
+    sp++;                                           \
+    stack[sp] = ((uint32_t *)&tmp)[0];              \
+    CLEAR_STACK_OBJECT(sp);                         \
+    sp++;                                           \
+    stack[sp] = ((uint32_t *)&tmp)[1];              \
+    CLEAR_STACK_OBJECT(sp);                         \
+} while(0)
+
+#define STACK_PUSH_FLOAT(_value) do {               \
+    float tmp = (_value);                           \
+    sp++;                                           \
+    stack[sp] = *(uint32_t *)&tmp;                  \
+    CLEAR_STACK_OBJECT(sp);                         \
+} while(0)
+
+#define STACK_PUSH_DOUBLE(_value) do {              \
+    double tmp = (_value);                          \
+    sp++;                                           \
+    stack[sp] = ((uint32_t *)&tmp)[0];              \
+    CLEAR_STACK_OBJECT(sp);                         \
+    sp++;                                           \
+    stack[sp] = ((uint32_t *)&tmp)[1];              \
+    CLEAR_STACK_OBJECT(sp);                         \
+} while(0)
+
+#define STACK_PUSH_OBJECT(_obj) do {                \
+    FlintJavaObject *tmp = (_obj);                  \
+    sp++;                                           \
+    stack[sp] = (int32_t)tmp;                       \
+    SET_STACK_OBJECT(sp);                           \
+    if(tmp && (tmp->getProtected() & 0x02))         \
+        flint.clearProtectObjectNew(*tmp);          \
+} while(0)
+
+#define STACK_POP_INT32()           (stack[sp--])
+#define STACK_POP_INT64()           (sp -= 2, stackReadInt64(&stack[sp + 1]))
+#define STACK_POP_FLOAT()           (*(float *)&stack[sp--])
+#define STACK_POP_DOUBLE()          (sp -= 2, stackReadDouble(&stack[sp + 1]))
+#define STACK_POP_OBJECT()          ((FlintJavaObject *)stack[sp--])
+
+#if FLINT_JIT
+/* Runs the compiled code of the method from pc until it reaches an instruction it leaves to the interpreter */
+#define JIT_ENTER() do {                            \
+    FlintJitCode *jitCode = method->jitCode;        \
+    if(jitCode && opcodes == opcodeLabels) {        \
+        FlintJitFrame jitFrame = {locals, stack, sp, pc, &this->opcodes, opcodeLabels, 0}; \
+        if(FlintJit::enter(flint, *jitCode, jitFrame)) { \
+            sp = jitFrame.sp;                       \
+            pc = jitFrame.pc;                       \
+        }                                           \
+    }                                               \
+} while(0)
+
+/* Backward branches count towards the hotness of the method and continue in its compiled code (OSR) */
+#define JUMP(_offset) do {                          \
+    int32_t offset = (_offset);                     \
+    pc += offset;                                   \
+    if(offset <= 0) {                               \
+        if(method->hotCount <= FLINT_JIT_THRESHOLD) \
+            FlintJit::countHot(*method);            \
+        JIT_ENTER();                                \
+    }                                               \
+} while(0)
+#else
+#define JIT_ENTER()
+#define JUMP(_offset)               (pc += (_offset))
+#endif
+
+#define BRANCH(_cond, _offset, _length) do {        \
+    if(_cond)                                       \
+        JUMP(_offset);                              \
+    else                                            \
+        pc += (_length);                            \
+} while(0)
+
+#if FLINT_REGISTER_IR
+/* Frames running the register code keep their pc tagged with REG_PC_FLAG */
+#define RESUME_FRAME() do {                         \
+    if(pc & REG_PC_FLAG)                            \
+        goto reg_resume;                            \
+    JIT_ENTER();                                    \
+    goto *opcodes[code[pc]];                        \
+} while(0)
+
+#define REG_FLOAT(_reg)             (*(float *)&locals[_reg])
+#define REG_OBJECT(_reg)            ((FlintJavaObject *)locals[_reg])
+
+/* The value is read before the destination is written, it may be one of the sources */
+#define REG_SET_INT32(_reg, _value) do {            \
+    int32_t tmp = (_value);                         \
+    int32_t *reg = &locals[_reg];                   \
+    *reg = tmp;                                     \
+    CLEAR_STACK_OBJECT(reg - stack);                \
+} while(0)
+
+#define REG_SET_FLOAT(_reg, _value) do {            \
+    float tmp = (_value);                           \
+    int32_t *reg = &locals[_reg];                   \
+    *reg = *(int32_t *)&tmp;                        \
+    CLEAR_STACK_OBJECT(reg - stack);                \
+} while(0)
+
+#define REG_SET_OBJECT(_reg, _obj) do {             \
+    FlintJavaObject *tmp = (_obj);                  \
+    int32_t *reg = &locals[_reg];                   \
+    *reg = (int32_t)tmp;                            \
+    SET_STACK_OBJECT(reg - stack);                  \
+    if(tmp && (tmp->getProtected() & 0x02))         \
+        flint.clearProtectObjectNew(*tmp);          \
+} while(0)
+
+#define REG_NEXT(_length) do {                      \
+    pc += (_length);                                \
+    goto *regLabels[regCode[pc]];                   \
+} while(0)
+
+/* Loops check for a terminate request on their backward branches */
+#define REG_JUMP(_target) do {                      \
+    uint32_t target = (_target);                    \
+    if(target <= pc && opcodes == opcodeLabelsExit) {   \
+        pc |= REG_PC_FLAG;                          \
+        goto op_exit;                               \
+    }                                               \
+    pc = target;                                    \
+    goto *regLabels[regCode[pc]];                   \
+} while(0)
+
+/* The exception labels of the stack code expect the bytecode pc and an empty operand stack */
+#define REG_THROW(_label) do {                      \
+    pc = method->getAttributeCode().getCodePc(pc);  \
+    sp = startSp;                                   \
+    goto _label;                                    \
+} while(0)
+#else
+#define RESUME_FRAME() do {                         \
+    JIT_ENTER();                                    \
+    goto *opcodes[code[pc]];                        \
+} while(0)
+#endif
 
 static const void **opcodeLabelsExit = 0;
 
+static int64_t stackReadInt64(const int32_t *value) {
+    uint64_t ret;
+    ((uint32_t *)&ret)[0] = value[0];
+    ((uint32_t *)&ret)[1] = value[1];
+    return ret;
+}
+
+static double stackReadDouble(const int32_t *value) {
+    uint64_t ret;
+    ((uint32_t *)&ret)[0] = value[0];
+    ((uint32_t *)&ret)[1] = value[1];
+    return *(double *)&ret;
+}
+
+static uint32_t getCodePc(const FlintMethodInfo &methodInfo, uint32_t pc) {
+#if FLINT_REGISTER_IR
+    if(pc & REG_PC_FLAG)
+        return methodInfo.getAttributeCode().getCodePc(pc & ~REG_PC_FLAG);
+#else
+    (void)methodInfo;
+#endif
+    return pc;
+}
+
+static int32_t intRegOp(uint8_t kind, int32_t value1, int32_t value2) {
+    switch(kind) {
+        case IREG_ADD: return value1 + value2;
+        case IREG_SUB: return value1 - value2;
+        case IREG_MUL: return value1 * value2;
+        case IREG_AND: return value1 & value2;
+        case IREG_OR: return value1 | value2;
+        case IREG_XOR: return value1 ^ value2;
+        case IREG_SHL: return value1 << (value2 & 0x1F);
+        case IREG_SHR: return value1 >> (value2 & 0x1F);
+        default: return (uint32_t)value1 >> (value2 & 0x1F);
+    }
+}
+
+static bool intRegCompare(uint8_t cond, int32_t value1, int32_t value2) {
+    switch(cond) {
+        case OP_IF_ICMPEQ - OP_IF_ICMPEQ: return value1 == value2;
+        case OP_IF_ICMPNE - OP_IF_ICMPEQ: return value1 != value2;
+        case OP_IF_ICMPLT - OP_IF_ICMPEQ: return value1 < value2;
+        case OP_IF_ICMPGE - OP_IF_ICMPEQ: return value1 >= value2;
+        case OP_IF_ICMPGT - OP_IF_ICMPEQ: return value1 > value2;
+        default: return value1 <= value2;
+    }
+}
+
+static void quickenOpCode(const uint8_t *code, uint8_t opcode) {
+    *(volatile uint8_t *)code = opcode;
+}
+
 FlintExecution::FlintExecution(Flint &flint, FlintJavaThread *onwerThread) : flint(flint), stackLength(DEFAULT_STACK_SIZE / sizeof(int32_t)) {
     this->opcodes = 0;
     this->lr = -1;
@@ -27,8 +267,13 @@ FlintExecution::FlintExecution(Flint &flint, FlintJavaThread *onwerThread) : fli
     this->startSp = sp;
     this->peakSp = sp;
     this->stack = (int32_t *)Flint::malloc(DEFAULT_STACK_SIZE);
+#if FLINT_GC_CONSERVATIVE_STACK
+    this->stackType = 0;
+#else
     this->stackType = (uint8_t *)Flint::malloc(DEFAULT_STACK_SIZE / sizeof(int32_t) / 8);
+#endif
     this->onwerThread = onwerThread;
+    this->pendingException = 0;
 }
 
 FlintExecution::FlintExecution(Flint &flint, FlintJavaThread *onwerThread, uint32_t stackSize) : flint(flint), stackLength(stackSize / sizeof(int32_t)) {
@@ -38,17 +283,22 @@ FlintExecution::FlintExecution(Flint &flint, FlintJavaThread *onwerThread, uint3
     this->startSp = sp;
     this->peakSp = sp;
     this->stack = (int32_t *)Flint::malloc(stackSize);
+#if FLINT_GC_CONSERVATIVE_STACK
+    this->stackType = 0;
+#else
     this->stackType = (uint8_t *)Flint::malloc(stackSize / sizeof(int32_t) / 8);
+#endif
     this->onwerThread = onwerThread;
+    this->pendingException = 0;
 }
 
 FlintStackType FlintExecution::getStackType(uint32_t index) {
-    return (stackType[index / 8] & (1 << (index % 8))) ? STACK_TYPE_OBJECT : STACK_TYPE_NON_OBJECT;
+    return IS_STACK_OBJECT(index) ? STACK_TYPE_OBJECT : STACK_TYPE_NON_OBJECT;
 }
 
 FlintStackValue FlintExecution::getStackValue(uint32_t index) {
     FlintStackValue ret = {
-        .type = (stackType[index / 8] & (1 << (index % 8))) ? STACK_TYPE_OBJECT : STACK_TYPE_NON_OBJECT,
+        .type = IS_STACK_OBJECT(index) ? STACK_TYPE_OBJECT : STACK_TYPE_NON_OBJECT,
         .value = stack[index],
     };
     return ret;
@@ -57,54 +307,62 @@ FlintStackValue FlintExecution::getStackValue(uint32_t index) {
 void FlintExecution::setStackValue(uint32_t index, FlintStackValue &value) {
     stack[index] = value.value;
     if(value.type == STACK_TYPE_OBJECT)
-        stackType[index / 8] |= (1 << (index % 8));
+        SET_STACK_OBJECT(index);
     else
-        stackType[index / 8] &= ~(1 << (index % 8));
+        CLEAR_STACK_OBJECT(index);
 }
 
 void FlintExecution::stackPush(FlintStackValue &value) {
-    sp = peakSp = sp + 1;
+    if(++sp > peakSp)
+        peakSp = sp;
     stack[sp] = value.value;
     if(value.type == STACK_TYPE_OBJECT)
-        stackType[sp / 8] |= (1 << (sp % 8));
+        SET_STACK_OBJECT(sp);
     else
-        stackType[sp / 8] &= ~(1 << (sp % 8));
+        CLEAR_STACK_OBJECT(sp);
 }
 
 void FlintExecution::stackPushInt32(int32_t value) {
-    sp = peakSp = sp + 1;
+    if(++sp > peakSp)
+        peakSp = sp;
     stack[sp] = value;
-    stackType[sp / 8] &= ~(1 << (sp % 8));
+    CLEAR_STACK_OBJECT(sp);
 }
 
 void FlintExecution::stackPushInt64(int64_t value) {
-    sp = peakSp = sp + 1;
+    if(++sp > peakSp)
+        peakSp = sp;
     stack[sp] = ((uint32_t *)&value)[0];
-    stackType[sp / 8] &= ~(1 << (sp % 8));
-    sp = peakSp = sp + 1;
+    CLEAR_STACK_OBJECT(sp);
+    if(++sp > peakSp)
+        peakSp = sp;
     stack[sp] = ((uint32_t *)&value)[1];
-    stackType[sp / 8] &= ~(1 << (sp % 8));
+    CLEAR_STACK_OBJECT(sp);
 }
 
 void FlintExecution::stackPushFloat(float value) {
-    sp = peakSp = sp + 1;
+    if(++sp > peakSp)
+        peakSp = sp;
     stack[sp] = *(uint32_t *)&value;
-    stackType[sp / 8] &= ~(1 << (sp % 8));
+    CLEAR_STACK_OBJECT(sp);
 }
 
 void FlintExecution::stackPushDouble(double value) {
-    sp = peakSp = sp + 1;
+    if(++sp > peakSp)
+        peakSp = sp;
     stack[sp] = ((uint32_t *)&value)[0];
-    stackType[sp / 8] &= ~(1 << (sp % 8));
-    sp = peakSp = sp + 1;
+    CLEAR_STACK_OBJECT(sp);
+    if(++sp > peakSp)
+        peakSp = sp;
     stack[sp] = ((uint32_t *)&value)[1];
-    stackType[sp / 8] &= ~(1 << (sp % 8));
+    CLEAR_STACK_OBJECT(sp);
 }
 
 void FlintExecution::stackPushObject(FlintJavaObject *obj) {
-    sp = peakSp = sp + 1;
+    if(++sp > peakSp)
+        peakSp = sp;
     stack[sp] = (int32_t)obj;
-    stackType[sp / 8] |= (1 << (sp % 8));
+    SET_STACK_OBJECT(sp);
     if(obj && (obj->getProtected() & 0x02))
         flint.clearProtectObjectNew(*obj);
 }
@@ -138,38 +396,129 @@ FlintJavaObject *FlintExecution::stackPopObject(void) {
 }
 
 bool FlintExecution::getStackTrace(uint32_t index, FlintStackFrame *stackTrace, bool *isEndStack) const {
+    /* The last word of the saved context is the startSp of the caller, it is negative for the first frame */
     if(index == 0) {
-        new (stackTrace)FlintStackFrame(pc, startSp, *method);
+        new (stackTrace)FlintStackFrame(getCodePc(*method, pc), startSp, *method);
         if(isEndStack)
-            *isEndStack = (startSp < 4);
+            *isEndStack = (startSp < 0 || stack[startSp] < 0);
         return true;
     }
     else {
         int32_t traceSp = startSp;
-        if(traceSp < 4)
+        if(traceSp < 0 || stack[traceSp] < 0)
             return false;
         while(--index) {
             traceSp = stack[traceSp];
-            if(traceSp < 4)
+            if(stack[traceSp] < 0)
                 return false;
         }
-        uint32_t tracePc = stack[traceSp - 2];
         FlintMethodInfo &traceMethod = *(FlintMethodInfo *)stack[traceSp - 3];
+        uint32_t tracePc = getCodePc(traceMethod, stack[traceSp - 2]);
         traceSp = stack[traceSp];
         new (stackTrace)FlintStackFrame(tracePc, traceSp, traceMethod);
         if(isEndStack)
-            *isEndStack = (traceSp < 4);
+            *isEndStack = (stack[traceSp] < 0);
         return true;
     }
 }
 
+void FlintExecution::fillInStackTrace(bool isConstructing) {
+    /* The throwable stays on the stack while the trace is allocated so the GC can see it */
+    FlintJavaThrowable &throwable = *(FlintJavaThrowable *)stack[sp];
+    FlintThrowableData *throwableData = throwable.getThrowableData();
+    if(throwableData == 0)
+        return;
+    throwableData->isTraceFilled = 1;
+    throwableData->backtrace = 0;
+#if FLINT_STACK_TRACE_DEPTH
+    ClassData &classData = *(ClassData *)&throwable.getFields().classLoader;
+    try {
+        if(!flint.isStackTraceEnabled(classData))
+            return;
+        uint32_t tracePc = getCodePc(*method, pc);
+        int32_t traceStartSp = startSp;
+        FlintMethodInfo *traceMethod = method;
+        /* The constructors of the throwable are not part of its trace */
+        while(
+            isConstructing && traceStartSp >= 0 && stack[traceStartSp] >= 0 &&
+            traceMethod->name == *(FlintConstUtf8 *)"\x06\x00\xCC\xF5""<init>" &&
+            flint.isSubclassOf(classData, *(ClassData *)&traceMethod->classLoader)
+        ) {
+            traceMethod = (FlintMethodInfo *)stack[traceStartSp - 3];
+            tracePc = getCodePc(*traceMethod, stack[traceStartSp - 2]);
+            traceStartSp = stack[traceStartSp];
+        }
+        uint32_t depth = 1;
+        for(int32_t i = traceStartSp; depth < FLINT_STACK_TRACE_DEPTH && i >= 0 && stack[i] >= 0; i = stack[i])
+            depth++;
+        FlintInt32Array &backtrace = flint.newIntegerArray(depth * 2);
+        int32_t *data = backtrace.getData();
+        for(uint32_t i = 0; i < depth; i++) {
+            data[i * 2] = (int32_t)traceMethod;
+            data[i * 2 + 1] = tracePc;
+            if(i + 1 < depth) {
+                traceMethod = (FlintMethodInfo *)stack[traceStartSp - 3];
+                tracePc = getCodePc(*traceMethod, stack[traceStartSp - 2]);
+                traceStartSp = stack[traceStartSp];
+            }
+        }
+        throwableData->backtrace = &backtrace;
+        flint.clearProtectObjectNew(backtrace);
+    }
+    catch(...) {
+        /* A throwable without a trace is better than a second failure */
+    }
+#else
+    (void)isConstructing;
+#endif
+}
+
+void FlintExecution::throwException(FlintJavaThrowable *excp) {
+    /* Raised when the native or compiled code returns, the caller's frame is still the current one */
+    pendingException = excp;
+}
+
+static void printStackTrace(Flint &flint, FlintJavaThrowable &throwable) {
+    FlintThrowableData *throwableData = throwable.getThrowableData();
+    FlintInt32Array *backtrace = throwableData ? throwableData->backtrace : 0;
+    uint32_t count = backtrace ? (backtrace->getLength() / 2) : 0;
+    for(uint32_t i = 0; i < count; i++) {
+        FlintMethodInfo &traceMethod = *(FlintMethodInfo *)backtrace->getData()[i * 2];
+        int32_t lineNumber = traceMethod.getAttributeCode().getLineNumber(backtrace->getData()[i * 2 + 1]);
+        FlintConstUtf8 &className = traceMethod.classLoader.getThisClass();
+        flint.print("    at ", 7, 0);
+        for(uint32_t k = 0; k < className.length; k++)
+            flint.print((className.text[k] == '/') ? "." : &className.text[k], 1, 0);
+        flint.print(".", 1, 0);
+        flint.print(traceMethod.name.text, traceMethod.name.length, 0);
+        if(lineNumber >= 0) {
+            char lineBuff[13];
+            uint32_t length = sprintf(lineBuff, ":%d", (int)lineNumber);
+            flint.print(lineBuff, length, 0);
+        }
+        flint.print("\n", 1, 0);
+    }
+}
+
 bool FlintExecution::readLocal(uint32_t stackIndex, uint32_t localIndex, uint32_t &value, bool &isObject) const {
     FlintStackFrame stackTrace;
     if(!getStackTrace(stackIndex, &stackTrace, 0))
         return false;
-    value = stack[stackTrace.baseSp + 1 + localIndex];
-    uint32_t spIndex = &stack[stackTrace.baseSp + 1 + localIndex] - stack;
-    isObject = (stackType[spIndex / 8] & (1 << (spIndex % 8))) ? true : false;
+    FlintCodeAttribute &attributeCode = stackTrace.method.getAttributeCode();
+    uint32_t spIndex = stackTrace.baseSp - 3 - attributeCode.maxLocals + localIndex;
+    value = stack[spIndex];
+#if FLINT_GC_CONSERVATIVE_STACK
+    /* The stack has no type bits, the debug info gives the type and the object list is only the fallback */
+    uint16_t descriptorIndex = attributeCode.getLocalDescriptorIndex(stackTrace.pc, localIndex);
+    if(descriptorIndex) {
+        char type = stackTrace.method.classLoader.getConstUtf8(descriptorIndex).text[0];
+        isObject = (value != 0) && (type == 'L' || type == '[');
+    }
+    else
+        isObject = flint.isObject(value);
+#else
+    isObject = IS_STACK_OBJECT(spIndex) ? true : false;
+#endif
     return true;
 }
 
@@ -177,47 +526,66 @@ bool FlintExecution::readLocal(uint32_t stackIndex, uint32_t localIndex, uint64_
     FlintStackFrame stackTrace;
     if(!getStackTrace(stackIndex, &stackTrace, 0))
         return false;
-    value = *(int64_t *)&stack[stackTrace.baseSp + 1 + localIndex];
+    uint32_t spIndex = stackTrace.baseSp - 3 - stackTrace.method.getAttributeCode().maxLocals + localIndex;
+    value = *(int64_t *)&stack[spIndex];
     return true;
 }
 
 void FlintExecution::initNewContext(FlintMethodInfo &methodInfo, uint16_t argc) {
     FlintCodeAttribute &attributeCode = methodInfo.getAttributeCode();
-    if((sp + attributeCode.maxLocals + attributeCode.maxStack + 4) >= stackLength)
-        throw (FlintOutOfMemoryError *)"Stack overflow";
+    int32_t localsSp = sp - argc + 1;
+    if((localsSp + methodInfo.frameSize + 4) >= stackLength) {
+        if(flint.getStackOverflowError() == 0)
+            throw (FlintOutOfMemoryError *)"Stack overflow";
+        pendingException = flint.getStackOverflowError();
+        return;
+    }
 
-    /* Save current context */
+    /* The arguments already on the stack become the first locals of the new frame */
+    for(uint32_t i = argc; i < attributeCode.maxLocals; i++) {
+        uint32_t index = localsSp + i;
+        stack[index] = 0;
+        CLEAR_STACK_OBJECT(index);
+    }
+    sp = localsSp + attributeCode.maxLocals - 1;
+
+    /* Save current context after the locals */
     stack[++sp] = (int32_t)method;
-    stackType[sp / 8] &= ~(1 << (sp % 8));
+    CLEAR_STACK_OBJECT(sp);
     stack[++sp] = pc;
-    stackType[sp / 8] &= ~(1 << (sp % 8));
+    CLEAR_STACK_OBJECT(sp);
     stack[++sp] = lr;
-    stackType[sp / 8] &= ~(1 << (sp % 8));
+    CLEAR_STACK_OBJECT(sp);
     stack[++sp] = startSp;
-    stackType[sp / 8] &= ~(1 << (sp % 8));
+    CLEAR_STACK_OBJECT(sp);
     startSp = sp;
 
     method = &methodInfo;
     code = attributeCode.code;
+#if FLINT_REGISTER_IR
+    pc = attributeCode.regCode ? REG_PC_FLAG : 0;
+#else
     pc = 0;
-    locals = &stack[sp + 1];
-    for(uint32_t i = argc; i < attributeCode.maxLocals; i++) {
-        uint32_t index = sp + i + 1;
-        stack[index] = 0;
-        stackType[index / 8] &= ~(1 << (index % 8));
-    }
-    sp += attributeCode.maxLocals;
+#endif
+    locals = &stack[localsSp];
+
+    /* The GC scans up to peakSp, so it covers the whole frame and run() can push without updating it */
+    int32_t frameTop = sp + attributeCode.maxStack;
+    for(int32_t i = sp + 1; i <= frameTop; i++)
+        CLEAR_STACK_OBJECT(i);
+    if(frameTop > peakSp)
+        peakSp = frameTop;
 }
 
 void FlintExecution::stackInitExitPoint(uint32_t exitPc) {
-    int32_t argc = sp + 1;
-    for(uint32_t i = 0; i < argc; i++) {
-        FlintStackValue stackValue = getStackValue(sp - i);
-        setStackValue(sp - i + 4, stackValue);
-    }
-    sp -= argc;
     pc = lr = exitPc;
-    initNewContext(*method, argc);
+    initNewContext(*method, sp + 1);
+    if(pendingException) {
+        /* There is no Java frame yet to raise it in */
+        FlintJavaThrowable *excp = pendingException;
+        pendingException = 0;
+        throw excp;
+    }
 }
 
 void FlintExecution::stackRestoreContext(void) {
@@ -233,180 +601,467 @@ void FlintExecution::stackRestoreContext(void) {
         }
         Flint::unlock();
     }
-    sp = startSp;
-    startSp = stackPopInt32();
-    lr = stackPopInt32();
-    pc = stackPopInt32();
-    method = (FlintMethodInfo *)stackPopInt32();
-    code = method->getAttributeCode().code;
-    locals = &stack[startSp + 1];
+    int32_t contextSp = startSp;
+    startSp = stack[contextSp];
+    lr = stack[contextSp - 1];
+    pc = stack[contextSp - 2];
+    method = (FlintMethodInfo *)stack[contextSp - 3];
+    sp = (locals - stack) - 1;
+    FlintCodeAttribute &attributeCode = method->getAttributeCode();
+    code = attributeCode.code;
+    locals = (startSp >= 0) ? &stack[startSp - 3 - attributeCode.maxLocals] : stack;
+    peakSp = startSp + attributeCode.maxStack;
 }
 
-void FlintExecution::invoke(FlintMethodInfo &methodInfo, uint8_t argc) {
-    if(!(methodInfo.accessFlag & METHOD_NATIVE)) {
-        peakSp = sp + 4;
-        for(uint32_t i = 0; i < argc; i++) {
-            FlintStackValue stackValue = getStackValue(sp - i);
-            setStackValue(sp - i + 4, stackValue);
-        }
-        sp -= argc;
-        initNewContext(methodInfo, argc);
+bool FlintExecution::isClassInitialized(ClassData &classData) const {
+    if(classData.initStatus == CLASS_INITIALIZED)
+        return true;
+    /* Accesses made by <clinit> itself must not wait for it */
+    return (classData.initStatus == CLASS_INITIALIZING) && (classData.initOwnId == (uint32_t)this);
+}
+
+void FlintExecution::endClassInit(ClassData &classData, bool isCompleted) {
+    Flint::lock();
+    if(classData.initStatus == CLASS_INITIALIZING && classData.initOwnId == (uint32_t)this) {
+        classData.initOwnId = 0;
+        classData.initStatus = isCompleted ? CLASS_INITIALIZED : CLASS_UNINITIALIZED;
     }
-    else {
-        int32_t retSp = sp - argc;
-        FlintNativeAttribute &attrNative = methodInfo.getAttributeNative();
-        attrNative.nativeMethod(*this);
-        uint8_t retType = methodInfo.descriptor.text[methodInfo.descriptor.length - 1];
-        if(retType != 'V') {
-            if(retType == 'J' || retType == 'D') {
-                int64_t ret = stackPopInt64();
-                sp = retSp;
-                stackPushInt64(ret);
-            }
-            else if(retType == 'L' || retType == '[') {
-                FlintJavaObject *ret = stackPopObject();
-                sp = retSp;
-                stackPushObject(ret);
-            }
-            else {
-                int32_t ret = stackPopInt32();
-                sp = retSp;
-                stackPushInt32(ret);
+    Flint::unlock();
+}
+
+void FlintExecution::leaveStaticConstructor(bool isCompleted) {
+    /* <clinit> is the only static method whose name starts with '<' */
+    if(method->name.text[0] != '<')
+        return;
+    endClassInit(*(ClassData *)&method->classLoader, isCompleted);
+}
+
+FlintMethodInlineKind FlintExecution::resolveSuperInit(FlintMethodInfo &methodInfo) {
+    FlintConstMethod &constMethod = methodInfo.classLoader.getConstMethod(methodInfo.inlineValue);
+    if(constMethod.methodInfo == 0)
+        constMethod.methodInfo = &flint.findMethod(constMethod);
+    FlintMethodInfo &superInit = *constMethod.methodInfo;
+    FlintMethodInlineKind kind = superInit.inlineKind;
+    if(kind == METHOD_INLINE_SUPER_INIT)
+        kind = resolveSuperInit(superInit);
+    /* A constructor that only calls an empty super constructor is empty too */
+    kind = (kind == METHOD_INLINE_EMPTY) ? METHOD_INLINE_EMPTY : METHOD_INLINE_NONE;
+    *(FlintMethodInlineKind *)&methodInfo.inlineKind = kind;
+    return kind;
+}
+
+bool FlintExecution::invokeInline(FlintMethodInfo &methodInfo, uint8_t argc) {
+    int32_t retSp = sp - argc;
+    switch(methodInfo.inlineKind) {
+        case METHOD_INLINE_SUPER_INIT:
+            if(resolveSuperInit(methodInfo) != METHOD_INLINE_EMPTY)
+                return false;
+            /* An empty super constructor chain is an empty constructor */
+            __attribute__((fallthrough));
+        case METHOD_INLINE_EMPTY:
+            sp = retSp;
+            return true;
+        case METHOD_INLINE_CONST:
+            sp = retSp;
+            if(methodInfo.retType == 'J')
+                stackPushInt64((int16_t)methodInfo.inlineValue);
+            else if(methodInfo.retType == 'L' || methodInfo.retType == '[')
+                stackPushObject(0);
+            else
+                stackPushInt32((int16_t)methodInfo.inlineValue);
+            return true;
+        case METHOD_INLINE_GETTER: {
+            FlintJavaObject *obj = (FlintJavaObject *)stack[retSp + 1];
+            if(obj == 0)
+                return false;
+            FlintConstField &constField = methodInfo.classLoader.getConstField(methodInfo.inlineValue);
+            FlintFieldsData &fields = obj->getFields();
+            switch(constField.nameAndType.descriptor.text[0]) {
+                case 'J':
+                case 'D': {
+                    FlintFieldData64 &fieldData = fields.getFieldData64(constField);
+                    if(constField.fieldIndex == 0)
+                        return false;
+                    sp = retSp;
+                    stackPushInt64(fieldData.value);
+                    return true;
+                }
+                case 'L':
+                case '[': {
+                    FlintFieldObject &fieldData = fields.getFieldObject(constField);
+                    if(constField.fieldIndex == 0)
+                        return false;
+                    sp = retSp;
+                    stackPushObject(fieldData.object);
+                    return true;
+                }
+                default: {
+                    FlintFieldData32 &fieldData = fields.getFieldData32(constField);
+                    if(constField.fieldIndex == 0)
+                        return false;
+                    sp = retSp;
+                    stackPushInt32(fieldData.value);
+                    return true;
+                }
             }
         }
-        else
+        case METHOD_INLINE_SETTER: {
+            FlintJavaObject *obj = (FlintJavaObject *)stack[retSp + 1];
+            if(obj == 0)
+                return false;
+            FlintConstField &constField = methodInfo.classLoader.getConstField(methodInfo.inlineValue);
+            FlintFieldsData &fields = obj->getFields();
+            switch(constField.nameAndType.descriptor.text[0]) {
+                case 'J':
+                case 'D': {
+                    FlintFieldData64 &fieldData = fields.getFieldData64(constField);
+                    if(constField.fieldIndex == 0)
+                        return false;
+                    fieldData.value = stackReadInt64(&stack[retSp + 2]);
+                    break;
+                }
+                case 'L':
+                case '[': {
+                    FlintFieldObject &fieldData = fields.getFieldObject(constField);
+                    if(constField.fieldIndex == 0)
+                        return false;
+                    fieldData.object = (FlintJavaObject *)stack[retSp + 2];
+                    break;
+                }
+                default: {
+                    FlintFieldData32 &fieldData = fields.getFieldData32(constField);
+                    if(constField.fieldIndex == 0)
+                        return false;
+                    int32_t value = stack[retSp + 2];
+                    switch(constField.nameAndType.descriptor.text[0]) {
+                        case 'Z':
+                        case 'B':
+                            fieldData.value = (int8_t)value;
+                            break;
+                        case 'C':
+                        case 'S':
+                            fieldData.value = (int16_t)value;
+                            break;
+                        default:
+                            fieldData.value = value;
+                            break;
+                    }
+                    break;
+                }
+            }
             sp = retSp;
-        pc = lr;
+            return true;
+        }
+        default:
+            return false;
     }
 }
 
-void FlintExecution::invokeStatic(FlintConstMethod &constMethod) {
-    if(constMethod.methodInfo == 0)
-        constMethod.methodInfo = &flint.findMethod(constMethod);
-    FlintMethodInfo &methodInfo = *constMethod.methodInfo;
-    if(methodInfo.accessFlag & METHOD_SYNCHRONIZED) {
-        ClassData &classData = *(ClassData *)&methodInfo.classLoader;
-        Flint::lock();
-        if(classData.monitorCount == 0 || classData.ownId == (int32_t)this) {
-            classData.ownId = (int32_t)this;
-            if(classData.monitorCount < 0x7FFFFFFF) {
-                classData.monitorCount++;
-                Flint::unlock();
+void FlintExecution::callNativeCode(FlintNativeMethodPtr nativeCode, int32_t retSp, uint8_t retSlots) {
+    nativeCode(*this);
+    if(pendingException)
+        return;
+    /* Code that consumes all of its arguments has already pushed the result into the caller's slot */
+    int32_t resultSp = retSp + retSlots;
+    if(sp != resultSp) {
+        for(int32_t i = retSlots; i > 0; i--) {
+            int32_t src = sp - i + 1;
+            int32_t dst = resultSp - i + 1;
+            stack[dst] = stack[src];
+            if(IS_STACK_OBJECT(src))
+                SET_STACK_OBJECT(dst);
+            else
+                CLEAR_STACK_OBJECT(dst);
+        }
+        sp = resultSp;
+    }
+}
+
+/*
+ * The invoke helpers return false with the exception to throw in pendingException, so every invoke
+ * instruction leaves through pending_excp. Called from a catch block, it converts what was thrown.
+ */
+bool FlintExecution::invokeError(const FlintConstUtf8 &methodName) {
+    try {
+        throw;
+    }
+    catch(FlintJavaThrowable *ex) {
+        pendingException = ex;
+    }
+    catch(FlintLoadFileError *file) {
+        const char *msg[] = {"Could not find or load class ", file->getFileName(), ".class"};
+        pendingException = &flint.newClassNotFoundException(&flint.newString(msg, LENGTH(msg)));
+    }
+    catch(FlintFindNativeError *err) {
+        const char *msg[] = {err->getMessage(), " ", methodName.text};
+        pendingException = &flint.newUnsatisfiedLinkErrorException(&flint.newString(msg, LENGTH(msg)));
+    }
+    catch(const char *msg) {
+        pendingException = &flint.newException(&flint.newString(msg, strlen(msg)));
+    }
+    return false;
+}
+
+FlintMethodInfo *FlintExecution::resolveMethod(FlintConstMethod &constMethod) {
+    try {
+        if(constMethod.methodInfo == 0)
+            constMethod.methodInfo = &flint.findMethod(constMethod);
+        return constMethod.methodInfo;
+    }
+    catch(...) {
+        invokeError(constMethod.nameAndType.name);
+        return 0;
+    }
+}
+
+bool FlintExecution::invoke(FlintMethodInfo &methodInfo, uint8_t argc) {
+    try {
+        if(methodInfo.inlineKind != METHOD_INLINE_NONE && invokeInline(methodInfo, argc)) {
+            pc = lr;
+            return true;
+        }
+        if(!(methodInfo.accessFlag & METHOD_NATIVE)) {
+#if FLINT_JIT
+            FlintJit::countHot(methodInfo);
+#endif
+            initNewContext(methodInfo, argc);
+        }
+        else {
+            FlintNativeAttribute &attrNative = methodInfo.getAttributeNative();
+            callNativeCode(attrNative.nativeMethod, sp - attrNative.argc, attrNative.retSlots);
+            if(pendingException == 0)
+                pc = lr;
+        }
+    }
+    catch(...) {
+        return invokeError(methodInfo.name);
+    }
+    return pendingException == 0;
+}
+
+bool FlintExecution::invokeStatic(FlintConstMethod &constMethod) {
+    try {
+        if(resolveMethod(constMethod) == 0)
+            return false;
+        FlintMethodInfo &methodInfo = *constMethod.methodInfo;
+        if(methodInfo.accessFlag & METHOD_SYNCHRONIZED) {
+            ClassData &classData = *(ClassData *)&methodInfo.classLoader;
+            Flint::lock();
+            if(classData.monitorCount == 0 || classData.ownId == (int32_t)this) {
+                classData.ownId = (int32_t)this;
+                if(classData.monitorCount < 0x7FFFFFFF) {
+                    classData.monitorCount++;
+                    Flint::unlock();
+                }
+                else {
+                    Flint::unlock();
+                    throw "monitorCount limit has been reached";
+                }
             }
             else {
                 Flint::unlock();
-                throw "monitorCount limit has been reached";
+                FlintAPI::Thread::yield();
             }
         }
-        else {
-            Flint::unlock();
-            FlintAPI::Thread::yield();
-        }
+        return invoke(methodInfo, methodInfo.argc);
+    }
+    catch(...) {
+        return invokeError(constMethod.nameAndType.name);
     }
-    invoke(methodInfo, constMethod.getParmInfo().argc);
 }
 
-void FlintExecution::invokeSpecial(FlintConstMethod &constMethod) {
-    uint8_t argc = constMethod.getParmInfo().argc + 1;
-    if(constMethod.methodInfo == 0)
-        constMethod.methodInfo = &flint.findMethod(constMethod);
-    FlintMethodInfo &methodInfo = *constMethod.methodInfo;
-    if(methodInfo.accessFlag & METHOD_SYNCHRONIZED) {
-        FlintJavaObject *obj = (FlintJavaObject *)stack[sp - argc - 1];
-        Flint::lock();
-        if(obj->monitorCount == 0 || obj->ownId == (int32_t)this) {
-            obj->ownId = (int32_t)this;
-            if(obj->monitorCount < 0xFFFFFF) {
-                obj->monitorCount++;
-                Flint::unlock();
+bool FlintExecution::invokeSpecial(FlintConstMethod &constMethod) {
+    try {
+        uint8_t argc = constMethod.getParmInfo().argc + 1;
+        if(resolveMethod(constMethod) == 0)
+            return false;
+        FlintMethodInfo &methodInfo = *constMethod.methodInfo;
+        if(methodInfo.accessFlag & METHOD_SYNCHRONIZED) {
+            FlintJavaObject *obj = (FlintJavaObject *)stack[sp - argc - 1];
+            Flint::lock();
+            if(obj->monitorCount == 0 || obj->ownId == (int32_t)this) {
+                obj->ownId = (int32_t)this;
+                if(obj->monitorCount < 0xFFFFFF) {
+                    obj->monitorCount++;
+                    Flint::unlock();
+                }
+                else {
+                    Flint::unlock();
+                    throw "monitorCount limit has been reached";
+                }
             }
             else {
                 Flint::unlock();
-                throw "monitorCount limit has been reached";
+                FlintAPI::Thread::yield();
             }
         }
-        else {
-            Flint::unlock();
-            FlintAPI::Thread::yield();
-        }
+        return invoke(methodInfo, argc);
+    }
+    catch(...) {
+        return invokeError(constMethod.nameAndType.name);
     }
-    invoke(methodInfo, argc);
 }
 
-void FlintExecution::invokeVirtual(FlintConstMethod &constMethod) {
-    uint8_t argc = constMethod.getParmInfo().argc;
-    FlintJavaObject *obj = (FlintJavaObject *)stack[sp - argc];
-    if(obj == 0) {
-        const char *msg[] = {"Cannot invoke ", constMethod.className.text, ".", constMethod.nameAndType.name.text, " by null object"};
-        FlintJavaThrowable &excpObj = flint.newNullPointerException(&flint.newString(msg, LENGTH(msg)));
-        stackPushObject(&excpObj);
-    }
-    FlintConstUtf8 &type = (obj->dimensions > 0 || FlintJavaObject::isPrimType(obj->type)) ? *(FlintConstUtf8 *)&objectClassName : obj->type;
-    FlintMethodInfo *methodInfo;
-    if(constMethod.methodInfo && constMethod.methodInfo->classLoader.getThisClass() == type)
-        methodInfo = constMethod.methodInfo;
-    else {
-        FlintConstMethod virtualConstMethod(type, constMethod.nameAndType, 0, 0);
-        constMethod.methodInfo = &flint.findMethod(virtualConstMethod);
-        methodInfo = constMethod.methodInfo;
-    }
-    if(methodInfo->accessFlag & METHOD_SYNCHRONIZED) {
+FlintMethodInfo *FlintExecution::findVirtualMethod(FlintConstMethod &constMethod, ClassData &classData) {
+    if(constMethod.vtableIndex == VTABLE_INDEX_UNRESOLVED)
+        constMethod.vtableIndex = flint.getVtableIndex(constMethod);
+    if(constMethod.vtableIndex == VTABLE_INDEX_NONE)
+        return 0;
+    if(classData.vtable == 0)
+        flint.buildVtable(classData);
+    if(constMethod.vtableIndex < classData.vtableSize)
+        return classData.vtable[constMethod.vtableIndex];
+    return 0;
+}
+
+FlintMethodInfo *FlintExecution::findInterfaceMethod(FlintConstInterfaceMethod &interfaceMethod, ClassData &classData) {
+    if(interfaceMethod.vtableIndex == VTABLE_INDEX_UNRESOLVED)
+        flint.resolveInterfaceMethod(interfaceMethod);
+    if(interfaceMethod.vtableIndex == VTABLE_INDEX_NONE)
+        return 0;
+    if(classData.itable == 0)
+        flint.buildItable(classData);
+    const FlintClassLoader *interfaceClass = &interfaceMethod.methodInfo->classLoader;
+    for(uint16_t i = 0; i < classData.itableSize; i++) {
+        if(classData.itable[i].interfaceClass == interfaceClass)
+            return classData.itable[i].methods[interfaceMethod.vtableIndex];
+    }
+    return 0;
+}
+
+#if FLINT_INLINE_CACHE_SIZE
+FlintInlineCache &FlintExecution::getInlineCache(FlintConstMethod &constMethod) {
+    if(constMethod.inlineCache == 0) {
+        FlintInlineCache *inlineCache = (FlintInlineCache *)Flint::malloc(sizeof(FlintInlineCache));
+        new (inlineCache)FlintInlineCache();
         Flint::lock();
-        if(obj->monitorCount == 0 || obj->ownId == (int32_t)this) {
-            obj->ownId = (int32_t)this;
-            if(obj->monitorCount < 0xFFFFFF) {
-                obj->monitorCount++;
-                Flint::unlock();
+        if(constMethod.inlineCache == 0) {
+            constMethod.inlineCache = inlineCache;
+            inlineCache = 0;
+        }
+        Flint::unlock();
+        if(inlineCache)
+            Flint::free(inlineCache);
+    }
+    return *constMethod.inlineCache;
+}
+#endif
+
+bool FlintExecution::invokeVirtual(FlintConstMethod &constMethod) {
+    try {
+        uint8_t argc = constMethod.getParmInfo().argc;
+        FlintJavaObject *obj = (FlintJavaObject *)stack[sp - argc];
+        if(obj == 0) {
+            const char *msg[] = {"Cannot invoke ", constMethod.className.text, ".", constMethod.nameAndType.name.text, " by null object"};
+            pendingException = &flint.newNullPointerException(msg, LENGTH(msg));
+            return false;
+        }
+        FlintMethodInfo *methodInfo = 0;
+        if(obj->dimensions == 0) {
+            ClassData &classData = *(ClassData *)&((FlintFieldsData *)obj->data)->classLoader;
+#if FLINT_INLINE_CACHE_SIZE
+            FlintInlineCache &inlineCache = getInlineCache(constMethod);
+            if(inlineCache.isMegamorphic())
+                methodInfo = findVirtualMethod(constMethod, classData);
+            else {
+                methodInfo = inlineCache.find(&classData);
+                if(methodInfo == 0) {
+                    methodInfo = findVirtualMethod(constMethod, classData);
+                    if(methodInfo)
+                        inlineCache.add(&classData, methodInfo);
+                }
+            }
+#else
+            methodInfo = findVirtualMethod(constMethod, classData);
+#endif
+        }
+        if(methodInfo == 0) {
+            /* Methods without a vtable slot (arrays, private or inherited interface methods) */
+            FlintConstUtf8 &type = (obj->dimensions > 0 || FlintJavaObject::isPrimType(obj->type)) ? *(FlintConstUtf8 *)&objectClassName : obj->type;
+            FlintConstMethod virtualConstMethod(type, constMethod.nameAndType, 0, 0);
+            methodInfo = &flint.findMethod(virtualConstMethod);
+        }
+        if(methodInfo->accessFlag & METHOD_SYNCHRONIZED) {
+            Flint::lock();
+            if(obj->monitorCount == 0 || obj->ownId == (int32_t)this) {
+                obj->ownId = (int32_t)this;
+                if(obj->monitorCount < 0xFFFFFF) {
+                    obj->monitorCount++;
+                    Flint::unlock();
+                }
+                else {
+                    Flint::unlock();
+                    throw "monitorCount limit has been reached";
+                }
             }
             else {
                 Flint::unlock();
-                throw "monitorCount limit has been reached";
+                FlintAPI::Thread::yield();
             }
         }
-        else {
-            Flint::unlock();
-            FlintAPI::Thread::yield();
-        }
+        argc++;
+        return invoke(*methodInfo, argc);
+    }
+    catch(...) {
+        return invokeError(constMethod.nameAndType.name);
     }
-    argc++;
-    invoke(*methodInfo, argc);
 }
 
-void FlintExecution::invokeInterface(FlintConstInterfaceMethod &interfaceMethod, uint8_t argc) {
-    FlintJavaObject *obj = (FlintJavaObject *)stack[sp - argc + 1];
-    if(obj == 0) {
-        const char *msg[] = {"Cannot invoke ", interfaceMethod.className.text, ".", interfaceMethod.nameAndType.name.text, " by null object"};
-        FlintJavaThrowable &excpObj = flint.newNullPointerException(&flint.newString(msg, LENGTH(msg)));
-        stackPushObject(&excpObj);
-    }
-    FlintConstUtf8 &type = (obj->dimensions > 0 || FlintJavaObject::isPrimType(obj->type)) ? *(FlintConstUtf8 *)&objectClassName : obj->type;
-    FlintMethodInfo *methodInfo;
-    if(interfaceMethod.methodInfo && interfaceMethod.methodInfo->classLoader.getThisClass() == type)
-        methodInfo = interfaceMethod.methodInfo;
-    else {
-        FlintConstMethod interfaceConstMethod(type, interfaceMethod.nameAndType, 0, 0);
-        interfaceMethod.methodInfo = &flint.findMethod(interfaceConstMethod);
-        methodInfo = interfaceMethod.methodInfo;
-    }
-    if(methodInfo->accessFlag & METHOD_SYNCHRONIZED) {
-        Flint::lock();
-        if(obj->monitorCount == 0 || obj->ownId == (int32_t)this) {
-            obj->ownId = (int32_t)this;
-            if(obj->monitorCount < 0xFFFFFF) {
-                obj->monitorCount++;
-                Flint::unlock();
+bool FlintExecution::invokeInterface(FlintConstInterfaceMethod &interfaceMethod, uint8_t argc) {
+    try {
+        FlintJavaObject *obj = (FlintJavaObject *)stack[sp - argc + 1];
+        if(obj == 0) {
+            const char *msg[] = {"Cannot invoke ", interfaceMethod.className.text, ".", interfaceMethod.nameAndType.name.text, " by null object"};
+            pendingException = &flint.newNullPointerException(msg, LENGTH(msg));
+            return false;
+        }
+        FlintMethodInfo *methodInfo = 0;
+        if(obj->dimensions == 0) {
+            ClassData &classData = *(ClassData *)&((FlintFieldsData *)obj->data)->classLoader;
+#if FLINT_INLINE_CACHE_SIZE
+            FlintInlineCache &inlineCache = getInlineCache(interfaceMethod);
+            if(inlineCache.isMegamorphic())
+                methodInfo = findInterfaceMethod(interfaceMethod, classData);
+            else {
+                methodInfo = inlineCache.find(&classData);
+                if(methodInfo == 0) {
+                    methodInfo = findInterfaceMethod(interfaceMethod, classData);
+                    if(methodInfo)
+                        inlineCache.add(&classData, methodInfo);
+                }
+            }
+#else
+            methodInfo = findInterfaceMethod(interfaceMethod, classData);
+#endif
+        }
+        if(methodInfo == 0) {
+            FlintConstUtf8 &type = (obj->dimensions > 0 || FlintJavaObject::isPrimType(obj->type)) ? *(FlintConstUtf8 *)&objectClassName : obj->type;
+            FlintConstMethod interfaceConstMethod(type, interfaceMethod.nameAndType, 0, 0);
+            methodInfo = &flint.findMethod(interfaceConstMethod);
+        }
+        if(methodInfo->accessFlag & METHOD_SYNCHRONIZED) {
+            Flint::lock();
+            if(obj->monitorCount == 0 || obj->ownId == (int32_t)this) {
+                obj->ownId = (int32_t)this;
+                if(obj->monitorCount < 0xFFFFFF) {
+                    obj->monitorCount++;
+                    Flint::unlock();
+                }
+                else {
+                    Flint::unlock();
+                    throw "monitorCount limit has been reached";
+                }
             }
             else {
                 Flint::unlock();
-                throw "monitorCount limit has been reached";
+                FlintAPI::Thread::yield();
             }
         }
-        else {
-            Flint::unlock();
-            FlintAPI::Thread::yield();
-        }
+        return invoke(*methodInfo, argc);
+    }
+    catch(...) {
+        return invokeError(interfaceMethod.nameAndType.name);
     }
-    invoke(*methodInfo, argc);
 }
 
 void FlintExecution::run(void) {
@@ -431,12 +1086,16 @@ void FlintExecution::run(void) {
         &&op_dreturn, &&op_areturn, &&op_return, &&op_getstatic, &&op_putstatic, &&op_getfield, &&op_putfield, &&op_invokevirtual,
         &&op_invokespecial, &&op_invokestatic, &&op_invokeinterface, &&op_invokedynamic, &&op_new, &&op_newarray, &&op_anewarray,
         &&op_arraylength, &&op_athrow, &&op_checkcast, &&op_instanceof, &&op_monitorenter, &&op_monitorexit, &&op_wide, &&op_multianewarray,
-        &&op_ifnull, &&op_ifnonnull, &&op_goto_w, &&op_jsrw, &&op_breakpoint, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow,
-        &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow,
+        &&op_ifnull, &&op_ifnonnull, &&op_goto_w, &&op_jsrw, &&op_breakpoint, &&op_ldc_quick, &&op_ldc_w_quick, &&op_aldc_quick,
+        &&op_aldc_w_quick, &&op_ldc2_w_quick, &&op_igetstatic_quick, &&op_lgetstatic_quick, &&op_agetstatic_quick, &&op_bputstatic_quick,
+        &&op_sputstatic_quick, &&op_iputstatic_quick, &&op_lputstatic_quick, &&op_aputstatic_quick, &&op_igetfield_quick,
+        &&op_lgetfield_quick, &&op_agetfield_quick, &&op_bputfield_quick, &&op_sputfield_quick, &&op_iputfield_quick, &&op_lputfield_quick,
+        &&op_aputfield_quick, &&op_invokevirtual_quick, &&op_invokespecial_quick, &&op_invokestatic_quick, &&op_unknow,
+        &&op_aload_0_getfield, &&op_iload_iload_iadd_istore, &&op_iload_iload_iadd_istore_w, &&op_iinc_goto,
+        &&op_aload_arraylength_if_icmpge, &&op_aload_n_arraylength_if_icmpge, &&op_invokevirtual_direct, &&op_ireg_arith,
+        &&op_ireg_arith_imm, &&op_ireg_if_icmp, &&op_string_switch, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow,
         &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow,
-        &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow,
-        &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow,
-        &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_exit,
+        &&op_exit,
     };
 
     static const void *opcodeLabelsDebug[256] = {
@@ -460,14 +1119,51 @@ void FlintExecution::run(void) {
         &&check_bkp, &&check_bkp, &&check_bkp, &&check_bkp, &&check_bkp, &&check_bkp, &&check_bkp, &&check_bkp, &&check_bkp, &&check_bkp,
         &&check_bkp, &&check_bkp, &&check_bkp, &&check_bkp, &&check_bkp, &&check_bkp, &&check_bkp, &&check_bkp, &&check_bkp, &&check_bkp,
         &&check_bkp, &&check_bkp, &&check_bkp, &&check_bkp, &&check_bkp, &&check_bkp, &&check_bkp, &&check_bkp, &&check_bkp, &&check_bkp,
-        &&check_bkp, &&check_bkp, &&check_bkp, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow,
-        &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow,
-        &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow,
-        &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow,
+        &&check_bkp, &&check_bkp, &&check_bkp, &&check_bkp, &&check_bkp, &&check_bkp, &&check_bkp, &&check_bkp, &&check_bkp, &&check_bkp,
+        &&check_bkp, &&check_bkp, &&check_bkp, &&check_bkp, &&check_bkp, &&check_bkp, &&check_bkp, &&check_bkp, &&check_bkp, &&check_bkp,
+        &&check_bkp, &&check_bkp, &&check_bkp, &&check_bkp, &&check_bkp, &&check_bkp, &&check_bkp, &&op_unknow, &&check_bkp, &&check_bkp,
+        &&check_bkp, &&check_bkp, &&check_bkp, &&check_bkp, &&check_bkp, &&check_bkp, &&check_bkp, &&check_bkp, &&check_bkp, &&op_unknow,
         &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow,
         &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_exit,
     };
 
+#if FLINT_OPCODE_PROFILE
+    static const void *opcodeLabelsProfile[256] = {
+        &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode,
+        &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode,
+        &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode,
+        &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode,
+        &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode,
+        &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode,
+        &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode,
+        &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode,
+        &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode,
+        &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode,
+        &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode,
+        &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&op_unknow,
+        &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode,
+        &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode,
+        &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode,
+        &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode,
+        &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode,
+        &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode,
+        &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode,
+        &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode,
+        &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode,
+        &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode,
+        &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode,
+        &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode,
+        &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode,
+        &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode,
+        &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode,
+        &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode,
+        &&profile_opcode, &&profile_opcode, &&profile_opcode, &&op_unknow, &&profile_opcode, &&profile_opcode, &&profile_opcode, &&profile_opcode,
+        &&profile_opcode, &&profile_opcode, &&profile_opcode, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow,
+        &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow,
+        &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_unknow, &&op_exit,
+    };
+#endif
+
     static const void *opcodeLabelsExit[256] = {
         &&op_exit, &&op_exit, &&op_exit, &&op_exit, &&op_exit, &&op_exit, &&op_exit, &&op_exit, &&op_exit, &&op_exit,
         &&op_exit, &&op_exit, &&op_exit, &&op_exit, &&op_exit, &&op_exit, &&op_exit, &&op_exit, &&op_exit, &&op_exit,
@@ -497,17 +1193,54 @@ void FlintExecution::run(void) {
         &&op_exit, &&op_exit, &&op_exit, &&op_exit, &&op_exit, &&op_exit,
     };
 
+#if FLINT_REGISTER_IR
+    static const void *regLabels[REG_OPCODE_COUNT] = {
+        &&reg_move, &&reg_const, &&reg_aldc,
+        &&reg_iadd, &&reg_isub, &&reg_imul, &&reg_idiv, &&reg_irem, &&reg_iand, &&reg_ior, &&reg_ixor,
+        &&reg_ishl, &&reg_ishr, &&reg_iushr, &&reg_fadd, &&reg_fsub, &&reg_fmul, &&reg_fdiv, &&reg_fcmpl,
+        &&reg_fcmpg, &&reg_iadd_imm, &&reg_ineg, &&reg_fneg, &&reg_i2f, &&reg_f2i, &&reg_i2b, &&reg_i2c,
+        &&reg_i2s, &&reg_ifeq, &&reg_ifne, &&reg_iflt, &&reg_ifge, &&reg_ifgt, &&reg_ifle, &&reg_if_icmpeq,
+        &&reg_if_icmpne, &&reg_if_icmplt, &&reg_if_icmpge, &&reg_if_icmpgt, &&reg_if_icmple, &&reg_goto,
+        &&reg_tableswitch, &&reg_lookupswitch, &&reg_iaload, &&reg_aaload, &&reg_baload, &&reg_caload,
+        &&reg_saload, &&reg_iastore, &&reg_aastore, &&reg_bastore, &&reg_castore, &&reg_arraylength,
+        &&reg_igetfield, &&reg_agetfield, &&reg_iputfield, &&reg_bputfield, &&reg_sputfield, &&reg_aputfield,
+        &&reg_getstatic, &&reg_igetstatic_quick, &&reg_agetstatic_quick, &&reg_putstatic, &&reg_iputstatic_quick,
+        &&reg_bputstatic_quick, &&reg_sputstatic_quick, &&reg_aputstatic_quick, &&reg_new, &&reg_newarray,
+        &&reg_anewarray, &&reg_checkcast, &&reg_instanceof, &&reg_invokevirtual, &&reg_invokespecial,
+        &&reg_invokestatic, &&reg_invokeinterface, &&reg_ireturn, &&reg_areturn, &&reg_return, &&reg_athrow,
+    };
+#endif
+
     ::opcodeLabelsExit = opcodeLabelsExit;
     FlintDebugger *dbg = flint.getDebugger();
+#if FLINT_OPCODE_PROFILE
+    uint32_t profileHistory = 0xFFFFFFFF;
+    opcodes = dbg ? opcodeLabelsDebug : opcodeLabelsProfile;
+#else
     opcodes = dbg ? opcodeLabelsDebug : opcodeLabels;
+#endif
 
     FlintLoadFileError *fileNotFound = 0;
+#if FLINT_REGISTER_IR
+    const uint8_t *regCode = 0;
+    int32_t arrayIndex = 0;
+    int32_t arrayLength = 0;
+#endif
 
     stackInitExitPoint(method->getAttributeCode().codeLength);
 
-    if((int32_t)&method->classLoader.getStaticConstructor() != 0) {
+    int32_t * const stack = this->stack;
+#if !FLINT_GC_CONSERVATIVE_STACK
+    uint8_t * const stackType = this->stackType;
+#endif
+    const uint8_t *code = this->code;
+    int32_t *locals = this->locals;
+    uint32_t pc = this->pc;
+    int32_t sp = this->sp;
+
+    if(((ClassData *)&method->classLoader)->initStatus != CLASS_INITIALIZED) {
         try {
-            stackPushInt32((int32_t)(ClassData *)&method->classLoader);
+            STACK_PUSH_INT32((int32_t)(ClassData *)&method->classLoader);
         }
         catch(FlintLoadFileError *file) {
             fileNotFound = file;
@@ -516,233 +1249,256 @@ void FlintExecution::run(void) {
         goto init_static_field;
     }
 
-    goto *opcodes[code[pc]];
+    RESUME_FRAME();
     check_bkp: {
+        SAVE_REGISTERS();
         dbg->checkBreakPoint(this);
         goto *opcodeLabels[code[pc]];
     }
+#if FLINT_OPCODE_PROFILE
+    profile_opcode:
+        profileHistory = (profileHistory << 8) | code[pc];
+        FlintOpcodeProfiler::record(profileHistory);
+        goto *opcodeLabels[code[pc]];
+#endif
     op_nop:
         pc++;
         goto *opcodes[code[pc]];
     op_iconst_m1:
-        stackPushInt32(-1);
+        STACK_PUSH_INT32(-1);
         pc++;
         goto *opcodes[code[pc]];
     op_iconst_0:
     op_aconst_null:
-        stackPushInt32(0);
+        STACK_PUSH_INT32(0);
         pc++;
         goto *opcodes[code[pc]];
     op_iconst_1:
-        stackPushInt32(1);
+        STACK_PUSH_INT32(1);
         pc++;
         goto *opcodes[code[pc]];
     op_iconst_2:
-        stackPushInt32(2);
+        STACK_PUSH_INT32(2);
         pc++;
         goto *opcodes[code[pc]];
     op_iconst_3:
-        stackPushInt32(3);
+        STACK_PUSH_INT32(3);
         pc++;
         goto *opcodes[code[pc]];
     op_iconst_4:
-        stackPushInt32(4);
+        STACK_PUSH_INT32(4);
         pc++;
         goto *opcodes[code[pc]];
     op_iconst_5:
-        stackPushInt32(5);
+        STACK_PUSH_INT32(5);
         pc++;
         goto *opcodes[code[pc]];
     op_lconst_0:
-        stackPushInt64(0);
+        STACK_PUSH_INT64(0);
         pc++;
         goto *opcodes[code[pc]];
     op_lconst_1:
-        stackPushInt64(1);
+        STACK_PUSH_INT64(1);
         pc++;
         goto *opcodes[code[pc]];
     op_fconst_0:
-        stackPushFloat(0);
+        STACK_PUSH_FLOAT(0);
         pc++;
         goto *opcodes[code[pc]];
     op_fconst_1:
-        stackPushFloat(1);
+        STACK_PUSH_FLOAT(1);
         pc++;
         goto *opcodes[code[pc]];
     op_fconst_2:
-        stackPushFloat(2);
+        STACK_PUSH_FLOAT(2);
         pc++;
         goto *opcodes[code[pc]];
     op_dconst_0:
-        stackPushDouble(0);
+        STACK_PUSH_DOUBLE(0);
         pc++;
         goto *opcodes[code[pc]];
     op_dconst_1:
-        stackPushDouble(1);
+        STACK_PUSH_DOUBLE(1);
         pc++;
         goto *opcodes[code[pc]];
     op_bipush:
-        stackPushInt32((int8_t)code[pc + 1]);
+        STACK_PUSH_INT32((int8_t)code[pc + 1]);
         pc += 2;
         goto *opcodes[code[pc]];
     op_sipush:
-        stackPushInt32(ARRAY_TO_INT16(&code[pc + 1]));
+        STACK_PUSH_INT32(CODE_TO_INT16(&code[pc + 1]));
         pc += 3;
         goto *opcodes[code[pc]];
     op_ldc: {
         FlintConstPool &constPool = method->classLoader.getConstPool(code[pc + 1]);
-        pc += 2;
         switch(constPool.tag & 0x7F) {
             case CONST_INTEGER:
-                stackPushInt32(method->classLoader.getConstInteger(constPool));
-                goto *opcodes[code[pc]];
             case CONST_FLOAT:
-                stackPushFloat(method->classLoader.getConstFloat(constPool));
-                goto *opcodes[code[pc]];
+                quickenOpCode(&code[pc], OP_LDC_QUICK);
+                goto op_ldc_quick;
             case CONST_STRING:
-                stackPushObject(&method->classLoader.getConstString(flint, constPool));
-                goto *opcodes[code[pc]];
+                method->classLoader.getConstString(flint, constPool);
+                quickenOpCode(&code[pc], OP_ALDC_QUICK);
+                goto op_aldc_quick;
             case CONST_CLASS:
-                stackPushObject(&method->classLoader.getConstClass(flint, constPool));
+                STACK_PUSH_OBJECT(&method->classLoader.getConstClass(flint, constPool));
+                pc += 2;
                 goto *opcodes[code[pc]];
             case CONST_METHOD_TYPE:
                 // TODO
+                pc += 2;
                 goto *opcodes[code[pc]];
             case CONST_METHOD_HANDLE:
                 // TODO
+                pc += 2;
                 goto *opcodes[code[pc]];
             default:
                 throw "unkown the const pool tag";
         }
     }
     op_ldc_w: {
-        uint16_t index = ARRAY_TO_INT16(&code[pc + 1]);
+        uint16_t index = CODE_TO_INT16(&code[pc + 1]);
         FlintConstPool &constPool = method->classLoader.getConstPool(index);
-        pc += 3;
         switch(constPool.tag & 0x7F) {
             case CONST_INTEGER:
-                stackPushInt32(method->classLoader.getConstInteger(constPool));
-                goto *opcodes[code[pc]];
             case CONST_FLOAT:
-                stackPushFloat(method->classLoader.getConstFloat(constPool));
-                goto *opcodes[code[pc]];
+                quickenOpCode(&code[pc], OP_LDC_W_QUICK);
+                goto op_ldc_w_quick;
             case CONST_STRING:
-                stackPushObject(&method->classLoader.getConstString(flint, constPool));
-                goto *opcodes[code[pc]];
+                method->classLoader.getConstString(flint, constPool);
+                quickenOpCode(&code[pc], OP_ALDC_W_QUICK);
+                goto op_aldc_w_quick;
             case CONST_CLASS:
-                stackPushObject(&method->classLoader.getConstClass(flint, constPool));
+                STACK_PUSH_OBJECT(&method->classLoader.getConstClass(flint, constPool));
+                pc += 3;
                 goto *opcodes[code[pc]];
             case CONST_METHOD_TYPE:
                 // TODO
+                pc += 3;
                 goto *opcodes[code[pc]];
             case CONST_METHOD_HANDLE:
                 // TODO
+                pc += 3;
                 goto *opcodes[code[pc]];
             default:
                 throw "unkown the const pool tag";
         }
     }
     op_ldc2_w: {
-        uint16_t index = ARRAY_TO_INT16(&code[pc + 1]);
+        uint16_t index = CODE_TO_INT16(&code[pc + 1]);
         FlintConstPool &constPool = method->classLoader.getConstPool(index);
-        pc += 3;
         switch(constPool.tag) {
             case CONST_LONG:
-                stackPushInt64(method->classLoader.getConstLong(constPool));
-                goto *opcodes[code[pc]];
             case CONST_DOUBLE:
-                stackPushDouble(method->classLoader.getConstDouble(constPool));
-                goto *opcodes[code[pc]];
+                quickenOpCode(&code[pc], OP_LDC2_W_QUICK);
+                goto op_ldc2_w_quick;
             default:
                 throw "unkown the const pool tag";
         }
     }
+    op_ldc_quick:
+        STACK_PUSH_INT32(method->classLoader.getConstPool(code[pc + 1]).value);
+        pc += 2;
+        goto *opcodes[code[pc]];
+    op_ldc_w_quick:
+        STACK_PUSH_INT32(method->classLoader.getConstPool(CODE_TO_INT16(&code[pc + 1])).value);
+        pc += 3;
+        goto *opcodes[code[pc]];
+    op_aldc_quick:
+        STACK_PUSH_OBJECT((FlintJavaObject *)method->classLoader.getConstPool(code[pc + 1]).value);
+        pc += 2;
+        goto *opcodes[code[pc]];
+    op_aldc_w_quick:
+        STACK_PUSH_OBJECT((FlintJavaObject *)method->classLoader.getConstPool(CODE_TO_INT16(&code[pc + 1])).value);
+        pc += 3;
+        goto *opcodes[code[pc]];
+    op_ldc2_w_quick: {
+        FlintConstPool *constPool = &method->classLoader.getConstPool(CODE_TO_INT16(&code[pc + 1]));
+        STACK_PUSH_INT32(constPool[0].value);
+        STACK_PUSH_INT32(constPool[1].value);
+        pc += 3;
+        goto *opcodes[code[pc]];
+    }
     op_iload:
     op_fload:
-        stackPushInt32(locals[code[pc + 1]]);
+        STACK_PUSH_INT32(locals[code[pc + 1]]);
         pc += 2;
         goto *opcodes[code[pc]];
     op_iload_0:
     op_fload_0:
-        stackPushInt32(locals[0]);
+        STACK_PUSH_INT32(locals[0]);
         pc++;
         goto *opcodes[code[pc]];
     op_iload_1:
     op_fload_1:
-        stackPushInt32(locals[1]);
+        STACK_PUSH_INT32(locals[1]);
         pc++;
         goto *opcodes[code[pc]];
     op_iload_2:
     op_fload_2:
-        stackPushInt32(locals[2]);
+        STACK_PUSH_INT32(locals[2]);
         pc++;
         goto *opcodes[code[pc]];
     op_iload_3:
     op_fload_3:
-        stackPushInt32(locals[3]);
+        STACK_PUSH_INT32(locals[3]);
         pc++;
         goto *opcodes[code[pc]];
     op_lload:
     op_dload:
-        stackPushInt64(*(int64_t *)&locals[code[pc + 1]]);
+        STACK_PUSH_INT64(*(int64_t *)&locals[code[pc + 1]]);
         pc += 2;
         goto *opcodes[code[pc]];
     op_lload_0:
     op_dload_0:
-        stackPushInt64(*(int64_t *)&locals[0]);
+        STACK_PUSH_INT64(*(int64_t *)&locals[0]);
         pc++;
         goto *opcodes[code[pc]];
     op_lload_1:
     op_dload_1:
-        stackPushInt64(*(int64_t *)&locals[1]);
+        STACK_PUSH_INT64(*(int64_t *)&locals[1]);
         pc++;
         goto *opcodes[code[pc]];
     op_lload_2:
     op_dload_2:
-        stackPushInt64(*(int64_t *)&locals[2]);
+        STACK_PUSH_INT64(*(int64_t *)&locals[2]);
         pc++;
         goto *opcodes[code[pc]];
     op_lload_3:
     op_dload_3:
-        stackPushInt64(*(int64_t *)&locals[3]);
+        STACK_PUSH_INT64(*(int64_t *)&locals[3]);
         pc++;
         goto *opcodes[code[pc]];
     op_aload:
-        stackPushObject((FlintJavaObject *)locals[code[pc + 1]]);
+        STACK_PUSH_OBJECT((FlintJavaObject *)locals[code[pc + 1]]);
         pc += 2;
         goto *opcodes[code[pc]];
     op_aload_0:
-        stackPushObject((FlintJavaObject *)locals[0]);
+        STACK_PUSH_OBJECT((FlintJavaObject *)locals[0]);
         pc++;
         goto *opcodes[code[pc]];
     op_aload_1:
-        stackPushObject((FlintJavaObject *)locals[1]);
+        STACK_PUSH_OBJECT((FlintJavaObject *)locals[1]);
         pc++;
         goto *opcodes[code[pc]];
     op_aload_2:
-        stackPushObject((FlintJavaObject *)locals[2]);
+        STACK_PUSH_OBJECT((FlintJavaObject *)locals[2]);
         pc++;
         goto *opcodes[code[pc]];
     op_aload_3:
-        stackPushObject((FlintJavaObject *)locals[3]);
+        STACK_PUSH_OBJECT((FlintJavaObject *)locals[3]);
         pc++;
         goto *opcodes[code[pc]];
     op_iaload:
     op_faload: {
-        int32_t index = stackPopInt32();
-        FlintJavaObject *obj = stackPopObject();
+        int32_t index = STACK_POP_INT32();
+        FlintJavaObject *obj = STACK_POP_OBJECT();
         if(obj == 0)
             goto load_null_array_excp;
         else if(index < 0 || index >= (obj->size / sizeof(int32_t))) {
-            char indexStrBuff[11];
-            char lengthStrBuff[11];
-            sprintf(indexStrBuff, "%d", (int)index);
-            sprintf(lengthStrBuff, "%d", obj->size / sizeof(int32_t));
-            const char *msg[] = {"Index ", indexStrBuff, " out of bounds for length ", lengthStrBuff};
-            FlintJavaString &strObj = flint.newString(msg, LENGTH(msg));
             try {
-                FlintJavaThrowable &excpObj = flint.newArrayIndexOutOfBoundsException(&strObj);
-                stackPushObject(&excpObj);
+                FlintJavaThrowable &excpObj = flint.newArrayIndexOutOfBoundsException(index, obj->size / sizeof(int32_t));
+                STACK_PUSH_OBJECT(&excpObj);
             }
             catch(FlintLoadFileError *file) {
                 fileNotFound = file;
@@ -750,26 +1506,20 @@ void FlintExecution::run(void) {
             }
             goto exception_handler;
         }
-        stackPushInt32(((int32_t *)obj->data)[index]);
+        STACK_PUSH_INT32(((int32_t *)obj->data)[index]);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_laload:
     op_daload: {
-        int32_t index = stackPopInt32();
-        FlintJavaObject *obj = stackPopObject();
+        int32_t index = STACK_POP_INT32();
+        FlintJavaObject *obj = STACK_POP_OBJECT();
         if(obj == 0)
             goto load_null_array_excp;
         else if(index < 0 || index >= (obj->size / sizeof(int64_t))) {
-            char indexStrBuff[11];
-            char lengthStrBuff[11];
-            sprintf(indexStrBuff, "%d", (int)index);
-            sprintf(lengthStrBuff, "%d", obj->size / sizeof(int64_t));
-            const char *msg[] = {"Index ", indexStrBuff, " out of bounds for length ", lengthStrBuff};
-            FlintJavaString &strObj = flint.newString(msg, LENGTH(msg));
             try {
-                FlintJavaThrowable &excpObj = flint.newArrayIndexOutOfBoundsException(&strObj);
-                stackPushObject(&excpObj);
+                FlintJavaThrowable &excpObj = flint.newArrayIndexOutOfBoundsException(index, obj->size / sizeof(int64_t));
+                STACK_PUSH_OBJECT(&excpObj);
             }
             catch(FlintLoadFileError *file) {
                 fileNotFound = file;
@@ -777,25 +1527,19 @@ void FlintExecution::run(void) {
             }
             goto exception_handler;
         }
-        stackPushInt64(((int64_t *)obj->data)[index]);
+        STACK_PUSH_INT64(((int64_t *)obj->data)[index]);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_aaload: {
-        int32_t index = stackPopInt32();
-        FlintJavaObject *obj = stackPopObject();
+        int32_t index = STACK_POP_INT32();
+        FlintJavaObject *obj = STACK_POP_OBJECT();
         if(obj == 0)
             goto load_null_array_excp;
         else if(index < 0 || index >= (obj->size / sizeof(int32_t))) {
-            char indexStrBuff[11];
-            char lengthStrBuff[11];
-            sprintf(indexStrBuff, "%d", (int)index);
-            sprintf(lengthStrBuff, "%d", obj->size / sizeof(int32_t));
-            const char *msg[] = {"Index ", indexStrBuff, " out of bounds for length ", lengthStrBuff};
-            FlintJavaString &strObj = flint.newString(msg, LENGTH(msg));
             try {
-                FlintJavaThrowable &excpObj = flint.newArrayIndexOutOfBoundsException(&strObj);
-                stackPushObject(&excpObj);
+                FlintJavaThrowable &excpObj = flint.newArrayIndexOutOfBoundsException(index, obj->size / sizeof(int32_t));
+                STACK_PUSH_OBJECT(&excpObj);
             }
             catch(FlintLoadFileError *file) {
                 fileNotFound = file;
@@ -803,25 +1547,19 @@ void FlintExecution::run(void) {
             }
             goto exception_handler;
         }
-        stackPushObject(((FlintJavaObject **)obj->data)[index]);
+        STACK_PUSH_OBJECT(((FlintJavaObject **)obj->data)[index]);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_baload: {
-        int32_t index = stackPopInt32();
-        FlintJavaObject *obj = stackPopObject();
+        int32_t index = STACK_POP_INT32();
+        FlintJavaObject *obj = STACK_POP_OBJECT();
         if(obj == 0)
             goto load_null_array_excp;
         else if(index < 0 || index >= (obj->size / sizeof(int8_t))) {
-            char indexStrBuff[11];
-            char lengthStrBuff[11];
-            sprintf(indexStrBuff, "%d", (int)index);
-            sprintf(lengthStrBuff, "%d", obj->size / sizeof(int8_t));
-            const char *msg[] = {"Index ", indexStrBuff, " out of bounds for length ", lengthStrBuff};
-            FlintJavaString &strObj = flint.newString(msg, LENGTH(msg));
             try {
-                FlintJavaThrowable &excpObj = flint.newArrayIndexOutOfBoundsException(&strObj);
-                stackPushObject(&excpObj);
+                FlintJavaThrowable &excpObj = flint.newArrayIndexOutOfBoundsException(index, obj->size / sizeof(int8_t));
+                STACK_PUSH_OBJECT(&excpObj);
             }
             catch(FlintLoadFileError *file) {
                 fileNotFound = file;
@@ -829,26 +1567,20 @@ void FlintExecution::run(void) {
             }
             goto exception_handler;
         }
-        stackPushInt32(((int8_t *)obj->data)[index]);
+        STACK_PUSH_INT32(((int8_t *)obj->data)[index]);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_caload:
     op_saload: {
-        int32_t index = stackPopInt32();
-        FlintJavaObject *obj = stackPopObject();
+        int32_t index = STACK_POP_INT32();
+        FlintJavaObject *obj = STACK_POP_OBJECT();
         if(obj == 0)
             goto load_null_array_excp;
         else if(index < 0 || index >= (obj->size / sizeof(int16_t))) {
-            char indexStrBuff[11];
-            char lengthStrBuff[11];
-            sprintf(indexStrBuff, "%d", (int)index);
-            sprintf(lengthStrBuff, "%d", obj->size / sizeof(int16_t));
-            const char *msg[] = {"Index ", indexStrBuff, " out of bounds for length ", lengthStrBuff};
-            FlintJavaString &strObj = flint.newString(msg, LENGTH(msg));
             try {
-                FlintJavaThrowable &excpObj = flint.newArrayIndexOutOfBoundsException(&strObj);
-                stackPushObject(&excpObj);
+                FlintJavaThrowable &excpObj = flint.newArrayIndexOutOfBoundsException(index, obj->size / sizeof(int16_t));
+                STACK_PUSH_OBJECT(&excpObj);
             }
             catch(FlintLoadFileError *file) {
                 fileNotFound = file;
@@ -856,156 +1588,150 @@ void FlintExecution::run(void) {
             }
             goto exception_handler;
         }
-        stackPushInt32(((int16_t *)obj->data)[index]);
+        STACK_PUSH_INT32(((int16_t *)obj->data)[index]);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_istore:
     op_fstore: {
         uint32_t index = code[pc + 1];
-        locals[index] = stackPopInt32();
+        locals[index] = STACK_POP_INT32();
         index = &locals[index] - stack;
-        stackType[index / 8] &= ~(1 << (index % 8));
+        CLEAR_STACK_OBJECT(index);
         pc += 2;
         goto *opcodes[code[pc]];
     }
     op_lstore:
     op_dstore: {
         uint32_t index = code[pc + 1];
-        *(uint64_t *)&locals[index] = stackPopInt64();
+        *(uint64_t *)&locals[index] = STACK_POP_INT64();
         index = &locals[index] - stack;
-        stackType[index / 8] &= ~(1 << (index % 8));
+        CLEAR_STACK_OBJECT(index);
         index++;
-        stackType[index / 8] &= ~(1 << (index % 8));
+        CLEAR_STACK_OBJECT(index);
         pc += 2;
         goto *opcodes[code[pc]];
     }
     op_astore: {
         uint32_t index = code[pc + 1];
-        locals[index] = stackPopInt32();
+        locals[index] = STACK_POP_INT32();
         index = &locals[index] - stack;
-        stackType[index / 8] |= (1 << (index % 8));
+        SET_STACK_OBJECT(index);
         pc += 2;
         goto *opcodes[code[pc]];
     }
     op_istore_0:
     op_fstore_0: {
-        locals[0] = stackPopInt32();
+        locals[0] = STACK_POP_INT32();
         uint32_t index = &locals[0] - stack;
-        stackType[index / 8] &= ~(1 << (index % 8));
+        CLEAR_STACK_OBJECT(index);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_istore_1:
     op_fstore_1: {
-        locals[1] = stackPopInt32();
+        locals[1] = STACK_POP_INT32();
         uint32_t index = &locals[1] - stack;
-        stackType[index / 8] &= ~(1 << (index % 8));
+        CLEAR_STACK_OBJECT(index);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_istore_2:
     op_fstore_2: {
-        locals[2] = stackPopInt32();
+        locals[2] = STACK_POP_INT32();
         uint32_t index = &locals[2] - stack;
-        stackType[index / 8] &= ~(1 << (index % 8));
+        CLEAR_STACK_OBJECT(index);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_istore_3:
     op_fstore_3: {
-        locals[3] = stackPopInt32();
+        locals[3] = STACK_POP_INT32();
         uint32_t index = &locals[3] - stack;
-        stackType[index / 8] &= ~(1 << (index % 8));
+        CLEAR_STACK_OBJECT(index);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_lstore_0:
     op_dstore_0: {
-        *(uint64_t *)&locals[0] = stackPopInt64();
+        *(uint64_t *)&locals[0] = STACK_POP_INT64();
         uint32_t index = &locals[3] - stack;
-        stackType[index / 8] &= ~(1 << (index % 8));
+        CLEAR_STACK_OBJECT(index);
         index++;
-        stackType[index / 8] &= ~(1 << (index % 8));
+        CLEAR_STACK_OBJECT(index);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_lstore_1:
     op_dstore_1: {
-        *(uint64_t *)&locals[1] = stackPopInt64();
+        *(uint64_t *)&locals[1] = STACK_POP_INT64();
         uint32_t index = &locals[1] - stack;
-        stackType[index / 8] &= ~(1 << (index % 8));
+        CLEAR_STACK_OBJECT(index);
         index++;
-        stackType[index / 8] &= ~(1 << (index % 8));
+        CLEAR_STACK_OBJECT(index);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_lstore_2:
     op_dstore_2: {
-        *(uint64_t *)&locals[2] = stackPopInt64();
+        *(uint64_t *)&locals[2] = STACK_POP_INT64();
         uint32_t index = &locals[2] - stack;
-        stackType[index / 8] &= ~(1 << (index % 8));
+        CLEAR_STACK_OBJECT(index);
         index++;
-        stackType[index / 8] &= ~(1 << (index % 8));
+        CLEAR_STACK_OBJECT(index);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_lstore_3:
     op_dstore_3: {
-        *(uint64_t *)&locals[3] = stackPopInt64();
+        *(uint64_t *)&locals[3] = STACK_POP_INT64();
         uint32_t index = &locals[3] - stack;
-        stackType[index / 8] &= ~(1 << (index % 8));
+        CLEAR_STACK_OBJECT(index);
         index++;
-        stackType[index / 8] &= ~(1 << (index % 8));
+        CLEAR_STACK_OBJECT(index);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_astore_0: {
-        locals[0] = stackPopInt32();
+        locals[0] = STACK_POP_INT32();
         uint32_t index = &locals[0] - stack;
-        stackType[index / 8] |= (1 << (index % 8));
+        SET_STACK_OBJECT(index);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_astore_1: {
-        locals[1] = stackPopInt32();
+        locals[1] = STACK_POP_INT32();
         uint32_t index = &locals[1] - stack;
-        stackType[index / 8] |= (1 << (index % 8));
+        SET_STACK_OBJECT(index);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_astore_2: {
-        locals[2] = stackPopInt32();
+        locals[2] = STACK_POP_INT32();
         uint32_t index = &locals[2] - stack;
-        stackType[index / 8] |= (1 << (index % 8));
+        SET_STACK_OBJECT(index);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_astore_3: {
-        locals[3] = stackPopInt32();
+        locals[3] = STACK_POP_INT32();
         uint32_t index = &locals[3] - stack;
-        stackType[index / 8] |= (1 << (index % 8));
+        SET_STACK_OBJECT(index);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_iastore:
     op_fastore:
     op_aastore: {
-        int32_t value = stackPopInt32();
-        int32_t index = stackPopInt32();
-        FlintJavaObject *obj = stackPopObject();
+        int32_t value = STACK_POP_INT32();
+        int32_t index = STACK_POP_INT32();
+        FlintJavaObject *obj = STACK_POP_OBJECT();
         if(obj == 0)
             goto store_null_array_excp;
         else if((index < 0) || (index >= (obj->size / sizeof(int32_t)))) {
-            char indexStrBuff[11];
-            char lengthStrBuff[11];
-            sprintf(indexStrBuff, "%d", (int)index);
-            sprintf(lengthStrBuff, "%d", obj->size / sizeof(int32_t));
-            const char *msg[] = {"Index ", indexStrBuff, " out of bounds for length ", lengthStrBuff};
-            FlintJavaString &strObj = flint.newString(msg, LENGTH(msg));
             try {
-                FlintJavaThrowable &excpObj = flint.newArrayIndexOutOfBoundsException(&strObj);
-                stackPushObject(&excpObj);
+                FlintJavaThrowable &excpObj = flint.newArrayIndexOutOfBoundsException(index, obj->size / sizeof(int32_t));
+                STACK_PUSH_OBJECT(&excpObj);
             }
             catch(FlintLoadFileError *file) {
                 fileNotFound = file;
@@ -1019,21 +1745,15 @@ void FlintExecution::run(void) {
     }
     op_lastore:
     op_dastore: {
-        int64_t value = stackPopInt64();
-        int32_t index = stackPopInt32();
-        FlintJavaObject *obj = stackPopObject();
+        int64_t value = STACK_POP_INT64();
+        int32_t index = STACK_POP_INT32();
+        FlintJavaObject *obj = STACK_POP_OBJECT();
         if(obj == 0)
             goto store_null_array_excp;
         else if((index < 0) || (index >= (obj->size / sizeof(int64_t)))) {
-            char indexStrBuff[11];
-            char lengthStrBuff[11];
-            sprintf(indexStrBuff, "%d", (int)index);
-            sprintf(lengthStrBuff, "%d", obj->size / sizeof(int64_t));
-            const char *msg[] = {"Index ", indexStrBuff, " out of bounds for length ", lengthStrBuff};
-            FlintJavaString &strObj = flint.newString(msg, LENGTH(msg));
             try {
-                FlintJavaThrowable &excpObj = flint.newArrayIndexOutOfBoundsException(&strObj);
-                stackPushObject(&excpObj);
+                FlintJavaThrowable &excpObj = flint.newArrayIndexOutOfBoundsException(index, obj->size / sizeof(int64_t));
+                STACK_PUSH_OBJECT(&excpObj);
             }
             catch(FlintLoadFileError *file) {
                 fileNotFound = file;
@@ -1046,21 +1766,15 @@ void FlintExecution::run(void) {
         goto *opcodes[code[pc]];
     }
     op_bastore: {
-        int32_t value = stackPopInt32();
-        int32_t index = stackPopInt32();
-        FlintJavaObject *obj = stackPopObject();
+        int32_t value = STACK_POP_INT32();
+        int32_t index = STACK_POP_INT32();
+        FlintJavaObject *obj = STACK_POP_OBJECT();
         if(obj == 0)
             goto store_null_array_excp;
         else if((index < 0) || (index >= (obj->size / sizeof(int8_t)))) {
-            char indexStrBuff[11];
-            char lengthStrBuff[11];
-            sprintf(indexStrBuff, "%d", (int)index);
-            sprintf(lengthStrBuff, "%d", obj->size / sizeof(int8_t));
-            const char *msg[] = {"Index ", indexStrBuff, " out of bounds for length ", lengthStrBuff};
-            FlintJavaString &strObj = flint.newString(msg, LENGTH(msg));
             try {
-                FlintJavaThrowable &excpObj = flint.newArrayIndexOutOfBoundsException(&strObj);
-                stackPushObject(&excpObj);
+                FlintJavaThrowable &excpObj = flint.newArrayIndexOutOfBoundsException(index, obj->size / sizeof(int8_t));
+                STACK_PUSH_OBJECT(&excpObj);
             }
             catch(FlintLoadFileError *file) {
                 fileNotFound = file;
@@ -1074,21 +1788,15 @@ void FlintExecution::run(void) {
     }
     op_castore:
     op_sastore: {
-        int32_t value = stackPopInt32();
-        int32_t index = stackPopInt32();
-        FlintJavaObject *obj = stackPopObject();
+        int32_t value = STACK_POP_INT32();
+        int32_t index = STACK_POP_INT32();
+        FlintJavaObject *obj = STACK_POP_OBJECT();
         if(obj == 0)
             goto store_null_array_excp;
         else if((index < 0) || (index >= (obj->size / sizeof(int16_t)))) {
-            char indexStrBuff[11];
-            char lengthStrBuff[11];
-            sprintf(indexStrBuff, "%d", (int)index);
-            sprintf(lengthStrBuff, "%d", obj->size / sizeof(int16_t));
-            const char *msg[] = {"Index ", indexStrBuff, " out of bounds for length ", lengthStrBuff};
-            FlintJavaString &strObj = flint.newString(msg, LENGTH(msg));
             try {
-                FlintJavaThrowable &excpObj = flint.newArrayIndexOutOfBoundsException(&strObj);
-                stackPushObject(&excpObj);
+                FlintJavaThrowable &excpObj = flint.newArrayIndexOutOfBoundsException(index, obj->size / sizeof(int16_t));
+                STACK_PUSH_OBJECT(&excpObj);
             }
             catch(FlintLoadFileError *file) {
                 fileNotFound = file;
@@ -1101,23 +1809,23 @@ void FlintExecution::run(void) {
         goto *opcodes[code[pc]];
     }
     op_pop:
-        stackPopInt32();
+        sp--;
         pc++;
         goto *opcodes[code[pc]];
     op_pop2:
-        stackPopInt64();
+        sp -= 2;
         pc++;
         goto *opcodes[code[pc]];
     op_dup: {
         FlintStackValue value = getStackValue(sp);
-        stackPush(value);
+        STACK_PUSH(value);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_dup_x1: {
         FlintStackValue value2 = getStackValue(sp - 1);
         FlintStackValue value1 = getStackValue(sp - 0);
-        stackPush(value1);
+        STACK_PUSH(value1);
         setStackValue(sp - 1, value2);
         setStackValue(sp - 2, value1);
         pc++;
@@ -1127,7 +1835,7 @@ void FlintExecution::run(void) {
         FlintStackValue value3 = getStackValue(sp - 2);
         FlintStackValue value2 = getStackValue(sp - 1);
         FlintStackValue value1 = getStackValue(sp - 0);
-        stackPush(value1);
+        STACK_PUSH(value1);
         setStackValue(sp - 1, value2);
         setStackValue(sp - 2, value3);
         setStackValue(sp - 3, value1);
@@ -1137,8 +1845,8 @@ void FlintExecution::run(void) {
     op_dup2: {
         FlintStackValue value2 = getStackValue(sp - 1);
         FlintStackValue value1 = getStackValue(sp - 0);
-        stackPush(value2);
-        stackPush(value1);
+        STACK_PUSH(value2);
+        STACK_PUSH(value1);
         pc++;
         goto *opcodes[code[pc]];
     }
@@ -1146,8 +1854,8 @@ void FlintExecution::run(void) {
         FlintStackValue value3 = getStackValue(sp - 2);
         FlintStackValue value2 = getStackValue(sp - 1);
         FlintStackValue value1 = getStackValue(sp - 0);
-        stackPush(value2);
-        stackPush(value1);
+        STACK_PUSH(value2);
+        STACK_PUSH(value1);
         setStackValue(sp - 2, value3);
         setStackValue(sp - 3, value1);
         setStackValue(sp - 4, value2);
@@ -1159,8 +1867,8 @@ void FlintExecution::run(void) {
         FlintStackValue value3 = getStackValue(sp - 2);
         FlintStackValue value2 = getStackValue(sp - 1);
         FlintStackValue value1 = getStackValue(sp - 0);
-        stackPush(value2);
-        stackPush(value1);
+        STACK_PUSH(value2);
+        STACK_PUSH(value1);
         setStackValue(sp - 2, value3);
         setStackValue(sp - 3, value4);
         setStackValue(sp - 4, value1);
@@ -1169,152 +1877,152 @@ void FlintExecution::run(void) {
         goto *opcodes[code[pc]];
     }
     op_iadd: {
-        int32_t value2 = stackPopInt32();
-        int32_t value1 = stackPopInt32();
-        stackPushInt32(value1 + value2);
+        int32_t value2 = STACK_POP_INT32();
+        int32_t value1 = STACK_POP_INT32();
+        STACK_PUSH_INT32(value1 + value2);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_ladd: {
-        int64_t value2 = stackPopInt64();
-        int64_t value1 = stackPopInt64();
-        stackPushInt64(value1 + value2);
+        int64_t value2 = STACK_POP_INT64();
+        int64_t value1 = STACK_POP_INT64();
+        STACK_PUSH_INT64(value1 + value2);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_fadd: {
-        float value2 = stackPopFloat();
-        float value1 = stackPopFloat();
-        stackPushFloat(value1 + value2);
+        float value2 = STACK_POP_FLOAT();
+        float value1 = STACK_POP_FLOAT();
+        STACK_PUSH_FLOAT(value1 + value2);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_dadd: {
-        double value2 = stackPopDouble();
-        double value1 = stackPopDouble();
-        stackPushDouble(value1 + value2);
+        double value2 = STACK_POP_DOUBLE();
+        double value1 = STACK_POP_DOUBLE();
+        STACK_PUSH_DOUBLE(value1 + value2);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_isub: {
-        int32_t value2 = stackPopInt32();
-        int32_t value1 = stackPopInt32();
-        stackPushInt32(value1 - value2);
+        int32_t value2 = STACK_POP_INT32();
+        int32_t value1 = STACK_POP_INT32();
+        STACK_PUSH_INT32(value1 - value2);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_lsub: {
-        int64_t value2 = stackPopInt64();
-        int64_t value1 = stackPopInt64();
-        stackPushInt64(value1 - value2);
+        int64_t value2 = STACK_POP_INT64();
+        int64_t value1 = STACK_POP_INT64();
+        STACK_PUSH_INT64(value1 - value2);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_fsub: {
-        float value2 = stackPopFloat();
-        float value1 = stackPopFloat();
-        stackPushFloat(value1 - value2);
+        float value2 = STACK_POP_FLOAT();
+        float value1 = STACK_POP_FLOAT();
+        STACK_PUSH_FLOAT(value1 - value2);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_dsub: {
-        double value2 = stackPopDouble();
-        double value1 = stackPopDouble();
-        stackPushDouble(value1 - value2);
+        double value2 = STACK_POP_DOUBLE();
+        double value1 = STACK_POP_DOUBLE();
+        STACK_PUSH_DOUBLE(value1 - value2);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_imul: {
-        int32_t value2 = stackPopInt32();
-        int32_t value1 = stackPopInt32();
-        stackPushInt32(value1 * value2);
+        int32_t value2 = STACK_POP_INT32();
+        int32_t value1 = STACK_POP_INT32();
+        STACK_PUSH_INT32(value1 * value2);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_lmul: {
-        int64_t value2 = stackPopInt64();
-        int64_t value1 = stackPopInt64();
-        stackPushInt64(value1 * value2);
+        int64_t value2 = STACK_POP_INT64();
+        int64_t value1 = STACK_POP_INT64();
+        STACK_PUSH_INT64(value1 * value2);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_fmul: {
-        float value2 = stackPopFloat();
-        float value1 = stackPopFloat();
-        stackPushFloat(value1 * value2);
+        float value2 = STACK_POP_FLOAT();
+        float value1 = STACK_POP_FLOAT();
+        STACK_PUSH_FLOAT(value1 * value2);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_dmul: {
-        double value2 = stackPopDouble();
-        double value1 = stackPopDouble();
-        stackPushDouble(value1 * value2);
+        double value2 = STACK_POP_DOUBLE();
+        double value1 = STACK_POP_DOUBLE();
+        STACK_PUSH_DOUBLE(value1 * value2);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_idiv: {
-        int32_t value2 = stackPopInt32();
-        int32_t value1 = stackPopInt32();
+        int32_t value2 = STACK_POP_INT32();
+        int32_t value1 = STACK_POP_INT32();
         if(value2 == 0)
             goto divided_by_zero_excp;
-        stackPushInt32(value1 / value2);
+        STACK_PUSH_INT32(value1 / value2);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_ldiv: {
-        int64_t value2 = stackPopInt64();
-        int64_t value1 = stackPopInt64();
+        int64_t value2 = STACK_POP_INT64();
+        int64_t value1 = STACK_POP_INT64();
         if(value2 == 0)
             goto divided_by_zero_excp;
-        stackPushInt64(value1 / value2);
+        STACK_PUSH_INT64(value1 / value2);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_fdiv: {
-        float value2 = stackPopFloat();
-        float value1 = stackPopFloat();
-        stackPushFloat(value1 / value2);
+        float value2 = STACK_POP_FLOAT();
+        float value1 = STACK_POP_FLOAT();
+        STACK_PUSH_FLOAT(value1 / value2);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_ddiv: {
-        double value2 = stackPopDouble();
-        double value1 = stackPopDouble();
-        stackPushDouble(value1 / value2);
+        double value2 = STACK_POP_DOUBLE();
+        double value1 = STACK_POP_DOUBLE();
+        STACK_PUSH_DOUBLE(value1 / value2);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_irem: {
-        int32_t value2 = stackPopInt32();
-        int32_t value1 = stackPopInt32();
+        int32_t value2 = STACK_POP_INT32();
+        int32_t value1 = STACK_POP_INT32();
         if(value2 == 0)
             goto divided_by_zero_excp;
-        stackPushInt32(value1 % value2);
+        STACK_PUSH_INT32(value1 % value2);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_lrem: {
-        int64_t value2 = stackPopInt64();
-        int64_t value1 = stackPopInt64();
+        int64_t value2 = STACK_POP_INT64();
+        int64_t value1 = STACK_POP_INT64();
         if(value2 == 0)
             goto divided_by_zero_excp;
-        stackPushInt64(value1 % value2);
+        STACK_PUSH_INT64(value1 % value2);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_frem: {
-        float value2 = stackPopFloat();
-        float value1 = stackPopFloat();
+        float value2 = STACK_POP_FLOAT();
+        float value1 = STACK_POP_FLOAT();
         int32_t temp = (int32_t)(value1 / value2);
-        stackPushFloat(value1 - (temp * value2));
+        STACK_PUSH_FLOAT(value1 - (temp * value2));
         pc++;
         goto *opcodes[code[pc]];
     }
     op_drem: {
-        double value2 = stackPopDouble();
-        double value1 = stackPopDouble();
+        double value2 = STACK_POP_DOUBLE();
+        double value1 = STACK_POP_DOUBLE();
         int64_t temp = (int64_t)(value1 / value2);
-        stackPushDouble(value1 - (temp * value2));
+        STACK_PUSH_DOUBLE(value1 - (temp * value2));
         pc++;
         goto *opcodes[code[pc]];
     }
@@ -1323,98 +2031,98 @@ void FlintExecution::run(void) {
         pc++;
         goto *opcodes[code[pc]];
     op_lneg:
-        stackPushInt64(-stackPopInt64());
+        STACK_PUSH_INT64(-STACK_POP_INT64());
         pc++;
         goto *opcodes[code[pc]];
     op_fneg:
-        stackPushFloat(-stackPopFloat());
+        STACK_PUSH_FLOAT(-STACK_POP_FLOAT());
         pc++;
         goto *opcodes[code[pc]];
     op_dneg:
-        stackPushDouble(-stackPopDouble());
+        STACK_PUSH_DOUBLE(-STACK_POP_DOUBLE());
         pc++;
         goto *opcodes[code[pc]];
     op_ishl: {
-        int32_t position = stackPopInt32();
-        int32_t value = stackPopInt32();
-        stackPushInt32(value << position);
+        int32_t position = STACK_POP_INT32();
+        int32_t value = STACK_POP_INT32();
+        STACK_PUSH_INT32(value << position);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_lshl: {
-        int32_t position = stackPopInt32();
-        int64_t value = stackPopInt64();
-        stackPushInt64(value << position);
+        int32_t position = STACK_POP_INT32();
+        int64_t value = STACK_POP_INT64();
+        STACK_PUSH_INT64(value << position);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_ishr: {
-        int32_t position = stackPopInt32();
-        int32_t value = stackPopInt32();
-        stackPushInt32(value >> position);
+        int32_t position = STACK_POP_INT32();
+        int32_t value = STACK_POP_INT32();
+        STACK_PUSH_INT32(value >> position);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_lshr: {
-        int32_t position = stackPopInt32();
-        int64_t value = stackPopInt64();
-        stackPushInt64(value >> position);
+        int32_t position = STACK_POP_INT32();
+        int64_t value = STACK_POP_INT64();
+        STACK_PUSH_INT64(value >> position);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_iushr: {
-        int32_t position = stackPopInt32();
-        uint32_t value = stackPopInt32();
-        stackPushInt32(value >> position);
+        int32_t position = STACK_POP_INT32();
+        uint32_t value = STACK_POP_INT32();
+        STACK_PUSH_INT32(value >> position);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_lushr: {
-        int32_t position = stackPopInt32();
-        uint64_t value = stackPopInt64();
-        stackPushInt64(value >> position);
+        int32_t position = STACK_POP_INT32();
+        uint64_t value = STACK_POP_INT64();
+        STACK_PUSH_INT64(value >> position);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_iand: {
-        int32_t value2 = stackPopInt32();
-        int32_t value1 = stackPopInt32();
-        stackPushInt32(value1 & value2);
+        int32_t value2 = STACK_POP_INT32();
+        int32_t value1 = STACK_POP_INT32();
+        STACK_PUSH_INT32(value1 & value2);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_land: {
-        int64_t value2 = stackPopInt64();
-        int64_t value1 = stackPopInt64();
-        stackPushInt64(value1 & value2);
+        int64_t value2 = STACK_POP_INT64();
+        int64_t value1 = STACK_POP_INT64();
+        STACK_PUSH_INT64(value1 & value2);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_ior: {
-        int32_t value2 = stackPopInt32();
-        int32_t value1 = stackPopInt32();
-        stackPushInt32(value1 | value2);
+        int32_t value2 = STACK_POP_INT32();
+        int32_t value1 = STACK_POP_INT32();
+        STACK_PUSH_INT32(value1 | value2);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_lor: {
-        int64_t value2 = stackPopInt64();
-        int64_t value1 = stackPopInt64();
-        stackPushInt64(value1 | value2);
+        int64_t value2 = STACK_POP_INT64();
+        int64_t value1 = STACK_POP_INT64();
+        STACK_PUSH_INT64(value1 | value2);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_ixor: {
-        int32_t value2 = stackPopInt32();
-        int32_t value1 = stackPopInt32();
-        stackPushInt32(value1 ^ value2);
+        int32_t value2 = STACK_POP_INT32();
+        int32_t value1 = STACK_POP_INT32();
+        STACK_PUSH_INT32(value1 ^ value2);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_lxor: {
-        int64_t value2 = stackPopInt64();
-        int64_t value1 = stackPopInt64();
-        stackPushInt64(value1 ^ value2);
+        int64_t value2 = STACK_POP_INT64();
+        int64_t value1 = STACK_POP_INT64();
+        STACK_PUSH_INT64(value1 ^ value2);
         pc++;
         goto *opcodes[code[pc]];
     }
@@ -1423,7 +2131,7 @@ void FlintExecution::run(void) {
         pc += 3;
         goto *opcodes[code[pc]];
     op_i2l:
-        stackPushInt64(stackPopInt32());
+        STACK_PUSH_INT64(STACK_POP_INT32());
         pc++;
         goto *opcodes[code[pc]];
     op_i2f: {
@@ -1433,19 +2141,19 @@ void FlintExecution::run(void) {
         goto *opcodes[code[pc]];
     }
     op_i2d:
-        stackPushDouble(stackPopInt32());
+        STACK_PUSH_DOUBLE(STACK_POP_INT32());
         pc++;
         goto *opcodes[code[pc]];
     op_l2i:
-        stackPushInt32(stackPopInt64());
+        STACK_PUSH_INT32(STACK_POP_INT64());
         pc++;
         goto *opcodes[code[pc]];
     op_l2f:
-        stackPushFloat(stackPopInt64());
+        STACK_PUSH_FLOAT(STACK_POP_INT64());
         pc++;
         goto *opcodes[code[pc]];
     op_l2d:
-        stackPushDouble(stackPopInt64());
+        STACK_PUSH_DOUBLE(STACK_POP_INT64());
         pc++;
         goto *opcodes[code[pc]];
     op_f2i:
@@ -1453,23 +2161,23 @@ void FlintExecution::run(void) {
         pc++;
         goto *opcodes[code[pc]];
     op_f2l:
-        stackPushInt64(stackPopFloat());
+        STACK_PUSH_INT64(STACK_POP_FLOAT());
         pc++;
         goto *opcodes[code[pc]];
     op_f2d:
-        stackPushDouble(stackPopFloat());
+        STACK_PUSH_DOUBLE(STACK_POP_FLOAT());
         pc++;
         goto *opcodes[code[pc]];
     op_d2i:
-        stackPushInt32(stackPopDouble());
+        STACK_PUSH_INT32(STACK_POP_DOUBLE());
         pc++;
         goto *opcodes[code[pc]];
     op_d2l:
-        stackPushInt64(stackPopDouble());
+        STACK_PUSH_INT64(STACK_POP_DOUBLE());
         pc++;
         goto *opcodes[code[pc]];
     op_d2f:
-        stackPushFloat(stackPopDouble());
+        STACK_PUSH_FLOAT(STACK_POP_DOUBLE());
         pc++;
         goto *opcodes[code[pc]];
     op_i2b:
@@ -1482,378 +2190,368 @@ void FlintExecution::run(void) {
         pc++;
         goto *opcodes[code[pc]];
     op_lcmp: {
-        int64_t value2 = stackPopInt64();
-        int64_t value1 = stackPopInt64();
-        stackPushInt32((value1 == value2) ? 0 : ((value1 < value2) ? -1 : 1));
+        int64_t value2 = STACK_POP_INT64();
+        int64_t value1 = STACK_POP_INT64();
+        STACK_PUSH_INT32((value1 == value2) ? 0 : ((value1 < value2) ? -1 : 1));
         pc++;
         goto *opcodes[code[pc]];
     }
     op_fcmpl:
     op_fcmpg: {
-        float value2 = stackPopFloat();
-        float value1 = stackPopFloat();
+        float value2 = STACK_POP_FLOAT();
+        float value1 = STACK_POP_FLOAT();
         if((*(uint32_t *)&value1 == FLOAT_NAN) || (*(uint32_t *)&value2 == FLOAT_NAN))
-            stackPushInt32((code[pc] == OP_FCMPL) ? -1 : 1);
+            STACK_PUSH_INT32((code[pc] == OP_FCMPL) ? -1 : 1);
         else if(value1 > value2)
-            stackPushInt32(1);
+            STACK_PUSH_INT32(1);
         else if(value1 == value2)
-            stackPushInt32(0);
+            STACK_PUSH_INT32(0);
         else
-            stackPushInt32(-1);
+            STACK_PUSH_INT32(-1);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_dcmpl:
     op_dcmpg: {
-        double value2 = stackPopDouble();
-        double value1 = stackPopDouble();
+        double value2 = STACK_POP_DOUBLE();
+        double value1 = STACK_POP_DOUBLE();
         if((*(uint64_t *)&value1 == DOUBLE_NAN) || (*(uint64_t *)&value2 == DOUBLE_NAN))
-            stackPushInt32((code[pc] == OP_DCMPL) ? -1 : 1);
+            STACK_PUSH_INT32((code[pc] == OP_DCMPL) ? -1 : 1);
         else if(value1 > value2)
-            stackPushInt32(1);
+            STACK_PUSH_INT32(1);
         else if(value1 == value2)
-            stackPushInt32(0);
+            STACK_PUSH_INT32(0);
         else
-            stackPushInt32(-1);
+            STACK_PUSH_INT32(-1);
         pc++;
         goto *opcodes[code[pc]];
     }
     op_ifeq:
     op_ifnull:
-        pc += (!stackPopInt32()) ? ARRAY_TO_INT16(&code[pc + 1]) : 3;
+        BRANCH(!STACK_POP_INT32(), CODE_TO_INT16(&code[pc + 1]), 3);
         goto *opcodes[code[pc]];
     op_ifne:
     op_ifnonnull:
-        pc += stackPopInt32() ? ARRAY_TO_INT16(&code[pc + 1]) : 3;
+        BRANCH(STACK_POP_INT32(), CODE_TO_INT16(&code[pc + 1]), 3);
         goto *opcodes[code[pc]];
     op_iflt:
-        pc += (stackPopInt32() < 0) ? ARRAY_TO_INT16(&code[pc + 1]) : 3;
+        BRANCH(STACK_POP_INT32() < 0, CODE_TO_INT16(&code[pc + 1]), 3);
         goto *opcodes[code[pc]];
     op_ifge:
-        pc += (stackPopInt32() >= 0) ? ARRAY_TO_INT16(&code[pc + 1]) : 3;
+        BRANCH(STACK_POP_INT32() >= 0, CODE_TO_INT16(&code[pc + 1]), 3);
         goto *opcodes[code[pc]];
     op_ifgt:
-        pc += (stackPopInt32() > 0) ? ARRAY_TO_INT16(&code[pc + 1]) : 3;
+        BRANCH(STACK_POP_INT32() > 0, CODE_TO_INT16(&code[pc + 1]), 3);
         goto *opcodes[code[pc]];
     op_ifle:
-        pc += (stackPopInt32() <= 0) ? ARRAY_TO_INT16(&code[pc + 1]) : 3;
+        BRANCH(STACK_POP_INT32() <= 0, CODE_TO_INT16(&code[pc + 1]), 3);
         goto *opcodes[code[pc]];
     op_if_icmpeq:
     op_if_acmpeq: {
-        int32_t value2 = stackPopInt32();
-        int32_t value1 = stackPopInt32();
-        pc += (value1 == value2) ? ARRAY_TO_INT16(&code[pc + 1]) : 3;
+        int32_t value2 = STACK_POP_INT32();
+        int32_t value1 = STACK_POP_INT32();
+        BRANCH(value1 == value2, CODE_TO_INT16(&code[pc + 1]), 3);
         goto *opcodes[code[pc]];
     }
     op_if_icmpne:
     op_if_acmpne: {
-        int32_t value2 = stackPopInt32();
-        int32_t value1 = stackPopInt32();
-        pc += (value1 != value2) ? ARRAY_TO_INT16(&code[pc + 1]) : 3;
+        int32_t value2 = STACK_POP_INT32();
+        int32_t value1 = STACK_POP_INT32();
+        BRANCH(value1 != value2, CODE_TO_INT16(&code[pc + 1]), 3);
         goto *opcodes[code[pc]];
     }
     op_if_icmplt: {
-        int32_t value2 = stackPopInt32();
-        int32_t value1 = stackPopInt32();
-        pc += (value1 < value2) ? ARRAY_TO_INT16(&code[pc + 1]) : 3;
+        int32_t value2 = STACK_POP_INT32();
+        int32_t value1 = STACK_POP_INT32();
+        BRANCH(value1 < value2, CODE_TO_INT16(&code[pc + 1]), 3);
         goto *opcodes[code[pc]];
     }
     op_if_icmpge: {
-        int32_t value2 = stackPopInt32();
-        int32_t value1 = stackPopInt32();
-        pc += (value1 >= value2) ? ARRAY_TO_INT16(&code[pc + 1]) : 3;
+        int32_t value2 = STACK_POP_INT32();
+        int32_t value1 = STACK_POP_INT32();
+        BRANCH(value1 >= value2, CODE_TO_INT16(&code[pc + 1]), 3);
         goto *opcodes[code[pc]];
     }
     op_if_icmpgt: {
-        int32_t value2 = stackPopInt32();
-        int32_t value1 = stackPopInt32();
-        pc += (value1 > value2) ? ARRAY_TO_INT16(&code[pc + 1]) : 3;
+        int32_t value2 = STACK_POP_INT32();
+        int32_t value1 = STACK_POP_INT32();
+        BRANCH(value1 > value2, CODE_TO_INT16(&code[pc + 1]), 3);
         goto *opcodes[code[pc]];
     }
     op_if_icmple: {
-        int32_t value2 = stackPopInt32();
-        int32_t value1 = stackPopInt32();
-        pc += (value1 <= value2) ? ARRAY_TO_INT16(&code[pc + 1]) : 3;
+        int32_t value2 = STACK_POP_INT32();
+        int32_t value1 = STACK_POP_INT32();
+        BRANCH(value1 <= value2, CODE_TO_INT16(&code[pc + 1]), 3);
         goto *opcodes[code[pc]];
     }
     op_goto:
-        pc += ARRAY_TO_INT16(&code[pc + 1]);
+        JUMP(CODE_TO_INT16(&code[pc + 1]));
         goto *opcodes[code[pc]];
     op_goto_w:
-        pc += ARRAY_TO_INT32(&code[pc + 1]);
+        JUMP(CODE_TO_INT32(&code[pc + 1]));
         goto *opcodes[code[pc]];
     op_jsr:
-        stackPushInt32(pc + 3);
-        pc += ARRAY_TO_INT16(&code[pc + 1]);
+        STACK_PUSH_INT32(pc + 3);
+        pc += CODE_TO_INT16(&code[pc + 1]);
         goto *opcodes[code[pc]];
     op_jsrw:
-        stackPushInt32(pc + 5);
-        pc += ARRAY_TO_INT32(&code[pc + 1]);
+        STACK_PUSH_INT32(pc + 5);
+        pc += CODE_TO_INT32(&code[pc + 1]);
         goto *opcodes[code[pc]];
     op_ret:
         pc = locals[code[pc + 1]];
         goto *opcodes[code[pc]];
     op_tableswitch: {
-        int32_t index = stackPopInt32();
-        uint8_t padding = (4 - ((pc + 1) % 4)) % 4;
-        const uint8_t *table = &code[pc + padding + 1];
-        int32_t low = ARRAY_TO_INT32(&table[4]);
-        int32_t height = ARRAY_TO_INT32(&table[8]);
+        int32_t index = STACK_POP_INT32();
+        const int32_t *table = CODE_TO_SWITCH_TABLE(code, pc);
+        int32_t low = table[1];
+        int32_t height = table[2];
         if(index < low || index > height) {
-            int32_t defaultOffset = ARRAY_TO_INT32(table);
-            pc += defaultOffset;
+            pc += table[0];
             goto *opcodes[code[pc]];
         }
-        table = &table[12 + (index - low) * 4];
-        pc += ARRAY_TO_INT32(table);
+        pc += table[3 + index - low];
         goto *opcodes[code[pc]];
     }
     op_lookupswitch: {
-        int32_t key = stackPopInt32();
-        uint8_t padding = (4 - ((pc + 1) % 4)) % 4;
-        const uint8_t *table = &code[pc + padding + 1];
-        int32_t defaultPc = ARRAY_TO_INT32(table);
-        int32_t npairs = ARRAY_TO_INT32(&table[4]);
-        table = &table[8];
-        while(npairs--) {
-            int32_t pairs = ARRAY_TO_INT32(table);
-            if(key == pairs) {
-                pc += ARRAY_TO_INT32(&table[4]);
+        int32_t key = STACK_POP_INT32();
+        const int32_t *table = CODE_TO_SWITCH_TABLE(code, pc);
+        int32_t defaultPc = table[0];
+        const int32_t *pairs = &table[2];
+        /* The class file keeps the keys sorted */
+        int32_t low = 0;
+        int32_t high = table[1] - 1;
+        while(low <= high) {
+            int32_t mid = (low + high) >> 1;
+            int32_t midKey = pairs[mid * 2];
+            if(midKey < key)
+                low = mid + 1;
+            else if(midKey > key)
+                high = mid - 1;
+            else {
+                pc += pairs[mid * 2 + 1];
                 goto *opcodes[code[pc]];
             }
-            table = &table[8];
         }
         pc += defaultPc;
         goto *opcodes[code[pc]];
     }
     op_ireturn:
     op_freturn: {
-        int32_t retVal = stackPopInt32();
-        if((method->accessFlag & METHOD_STATIC) == METHOD_STATIC) {
-            ClassData &classData = *(ClassData *)&method->classLoader;
-            if(classData.isInitializing) {
-                classData.isInitializing = 0;
-                Flint::unlock();
-            }
-        }
+        int32_t retVal = STACK_POP_INT32();
         stackRestoreContext();
-        stackPushInt32(retVal);
+        LOAD_REGISTERS();
+        STACK_PUSH_INT32(retVal);
         pc = lr;
-        goto *opcodes[code[pc]];
+        RESUME_FRAME();
     }
     op_lreturn:
     op_dreturn: {
-        int64_t retVal = stackPopInt64();
-        if((method->accessFlag & METHOD_STATIC) == METHOD_STATIC) {
-            ClassData &classData = *(ClassData *)&method->classLoader;
-            if(classData.isInitializing) {
-                classData.isInitializing = 0;
-                Flint::unlock();
-            }
-        }
+        int64_t retVal = STACK_POP_INT64();
         stackRestoreContext();
-        stackPushInt64(retVal);
+        LOAD_REGISTERS();
+        STACK_PUSH_INT64(retVal);
         pc = lr;
-        goto *opcodes[code[pc]];
+        RESUME_FRAME();
     }
     op_areturn: {
-        int32_t retVal = (int32_t)stackPopObject();
-        if((method->accessFlag & METHOD_STATIC) == METHOD_STATIC) {
-            ClassData &classData = *(ClassData *)&method->classLoader;
-            if(classData.isInitializing) {
-                classData.isInitializing = 0;
-                Flint::unlock();
-            }
-        }
+        int32_t retVal = (int32_t)STACK_POP_OBJECT();
         stackRestoreContext();
-        stackPushObject((FlintJavaObject *)retVal);
+        LOAD_REGISTERS();
+        STACK_PUSH_OBJECT((FlintJavaObject *)retVal);
         pc = lr;
-        goto *opcodes[code[pc]];
+        RESUME_FRAME();
     }
     op_return: {
-        if((method->accessFlag & METHOD_STATIC) == METHOD_STATIC) {
-            ClassData &classData = *(ClassData *)&method->classLoader;
-            if(classData.isInitializing) {
-                classData.isInitializing = 0;
-                Flint::unlock();
-            }
-        }
+        if(method->accessFlag & METHOD_STATIC)
+            leaveStaticConstructor(true);
         stackRestoreContext();
-        peakSp = sp;
+        LOAD_REGISTERS();
         pc = lr;
-        goto *opcodes[code[pc]];
+        RESUME_FRAME();
     }
     op_getstatic: {
-        FlintConstField &constField = method->classLoader.getConstField(ARRAY_TO_INT16(&code[pc + 1]));
-        FlintFieldsData &fields = flint.getStaticFields(constField.className);
-        if((int32_t)&fields == 0) {
-            try {
-                stackPushInt32((int32_t)(ClassData *)&flint.load(constField.className));
-            }
-            catch(FlintLoadFileError *file) {
-                fileNotFound = file;
-                goto file_not_found_excp;
-            }
+        FlintConstField &constField = method->classLoader.getConstField(CODE_TO_INT16(&code[pc + 1]));
+        ClassData *classData;
+        try {
+            classData = (ClassData *)&flint.load(constField.className);
+        }
+        catch(FlintLoadFileError *file) {
+            fileNotFound = file;
+            goto file_not_found_excp;
+        }
+        if(!isClassInitialized(*classData)) {
+            STACK_PUSH_INT32((int32_t)classData);
             goto init_static_field;
         }
+        FlintFieldsData &fields = *classData->staticFieldsData;
+        uint8_t quickOpCode;
         switch(constField.nameAndType.descriptor.text[0]) {
             case 'J':
-            case 'D': {
-                stackPushInt64(fields.getFieldData64(constField).value);
-                pc += 3;
-                goto *opcodes[code[pc]];
-            }
+            case 'D':
+                constField.staticValue = &fields.getFieldData64(constField).value;
+                quickOpCode = OP_LGETSTATIC_QUICK;
+                break;
             case 'L':
-            case '[': {
-                stackPushObject(fields.getFieldObject(constField).object);
-                pc += 3;
-                goto *opcodes[code[pc]];
-            }
-            default: {
-                stackPushInt32(fields.getFieldData32(constField).value);
-                pc += 3;
-                goto *opcodes[code[pc]];
-            }
+            case '[':
+                constField.staticValue = &fields.getFieldObject(constField).object;
+                quickOpCode = OP_AGETSTATIC_QUICK;
+                break;
+            default:
+                constField.staticValue = &fields.getFieldData32(constField).value;
+                quickOpCode = OP_IGETSTATIC_QUICK;
+                break;
         }
+        if(constField.fieldIndex == 0)
+            throw "field could not be found";
+        if(classData->initStatus == CLASS_INITIALIZED)
+            quickenOpCode(&code[pc], quickOpCode);
+        goto *opcodeLabels[quickOpCode];
     }
     op_putstatic: {
-        FlintConstField &constField = method->classLoader.getConstField(ARRAY_TO_INT16(&code[pc + 1]));
-        FlintFieldsData &fields = flint.getStaticFields(constField.className);
-        if((int32_t)&fields == 0) {
-            try {
-                stackPushInt32((int32_t)(ClassData *)&flint.load(constField.className));
-            }
-            catch(FlintLoadFileError *file) {
-                fileNotFound = file;
-                goto file_not_found_excp;
-            }
+        FlintConstField &constField = method->classLoader.getConstField(CODE_TO_INT16(&code[pc + 1]));
+        ClassData *classData;
+        try {
+            classData = (ClassData *)&flint.load(constField.className);
+        }
+        catch(FlintLoadFileError *file) {
+            fileNotFound = file;
+            goto file_not_found_excp;
+        }
+        if(!isClassInitialized(*classData)) {
+            STACK_PUSH_INT32((int32_t)classData);
             goto init_static_field;
         }
-        pc += 3;
+        FlintFieldsData &fields = *classData->staticFieldsData;
+        uint8_t quickOpCode;
         switch(constField.nameAndType.descriptor.text[0]) {
             case 'Z':
-            case 'B': {
-                fields.getFieldData32(constField).value = (int8_t)stackPopInt32();
-                goto *opcodes[code[pc]];
-            }
+            case 'B':
+                constField.staticValue = &fields.getFieldData32(constField).value;
+                quickOpCode = OP_BPUTSTATIC_QUICK;
+                break;
             case 'C':
-            case 'S': {
-                fields.getFieldData32(constField).value = (int16_t)stackPopInt32();
-                goto *opcodes[code[pc]];
-            }
+            case 'S':
+                constField.staticValue = &fields.getFieldData32(constField).value;
+                quickOpCode = OP_SPUTSTATIC_QUICK;
+                break;
             case 'J':
-            case 'D': {
-                fields.getFieldData64(constField).value = stackPopInt64();
-                goto *opcodes[code[pc]];
-            }
+            case 'D':
+                constField.staticValue = &fields.getFieldData64(constField).value;
+                quickOpCode = OP_LPUTSTATIC_QUICK;
+                break;
             case 'L':
-            case '[': {
-                fields.getFieldObject(constField).object = stackPopObject();
-                goto *opcodes[code[pc]];
-            }
-            default: {
-                fields.getFieldData32(constField).value = stackPopInt32();
-                goto *opcodes[code[pc]];
-            }
-        }
+            case '[':
+                constField.staticValue = &fields.getFieldObject(constField).object;
+                quickOpCode = OP_APUTSTATIC_QUICK;
+                break;
+            default:
+                constField.staticValue = &fields.getFieldData32(constField).value;
+                quickOpCode = OP_IPUTSTATIC_QUICK;
+                break;
+        }
+        if(constField.fieldIndex == 0)
+            throw "field could not be found";
+        if(classData->initStatus == CLASS_INITIALIZED)
+            quickenOpCode(&code[pc], quickOpCode);
+        goto *opcodeLabels[quickOpCode];
+    }
+    op_igetstatic_quick: {
+        FlintConstField &constField = *(FlintConstField *)method->classLoader.getConstPool(CODE_TO_INT16(&code[pc + 1])).value;
+        STACK_PUSH_INT32(*(int32_t *)constField.staticValue);
+        pc += 3;
+        goto *opcodes[code[pc]];
     }
-    op_getfield: {
-        FlintConstField &constField = method->classLoader.getConstField(ARRAY_TO_INT16(&code[pc + 1]));
+    op_lgetstatic_quick: {
+        FlintConstField &constField = *(FlintConstField *)method->classLoader.getConstPool(CODE_TO_INT16(&code[pc + 1])).value;
+        STACK_PUSH_INT64(*(int64_t *)constField.staticValue);
         pc += 3;
-        switch(constField.nameAndType.descriptor.text[0]) {
-            case 'J':
-            case 'D': {
-                FlintJavaObject *obj = stackPopObject();
-                if(obj == 0)
-                    goto getfield_null_excp;
-                stackPushInt64(obj->getFields().getFieldData64(constField).value);
-                goto *opcodes[code[pc]];
-            }
-            case 'L':
-            case '[': {
-                FlintJavaObject *obj = stackPopObject();
-                if(obj == 0)
-                    goto getfield_null_excp;
-                stackPushObject(obj->getFields().getFieldObject(constField).object);
-                goto *opcodes[code[pc]];
-            }
-            default: {
-                FlintJavaObject *obj = stackPopObject();
-                if(obj == 0)
-                    goto getfield_null_excp;
-                stackPushInt32(obj->getFields().getFieldData32(constField).value);
-                goto *opcodes[code[pc]];
-            }
-        }
-        getfield_null_excp: {
-            const char *msg[] = {"Cannot read field '", constField.nameAndType.name.text, "' from null object"};
-            FlintJavaString &strObj = flint.newString(msg, LENGTH(msg));
-            try {
-                FlintJavaThrowable &excpObj = flint.newNullPointerException(&strObj);
-                stackPushObject(&excpObj);
-            }
-            catch(FlintLoadFileError *file) {
-                fileNotFound = file;
-                goto file_not_found_excp;
-            }
-            goto exception_handler;
-        }
+        goto *opcodes[code[pc]];
     }
-    op_putfield: {
-        FlintConstField &constField = method->classLoader.getConstField(ARRAY_TO_INT16(&code[pc + 1]));
+    op_agetstatic_quick: {
+        FlintConstField &constField = *(FlintConstField *)method->classLoader.getConstPool(CODE_TO_INT16(&code[pc + 1])).value;
+        STACK_PUSH_OBJECT(*(FlintJavaObject **)constField.staticValue);
         pc += 3;
-        switch(constField.nameAndType.descriptor.text[0]) {
-            case 'Z':
-            case 'B': {
-                int32_t value = stackPopInt32();
-                FlintJavaObject *obj = stackPopObject();
-                if(obj == 0)
-                    goto putfield_null_excp;
-                obj->getFields().getFieldData32(constField).value = (int8_t)value;
-                goto *opcodes[code[pc]];
+        goto *opcodes[code[pc]];
+    }
+    op_bputstatic_quick: {
+        FlintConstField &constField = *(FlintConstField *)method->classLoader.getConstPool(CODE_TO_INT16(&code[pc + 1])).value;
+        *(int32_t *)constField.staticValue = (int8_t)STACK_POP_INT32();
+        pc += 3;
+        goto *opcodes[code[pc]];
+    }
+    op_sputstatic_quick: {
+        FlintConstField &constField = *(FlintConstField *)method->classLoader.getConstPool(CODE_TO_INT16(&code[pc + 1])).value;
+        *(int32_t *)constField.staticValue = (int16_t)STACK_POP_INT32();
+        pc += 3;
+        goto *opcodes[code[pc]];
+    }
+    op_iputstatic_quick: {
+        FlintConstField &constField = *(FlintConstField *)method->classLoader.getConstPool(CODE_TO_INT16(&code[pc + 1])).value;
+        *(int32_t *)constField.staticValue = STACK_POP_INT32();
+        pc += 3;
+        goto *opcodes[code[pc]];
+    }
+    op_lputstatic_quick: {
+        FlintConstField &constField = *(FlintConstField *)method->classLoader.getConstPool(CODE_TO_INT16(&code[pc + 1])).value;
+        *(int64_t *)constField.staticValue = STACK_POP_INT64();
+        pc += 3;
+        goto *opcodes[code[pc]];
+    }
+    op_aputstatic_quick: {
+        FlintConstField &constField = *(FlintConstField *)method->classLoader.getConstPool(CODE_TO_INT16(&code[pc + 1])).value;
+        *(FlintJavaObject **)constField.staticValue = STACK_POP_OBJECT();
+        pc += 3;
+        goto *opcodes[code[pc]];
+    }
+    op_getfield: {
+        FlintConstField &constField = method->classLoader.getConstField(CODE_TO_INT16(&code[pc + 1]));
+        FlintJavaObject *obj = (FlintJavaObject *)stack[sp];
+        if(obj == 0) {
+            sp--;
+            const char *msg[] = {"Cannot read field '", constField.nameAndType.name.text, "' from null object"};
+            try {
+                FlintJavaThrowable &excpObj = flint.newNullPointerException(msg, LENGTH(msg));
+                STACK_PUSH_OBJECT(&excpObj);
             }
-            case 'C':
-            case 'S': {
-                int32_t value = stackPopInt32();
-                FlintJavaObject *obj = stackPopObject();
-                if(obj == 0)
-                    goto putfield_null_excp;
-                obj->getFields().getFieldData32(constField).value = (int16_t)value;
-                goto *opcodes[code[pc]];
+            catch(FlintLoadFileError *file) {
+                fileNotFound = file;
+                goto file_not_found_excp;
             }
+            goto exception_handler;
+        }
+        uint8_t quickOpCode;
+        switch(constField.nameAndType.descriptor.text[0]) {
             case 'J':
-            case 'D': {
-                int64_t value = stackPopInt64();
-                FlintJavaObject *obj = stackPopObject();
-                if(obj == 0)
-                    goto putfield_null_excp;
-                obj->getFields().getFieldData64(constField).value = value;
-                goto *opcodes[code[pc]];
-            }
+            case 'D':
+                obj->getFields().getFieldData64(constField);
+                quickOpCode = OP_LGETFIELD_QUICK;
+                break;
             case 'L':
-            case '[': {
-                FlintJavaObject *value = stackPopObject();
-                FlintJavaObject *obj = stackPopObject();
-                if(obj == 0)
-                    goto putfield_null_excp;
-                obj->getFields().getFieldObject(constField).object = value;
-                goto *opcodes[code[pc]];
-            }
-            default: {
-                int32_t value = stackPopInt32();
-                FlintJavaObject *obj = stackPopObject();
-                if(obj == 0)
-                    goto putfield_null_excp;
-                obj->getFields().getFieldData32(constField).value = value;
-                goto *opcodes[code[pc]];
-            }
+            case '[':
+                obj->getFields().getFieldObject(constField);
+                quickOpCode = OP_AGETFIELD_QUICK;
+                break;
+            default:
+                obj->getFields().getFieldData32(constField);
+                quickOpCode = OP_IGETFIELD_QUICK;
+                break;
         }
-        putfield_null_excp: {
+        if(constField.fieldIndex == 0)
+            throw "field could not be found";
+        quickenOpCode(&code[pc], quickOpCode);
+        goto *opcodeLabels[quickOpCode];
+    }
+    op_putfield: {
+        FlintConstField &constField = method->classLoader.getConstField(CODE_TO_INT16(&code[pc + 1]));
+        uint8_t valueSize = (constField.nameAndType.descriptor.text[0] == 'J' || constField.nameAndType.descriptor.text[0] == 'D') ? 2 : 1;
+        FlintJavaObject *obj = (FlintJavaObject *)stack[sp - valueSize];
+        if(obj == 0) {
+            sp -= valueSize + 1;
             const char *msg[] = {"Cannot assign field '", constField.nameAndType.name.text, "' for null object"};
-            FlintJavaString &strObj = flint.newString(msg, LENGTH(msg));
             try {
-                FlintJavaThrowable &excpObj = flint.newNullPointerException(&strObj);
-                stackPushObject(&excpObj);
+                FlintJavaThrowable &excpObj = flint.newNullPointerException(msg, LENGTH(msg));
+                STACK_PUSH_OBJECT(&excpObj);
             }
             catch(FlintLoadFileError *file) {
                 fileNotFound = file;
@@ -1861,118 +2559,348 @@ void FlintExecution::run(void) {
             }
             goto exception_handler;
         }
+        uint8_t quickOpCode;
+        switch(constField.nameAndType.descriptor.text[0]) {
+            case 'Z':
+            case 'B':
+                obj->getFields().getFieldData32(constField);
+                quickOpCode = OP_BPUTFIELD_QUICK;
+                break;
+            case 'C':
+            case 'S':
+                obj->getFields().getFieldData32(constField);
+                quickOpCode = OP_SPUTFIELD_QUICK;
+                break;
+            case 'J':
+            case 'D':
+                obj->getFields().getFieldData64(constField);
+                quickOpCode = OP_LPUTFIELD_QUICK;
+                break;
+            case 'L':
+            case '[':
+                obj->getFields().getFieldObject(constField);
+                quickOpCode = OP_APUTFIELD_QUICK;
+                break;
+            default:
+                obj->getFields().getFieldData32(constField);
+                quickOpCode = OP_IPUTFIELD_QUICK;
+                break;
+        }
+        if(constField.fieldIndex == 0)
+            throw "field could not be found";
+        quickenOpCode(&code[pc], quickOpCode);
+        goto *opcodeLabels[quickOpCode];
+    }
+    op_igetfield_quick: {
+        FlintConstField &constField = *(FlintConstField *)method->classLoader.getConstPool(CODE_TO_INT16(&code[pc + 1])).value;
+        FlintJavaObject *obj = STACK_POP_OBJECT();
+        if(obj == 0)
+            goto getfield_quick_null_excp;
+        STACK_PUSH_INT32(((FlintFieldsData *)obj->data)->fieldsData32[constField.fieldIndex & 0x7FFFFFFF].value);
+        pc += 3;
+        goto *opcodes[code[pc]];
     }
-    op_invokevirtual: {
-        FlintConstMethod &constMethod = method->classLoader.getConstMethod(ARRAY_TO_INT16(&code[pc + 1]));
-        lr = pc + 3;
+    op_lgetfield_quick: {
+        FlintConstField &constField = *(FlintConstField *)method->classLoader.getConstPool(CODE_TO_INT16(&code[pc + 1])).value;
+        FlintJavaObject *obj = STACK_POP_OBJECT();
+        if(obj == 0)
+            goto getfield_quick_null_excp;
+        STACK_PUSH_INT64(((FlintFieldsData *)obj->data)->fieldsData64[constField.fieldIndex & 0x7FFFFFFF].value);
+        pc += 3;
+        goto *opcodes[code[pc]];
+    }
+    op_agetfield_quick: {
+        FlintConstField &constField = *(FlintConstField *)method->classLoader.getConstPool(CODE_TO_INT16(&code[pc + 1])).value;
+        FlintJavaObject *obj = STACK_POP_OBJECT();
+        if(obj == 0)
+            goto getfield_quick_null_excp;
+        STACK_PUSH_OBJECT(((FlintFieldsData *)obj->data)->fieldsObject[constField.fieldIndex & 0x7FFFFFFF].object);
+        pc += 3;
+        goto *opcodes[code[pc]];
+    }
+    op_bputfield_quick: {
+        FlintConstField &constField = *(FlintConstField *)method->classLoader.getConstPool(CODE_TO_INT16(&code[pc + 1])).value;
+        int32_t value = STACK_POP_INT32();
+        FlintJavaObject *obj = STACK_POP_OBJECT();
+        if(obj == 0)
+            goto putfield_quick_null_excp;
+        ((FlintFieldsData *)obj->data)->fieldsData32[constField.fieldIndex & 0x7FFFFFFF].value = (int8_t)value;
+        pc += 3;
+        goto *opcodes[code[pc]];
+    }
+    op_sputfield_quick: {
+        FlintConstField &constField = *(FlintConstField *)method->classLoader.getConstPool(CODE_TO_INT16(&code[pc + 1])).value;
+        int32_t value = STACK_POP_INT32();
+        FlintJavaObject *obj = STACK_POP_OBJECT();
+        if(obj == 0)
+            goto putfield_quick_null_excp;
+        ((FlintFieldsData *)obj->data)->fieldsData32[constField.fieldIndex & 0x7FFFFFFF].value = (int16_t)value;
+        pc += 3;
+        goto *opcodes[code[pc]];
+    }
+    op_iputfield_quick: {
+        FlintConstField &constField = *(FlintConstField *)method->classLoader.getConstPool(CODE_TO_INT16(&code[pc + 1])).value;
+        int32_t value = STACK_POP_INT32();
+        FlintJavaObject *obj = STACK_POP_OBJECT();
+        if(obj == 0)
+            goto putfield_quick_null_excp;
+        ((FlintFieldsData *)obj->data)->fieldsData32[constField.fieldIndex & 0x7FFFFFFF].value = value;
+        pc += 3;
+        goto *opcodes[code[pc]];
+    }
+    op_lputfield_quick: {
+        FlintConstField &constField = *(FlintConstField *)method->classLoader.getConstPool(CODE_TO_INT16(&code[pc + 1])).value;
+        int64_t value = STACK_POP_INT64();
+        FlintJavaObject *obj = STACK_POP_OBJECT();
+        if(obj == 0)
+            goto putfield_quick_null_excp;
+        ((FlintFieldsData *)obj->data)->fieldsData64[constField.fieldIndex & 0x7FFFFFFF].value = value;
+        pc += 3;
+        goto *opcodes[code[pc]];
+    }
+    op_aputfield_quick: {
+        FlintConstField &constField = *(FlintConstField *)method->classLoader.getConstPool(CODE_TO_INT16(&code[pc + 1])).value;
+        FlintJavaObject *value = STACK_POP_OBJECT();
+        FlintJavaObject *obj = STACK_POP_OBJECT();
+        if(obj == 0)
+            goto putfield_quick_null_excp;
+        ((FlintFieldsData *)obj->data)->fieldsObject[constField.fieldIndex & 0x7FFFFFFF].object = value;
+        pc += 3;
+        goto *opcodes[code[pc]];
+    }
+    getfield_quick_null_excp: {
+        FlintConstField &constField = *(FlintConstField *)method->classLoader.getConstPool(CODE_TO_INT16(&code[pc + 1])).value;
+        const char *msg[] = {"Cannot read field '", constField.nameAndType.name.text, "' from null object"};
         try {
-            invokeVirtual(constMethod);
-        }
-        catch(FlintJavaThrowable *ex) {
-            stackPushObject(ex);
-            goto exception_handler;
+            FlintJavaThrowable &excpObj = flint.newNullPointerException(msg, LENGTH(msg));
+            STACK_PUSH_OBJECT(&excpObj);
         }
         catch(FlintLoadFileError *file) {
             fileNotFound = file;
             goto file_not_found_excp;
         }
-        catch(FlintFindNativeError *err) {
-            const char *msg[] = {err->getMessage(), " ", constMethod.nameAndType.name.text};
-            FlintJavaString &strObj = flint.newString(msg, LENGTH(msg));
-            FlintJavaThrowable &excpObj = flint.newUnsatisfiedLinkErrorException(&strObj);
-            stackPushObject(&excpObj);
-            goto exception_handler;
-        }
-        catch(const char *msg) {
-            FlintJavaThrowable &excpObj = flint.newException(&flint.newString(msg, strlen(msg)));
-            stackPushObject(&excpObj);
-            goto exception_handler;
-        }
-        goto *opcodes[code[pc]];
+        goto exception_handler;
     }
-    op_invokespecial: {
-        FlintConstMethod &constMethod = method->classLoader.getConstMethod(ARRAY_TO_INT16(&code[pc + 1]));
-        lr = pc + 3;
+    putfield_quick_null_excp: {
+        FlintConstField &constField = *(FlintConstField *)method->classLoader.getConstPool(CODE_TO_INT16(&code[pc + 1])).value;
+        const char *msg[] = {"Cannot assign field '", constField.nameAndType.name.text, "' for null object"};
         try {
-            invokeSpecial(constMethod);
-        }
-        catch(FlintJavaThrowable *ex) {
-            stackPushObject(ex);
-            goto exception_handler;
+            FlintJavaThrowable &excpObj = flint.newNullPointerException(msg, LENGTH(msg));
+            STACK_PUSH_OBJECT(&excpObj);
         }
         catch(FlintLoadFileError *file) {
             fileNotFound = file;
             goto file_not_found_excp;
         }
-        catch(FlintFindNativeError *err) {
-            const char *msg[] = {err->getMessage(), " ", constMethod.nameAndType.name.text};
-            FlintJavaString &strObj = flint.newString(msg, LENGTH(msg));
-            FlintJavaThrowable &excpObj = flint.newUnsatisfiedLinkErrorException(&strObj);
-            stackPushObject(&excpObj);
-            goto exception_handler;
-        }
-        catch(const char *msg) {
-            FlintJavaThrowable &excpObj = flint.newException(&flint.newString(msg, strlen(msg)));
-            stackPushObject(&excpObj);
-            goto exception_handler;
+        goto exception_handler;
+    }
+    op_invokevirtual: {
+        FlintConstMethod &constMethod = method->classLoader.getConstMethod(CODE_TO_INT16(&code[pc + 1]));
+        if(flint.canDevirtualize(constMethod)) {
+            quickenOpCode(&code[pc], OP_INVOKEVIRTUAL_DIRECT);
+            goto op_invokevirtual_direct;
         }
-        goto *opcodes[code[pc]];
+        quickenOpCode(&code[pc], OP_INVOKEVIRTUAL_QUICK);
+        goto op_invokevirtual_quick;
+    }
+    op_invokespecial: {
+        FlintConstMethod &constMethod = method->classLoader.getConstMethod(CODE_TO_INT16(&code[pc + 1]));
+        lr = pc + 3;
+        SAVE_REGISTERS();
+        FlintMethodInfo *methodInfo = resolveMethod(constMethod);
+        if(methodInfo && !(methodInfo->accessFlag & METHOD_SYNCHRONIZED)) {
+            quickenOpCode(&code[pc], OP_INVOKESPECIAL_QUICK);
+            goto op_invokespecial_quick;
+        }
+        bool isInvoked = methodInfo && invokeSpecial(constMethod);
+        LOAD_REGISTERS();
+        if(!isInvoked)
+            goto pending_excp;
+        RESUME_FRAME();
     }
     op_invokestatic: {
-        FlintConstMethod &constMethod = method->classLoader.getConstMethod(ARRAY_TO_INT16(&code[pc + 1]));
+        FlintConstMethod &constMethod = method->classLoader.getConstMethod(CODE_TO_INT16(&code[pc + 1]));
         lr = pc + 3;
-        try {
-            invokeStatic(constMethod);
+        SAVE_REGISTERS();
+        FlintMethodInfo *methodInfo = resolveMethod(constMethod);
+        if(methodInfo) {
+            ClassData &classData = *(ClassData *)&methodInfo->classLoader;
+            if(!isClassInitialized(classData)) {
+                STACK_PUSH_INT32((int32_t)&classData);
+                goto init_static_field;
+            }
+            if(!(methodInfo->accessFlag & METHOD_SYNCHRONIZED) && classData.initStatus == CLASS_INITIALIZED) {
+                quickenOpCode(&code[pc], OP_INVOKESTATIC_QUICK);
+                goto op_invokestatic_quick;
+            }
         }
-        catch(FlintJavaThrowable *ex) {
-            stackPushObject(ex);
-            goto exception_handler;
+        bool isInvoked = methodInfo && invokeStatic(constMethod);
+        LOAD_REGISTERS();
+        if(!isInvoked)
+            goto pending_excp;
+        RESUME_FRAME();
+    }
+    op_invokevirtual_direct: {
+        FlintConstMethod &constMethod = *(FlintConstMethod *)method->classLoader.getConstPool(CODE_TO_INT16(&code[pc + 1])).value;
+        FlintMethodInfo &methodInfo = *constMethod.methodInfo;
+        if(methodInfo.accessFlag & METHOD_OVERRIDDEN) {
+            /* A class loaded after binding overrides the target */
+            quickenOpCode(&code[pc], OP_INVOKEVIRTUAL_QUICK);
+            goto op_invokevirtual_quick;
         }
-        catch(FlintLoadFileError *file) {
-            fileNotFound = file;
-            goto file_not_found_excp;
+        if(stack[sp - methodInfo.argc + 1] == 0)
+            goto op_invokevirtual_quick;
+        lr = pc + 3;
+        SAVE_REGISTERS();
+        bool isInvoked = invoke(methodInfo, methodInfo.argc);
+        LOAD_REGISTERS();
+        if(!isInvoked)
+            goto pending_excp;
+        RESUME_FRAME();
+    }
+    op_invokevirtual_quick: {
+        FlintConstMethod &constMethod = *(FlintConstMethod *)method->classLoader.getConstPool(CODE_TO_INT16(&code[pc + 1])).value;
+        lr = pc + 3;
+        SAVE_REGISTERS();
+        bool isInvoked = invokeVirtual(constMethod);
+        LOAD_REGISTERS();
+        if(!isInvoked)
+            goto pending_excp;
+        RESUME_FRAME();
+    }
+    op_invokespecial_quick: {
+        FlintConstMethod &constMethod = *(FlintConstMethod *)method->classLoader.getConstPool(CODE_TO_INT16(&code[pc + 1])).value;
+        lr = pc + 3;
+        SAVE_REGISTERS();
+        bool isInvoked = invoke(*constMethod.methodInfo, constMethod.methodInfo->argc);
+        LOAD_REGISTERS();
+        if(!isInvoked)
+            goto pending_excp;
+        RESUME_FRAME();
+    }
+    op_invokestatic_quick: {
+        FlintConstMethod &constMethod = *(FlintConstMethod *)method->classLoader.getConstPool(CODE_TO_INT16(&code[pc + 1])).value;
+        lr = pc + 3;
+        SAVE_REGISTERS();
+        bool isInvoked = invoke(*constMethod.methodInfo, constMethod.methodInfo->argc);
+        LOAD_REGISTERS();
+        if(!isInvoked)
+            goto pending_excp;
+        RESUME_FRAME();
+    }
+    op_aload_0_getfield: {
+        FlintJavaObject *obj = (FlintJavaObject *)locals[0];
+        uint8_t opcode = *(volatile uint8_t *)&code[pc + 1];
+        if(obj == 0 || opcode < OP_IGETFIELD_QUICK || opcode > OP_AGETFIELD_QUICK)
+            goto op_aload_0;
+        FlintConstField &constField = *(FlintConstField *)method->classLoader.getConstPool(CODE_TO_INT16(&code[pc + 2])).value;
+        uint32_t index = constField.fieldIndex & 0x7FFFFFFF;
+        FlintFieldsData *fields = (FlintFieldsData *)obj->data;
+        if(opcode == OP_IGETFIELD_QUICK)
+            STACK_PUSH_INT32(fields->fieldsData32[index].value);
+        else if(opcode == OP_LGETFIELD_QUICK)
+            STACK_PUSH_INT64(fields->fieldsData64[index].value);
+        else
+            STACK_PUSH_OBJECT(fields->fieldsObject[index].object);
+        pc += 4;
+        goto *opcodes[code[pc]];
+    }
+    op_iload_iload_iadd_istore:
+    op_iload_iload_iadd_istore_w: {
+        uint32_t index = code[pc + 3];
+        locals[index] = locals[code[pc + 1]] + locals[code[pc + 2]];
+        index = &locals[index] - stack;
+        CLEAR_STACK_OBJECT(index);
+        pc += (code[pc] == OP_ILOAD_ILOAD_IADD_ISTORE) ? 4 : code[pc + 4];
+        goto *opcodes[code[pc]];
+    }
+    op_ireg_arith: {
+        uint32_t index = code[pc + 2] >> 4;
+        locals[index] = intRegOp(code[pc + 2] & 0x0F, locals[code[pc + 1] >> 4], locals[code[pc + 1] & 0x0F]);
+        index = &locals[index] - stack;
+        CLEAR_STACK_OBJECT(index);
+        pc += code[pc + 3];
+        goto *opcodes[code[pc]];
+    }
+    op_ireg_arith_imm: {
+        uint32_t index = code[pc + 1] & 0x0F;
+        locals[index] = intRegOp(code[pc + 2] & 0x0F, locals[code[pc + 1] >> 4], (int8_t)code[pc + 3]);
+        index = &locals[index] - stack;
+        CLEAR_STACK_OBJECT(index);
+        pc += 4 + (code[pc + 2] >> 4);
+        goto *opcodes[code[pc]];
+    }
+    op_ireg_if_icmp: {
+        int32_t value1 = locals[code[pc + 1] >> 4];
+        int32_t value2 = locals[code[pc + 1] & 0x0F];
+        BRANCH(intRegCompare(code[pc + 2] & 0x0F, value1, value2), CODE_TO_INT16(&code[pc + 3]), 5 + (code[pc + 2] >> 4));
+        goto *opcodes[code[pc]];
+    }
+    op_iinc_goto:
+        locals[code[pc + 1]] += (int8_t)code[pc + 2];
+        pc += 3;
+        JUMP(CODE_TO_INT16(&code[pc + 1]));
+        goto *opcodes[code[pc]];
+    op_aload_arraylength_if_icmpge: {
+        FlintJavaObject *obj = (FlintJavaObject *)locals[code[pc + 1]];
+        if(obj == 0)
+            goto op_aload;
+        int32_t value1 = STACK_POP_INT32();
+        pc += (value1 >= (int32_t)(obj->size / obj->parseTypeSize())) ? (3 + CODE_TO_INT16(&code[pc + 4])) : 6;
+        goto *opcodes[code[pc]];
+    }
+    op_aload_n_arraylength_if_icmpge: {
+        FlintJavaObject *obj = (FlintJavaObject *)locals[code[pc + 1]];
+        if(obj == 0) {
+            STACK_PUSH_OBJECT(obj);
+            pc++;
+            goto op_arraylength;
         }
-        catch(FlintFindNativeError *err) {
-            const char *msg[] = {err->getMessage(), " ", constMethod.nameAndType.name.text};
-            FlintJavaThrowable &excpObj = flint.newUnsatisfiedLinkErrorException(&flint.newString(msg, LENGTH(msg)));
-            stackPushObject(&excpObj);
+        int32_t value1 = STACK_POP_INT32();
+        pc += (value1 >= (int32_t)(obj->size / obj->parseTypeSize())) ? (2 + CODE_TO_INT16(&code[pc + 3])) : 5;
+        goto *opcodes[code[pc]];
+    }
+    op_string_switch: {
+        FlintJavaString *str = (FlintJavaString *)stack[sp];
+        if(str == 0) {
+            sp--;
+            const char *msg[] = {"Cannot invoke java/lang/String.hashCode by null object"};
+            try {
+                FlintJavaThrowable &excpObj = flint.newNullPointerException(msg, LENGTH(msg));
+                STACK_PUSH_OBJECT(&excpObj);
+            }
+            catch(FlintLoadFileError *file) {
+                fileNotFound = file;
+                goto file_not_found_excp;
+            }
             goto exception_handler;
         }
-        catch(const char *msg) {
-            FlintJavaThrowable &excpObj = flint.newException(&flint.newString(msg, strlen(msg)));
-            stackPushObject(&excpObj);
-            goto exception_handler;
+        const FlintStringSwitch &stringSwitch = method->getAttributeCode().getStringSwitch(CODE_TO_UINT16(&code[pc + 1]));
+        uint16_t count;
+        const FlintStringCase *cases = stringSwitch.findCases(str->hashCode(), count);
+        /* The string stays on the stack while the case strings are resolved so the GC can see it */
+        for(uint16_t i = 0; i < count; i++) {
+            if(str->equals(method->classLoader.getConstString(flint, cases[i].stringIndex))) {
+                locals[stringSwitch.resultLocal] = cases[i].value;
+                uint32_t index = &locals[stringSwitch.resultLocal] - stack;
+                CLEAR_STACK_OBJECT(index);
+                break;
+            }
         }
+        sp--;
+        pc = stringSwitch.endPc;
         goto *opcodes[code[pc]];
     }
     op_invokeinterface: {
-        FlintConstInterfaceMethod &interfaceMethod = method->classLoader.getConstInterfaceMethod(ARRAY_TO_INT16(&code[pc + 1]));
+        FlintConstInterfaceMethod &interfaceMethod = method->classLoader.getConstInterfaceMethod(CODE_TO_INT16(&code[pc + 1]));
         uint8_t count = code[pc + 3];
         lr = pc + 5;
-        try {
-            invokeInterface(interfaceMethod, count);
-        }
-        catch(FlintJavaThrowable *ex) {
-            stackPushObject(ex);
-            goto exception_handler;
-        }
-        catch(FlintLoadFileError *file) {
-            fileNotFound = file;
-            goto file_not_found_excp;
-        }
-        catch(FlintFindNativeError *err) {
-            const char *msg[] = {err->getMessage(), " ", interfaceMethod.nameAndType.name.text};
-            FlintJavaString &strObj = flint.newString(msg, LENGTH(msg));
-            FlintJavaThrowable &excpObj = flint.newUnsatisfiedLinkErrorException(&strObj);
-            stackPushObject(&excpObj);
-            goto exception_handler;
-        }
-        catch(const char *msg) {
-            FlintJavaThrowable &excpObj = flint.newException(&flint.newString(msg, strlen(msg)));
-            stackPushObject(&excpObj);
-            goto exception_handler;
-        }
-        goto *opcodes[code[pc]];
+        SAVE_REGISTERS();
+        bool isInvoked = invokeInterface(interfaceMethod, count);
+        LOAD_REGISTERS();
+        if(!isInvoked)
+            goto pending_excp;
+        RESUME_FRAME();
     }
     op_invokedynamic: {
         // TODO
@@ -1980,7 +2908,7 @@ void FlintExecution::run(void) {
         FlintJavaString &strObj = flint.newString(STR_AND_SIZE("Invokedynamic instructions are not supported"));
         try {
             FlintJavaThrowable &excpObj = flint.newUnsupportedOperationException(&strObj);
-            stackPushObject(&excpObj);
+            STACK_PUSH_OBJECT(&excpObj);
         }
         catch(FlintLoadFileError *file) {
             fileNotFound = file;
@@ -1989,17 +2917,18 @@ void FlintExecution::run(void) {
         goto exception_handler;
     }
     op_new: {
-        uint16_t poolIndex = ARRAY_TO_INT16(&code[pc + 1]);
+        uint16_t poolIndex = CODE_TO_INT16(&code[pc + 1]);
         FlintConstUtf8 &constClass = method->classLoader.getConstUtf8Class(poolIndex);
-        FlintJavaObject &obj = flint.newObject(sizeof(FlintFieldsData), constClass);
-        memset(obj.data, 0, sizeof(FlintFieldsData));
         try {
             ClassData &classData = *(ClassData *)&flint.load(constClass);
+            uint32_t objectSize = flint.getObjectSize(classData);
+            FlintJavaObject &obj = flint.newObject(objectSize, constClass);
+            memset(obj.data, 0, objectSize);
             new ((FlintFieldsData *)obj.data)FlintFieldsData(flint, classData, false);
-            stackPushObject(&obj);
+            STACK_PUSH_OBJECT(&obj);
             pc += 3;
-            if((classData.staticFieldsData == 0) && ((int32_t)&classData.getStaticConstructor() != 0)) {
-                stackPushInt32((int32_t)&classData);
+            if(classData.initStatus != CLASS_INITIALIZED) {
+                STACK_PUSH_INT32((int32_t)&classData);
                 goto init_static_field;
             }
             goto *opcodes[code[pc]];
@@ -2010,36 +2939,36 @@ void FlintExecution::run(void) {
         }
     }
     op_newarray: {
-        int32_t count = stackPopInt32();
+        int32_t count = STACK_POP_INT32();
         if(count < 0)
             goto negative_array_size_excp;
         uint8_t atype = code[pc + 1];
         uint8_t typeSize = FlintJavaObject::getPrimitiveTypeSize(atype);
         FlintJavaObject &obj = flint.newObject(typeSize * count, *(FlintConstUtf8 *)primTypeConstUtf8List[atype - 4], 1);
         memset(obj.data, 0, obj.size);
-        stackPushObject(&obj);
+        STACK_PUSH_OBJECT(&obj);
         pc += 2;
         goto *opcodes[code[pc]];
     }
     op_anewarray: {
-        int32_t count = stackPopInt32();
+        int32_t count = STACK_POP_INT32();
         if(count < 0)
             goto negative_array_size_excp;
-        uint16_t poolIndex = ARRAY_TO_INT16(&code[pc + 1]);
+        uint16_t poolIndex = CODE_TO_INT16(&code[pc + 1]);
         FlintConstUtf8 &constClass = method->classLoader.getConstUtf8Class(poolIndex);
         FlintJavaObject &obj = flint.newObjectArray(constClass, count);
         memset(obj.data, 0, obj.size);
-        stackPushObject(&obj);
+        STACK_PUSH_OBJECT(&obj);
         pc += 3;
         goto *opcodes[code[pc]];
     }
     op_arraylength: {
-        FlintJavaObject *obj = stackPopObject();
+        FlintJavaObject *obj = STACK_POP_OBJECT();
         if(obj == 0) {
-            FlintJavaString &strObj = flint.newString(STR_AND_SIZE("Cannot read the array length from null object"));
+            const char *msg[] = {"Cannot read the array length from null object"};
             try {
-                FlintJavaThrowable &excpObj = flint.newNullPointerException(&strObj);
-                stackPushObject(&excpObj);
+                FlintJavaThrowable &excpObj = flint.newNullPointerException(msg, LENGTH(msg));
+                STACK_PUSH_OBJECT(&excpObj);
             }
             catch(FlintLoadFileError *file) {
                 fileNotFound = file;
@@ -2047,18 +2976,18 @@ void FlintExecution::run(void) {
             }
             goto exception_handler;
         }
-        stackPushInt32(obj->size / obj->parseTypeSize());
+        STACK_PUSH_INT32(obj->size / obj->parseTypeSize());
         pc++;
         goto *opcodes[code[pc]];
     }
     op_athrow: {
         FlintJavaObject *obj = (FlintJavaObject *)stack[sp];
         if(obj == 0) {
-            stackPopObject();
-            FlintJavaString &strObj = flint.newString(STR_AND_SIZE("Cannot throw exception by null object"));
+            sp--;
+            const char *msg[] = {"Cannot throw exception by null object"};
             try {
-                FlintJavaThrowable &excpObj = flint.newNullPointerException(&strObj);
-                stackPushObject(&excpObj);
+                FlintJavaThrowable &excpObj = flint.newNullPointerException(msg, LENGTH(msg));
+                STACK_PUSH_OBJECT(&excpObj);
             }
             catch(FlintLoadFileError *file) {
                 fileNotFound = file;
@@ -2069,26 +2998,50 @@ void FlintExecution::run(void) {
         goto exception_handler;
     }
     exception_handler: {
-        uint32_t tracePc = pc;
+#if FLINT_STACK_TRACE_DEPTH
+        /* VM exceptions and throwables whose constructor didn't fill the trace get the trace of their first throw */
+        FlintThrowableData *throwableData = ((FlintJavaThrowable *)stack[sp])->getThrowableData();
+        if(throwableData && !throwableData->isTraceFilled) {
+            SAVE_REGISTERS();
+            fillInStackTrace(false);
+        }
+#endif
+        uint32_t tracePc = getCodePc(*method, pc);
         int32_t traceStartSp = startSp;
         FlintMethodInfo *traceMethod = method;
-        FlintJavaObject *obj = stackPopObject();
+        FlintJavaObject *obj = STACK_POP_OBJECT();
+        SAVE_REGISTERS();
         if(dbg && dbg->exceptionIsEnabled())
             dbg->caughtException(this, (FlintJavaThrowable *)obj);
         while(1) {
             FlintCodeAttribute &attributeCode = traceMethod->getAttributeCode();
-            for(uint16_t i = 0; i < attributeCode.exceptionTableLength; i++) {
-                FlintExceptionTable &exceptionTable = attributeCode.getException(i);
-                if(exceptionTable.startPc <= tracePc && tracePc < exceptionTable.endPc) {
+            uint16_t handlersCount = 0;
+            const uint16_t *handlers = attributeCode.exceptionTableLength ? attributeCode.getHandlers(tracePc, handlersCount) : 0;
+            for(uint16_t i = 0; i < handlersCount; i++) {
+                FlintExceptionTable &exceptionTable = attributeCode.getException(handlers[i]);
+                /* catchType 0 is a finally block, it catches everything */
+                if(exceptionTable.catchType != 0 && exceptionTable.catchClass == 0) {
+                    /* Creating the thrown object loaded its whole superclass chain, so a catch type that is not loaded can't match */
                     FlintConstUtf8 &typeName = traceMethod->classLoader.getConstUtf8Class(exceptionTable.catchType);
-                    if(flint.isInstanceof(obj, typeName.text, typeName.length)) {
-                        while(startSp > traceStartSp)
-                            stackRestoreContext();
-                        sp = startSp + attributeCode.maxLocals;
-                        stackPushObject(obj);
-                        pc = exceptionTable.handlerPc;
-                        goto *opcodes[code[pc]];
+                    exceptionTable.catchClass = flint.findLoadedClass(typeName.text, typeName.length);
+                    if(exceptionTable.catchClass == 0)
+                        continue;
+                }
+                if(exceptionTable.catchType == 0 || flint.isSubclassOf(*(ClassData *)&obj->getFields().classLoader, *exceptionTable.catchClass)) {
+                    while(startSp > traceStartSp) {
+                        if(method->accessFlag & METHOD_STATIC)
+                            leaveStaticConstructor(false);
+                        stackRestoreContext();
                     }
+                    LOAD_REGISTERS();
+                    sp = startSp;
+                    STACK_PUSH_OBJECT(obj);
+                    pc = exceptionTable.handlerPc;
+#if FLINT_REGISTER_IR
+                    if(method->getAttributeCode().regCode)
+                        pc = method->getAttributeCode().getRegPc(pc) | REG_PC_FLAG;
+#endif
+                    RESUME_FRAME();
                 }
             }
             if(traceStartSp < 0) {
@@ -2097,48 +3050,27 @@ void FlintExecution::run(void) {
                 throw (FlintJavaThrowable *)obj;
             }
             traceMethod = (FlintMethodInfo *)stack[traceStartSp - 3];
-            tracePc = stack[traceStartSp - 2];
+            tracePc = getCodePc(*traceMethod, stack[traceStartSp - 2]);
             traceStartSp = stack[traceStartSp];
         }
     }
     op_checkcast: {
         FlintJavaObject *obj = (FlintJavaObject *)stack[sp];
-        FlintConstUtf8 &type = method->classLoader.getConstUtf8Class(ARRAY_TO_INT16(&code[pc + 1]));
+        FlintConstClassCache &cache = method->classLoader.getConstClassCache(CODE_TO_INT16(&code[pc + 1]));
+        FlintConstUtf8 &type = method->classLoader.getConstUtf8Class(CODE_TO_INT16(&code[pc + 1]));
         if(obj != 0) {
             bool isInsOf;
             try {
-                isInsOf = flint.isInstanceof(obj, type.text, type.length);
+                isInsOf = flint.isInstanceof(obj, type.text, type.length, cache);
             }
             catch(FlintLoadFileError *file) {
                 fileNotFound = file;
                 goto file_not_found_excp;
             }
             if(!isInsOf) {
-                uint32_t len = 7 + obj->type.length + 27 + type.length + 1;
-                bool isPrimType = FlintJavaObject::isPrimType(obj->type);
-                len += obj->dimensions;
-                if(!isPrimType)
-                    len += 2;
-                FlintJavaString &strObj = flint.newString(len, 0);
-                int8_t *strBuff = strObj.getValue()->getData();
-                memcpy(&strBuff[0], "Class '", 7);
-                uint32_t index = 7;
-                for(uint32_t i = 0; i < obj->dimensions; i++)
-                    strBuff[index++] = '[';
-                if(!isPrimType)
-                    strBuff[index++] = 'L';
-                memcpy(&strBuff[index], obj->type.text, obj->type.length);
-                index += obj->type.length;
-                if(!isPrimType)
-                    strBuff[index++] = ';';
-                memcpy(&strBuff[index], "' cannot be cast to class '", 27);
-                index += 27;
-                memcpy(&strBuff[index], type.text, type.length);
-                index += type.length;
-                strBuff[index] = '\'';
                 try {
-                    FlintJavaThrowable &excpObj = flint.newClassCastException(&strObj);
-                    stackPushObject(&excpObj);
+                    FlintJavaThrowable &excpObj = flint.newClassCastException(*obj, type);
+                    STACK_PUSH_OBJECT(&excpObj);
                 }
                 catch(FlintLoadFileError *file) {
                     fileNotFound = file;
@@ -2151,10 +3083,11 @@ void FlintExecution::run(void) {
         goto *opcodes[code[pc]];
     }
     op_instanceof: {
-        FlintJavaObject *obj = stackPopObject();
-        FlintConstUtf8 &type = method->classLoader.getConstUtf8Class(ARRAY_TO_INT16(&code[pc + 1]));
+        FlintJavaObject *obj = STACK_POP_OBJECT();
+        FlintConstClassCache &cache = method->classLoader.getConstClassCache(CODE_TO_INT16(&code[pc + 1]));
+        FlintConstUtf8 &type = method->classLoader.getConstUtf8Class(CODE_TO_INT16(&code[pc + 1]));
         try {
-            stackPushInt32(flint.isInstanceof(obj, type.text, type.length));
+            STACK_PUSH_INT32(flint.isInstanceof(obj, type.text, type.length, cache));
         }
         catch(FlintLoadFileError *file) {
             fileNotFound = file;
@@ -2164,12 +3097,12 @@ void FlintExecution::run(void) {
         goto *opcodes[code[pc]];
     }
     op_monitorenter: {
-        FlintJavaObject *obj = stackPopObject();
+        FlintJavaObject *obj = STACK_POP_OBJECT();
         if(obj == 0) {
-            FlintJavaString &strObj = flint.newString(STR_AND_SIZE("Cannot enter synchronized block by null object"));
+            const char *msg[] = {"Cannot enter synchronized block by null object"};
             try {
-                FlintJavaThrowable &excpObj = flint.newNullPointerException(&strObj);
-                stackPushObject(&excpObj);
+                FlintJavaThrowable &excpObj = flint.newNullPointerException(msg, LENGTH(msg));
+                STACK_PUSH_OBJECT(&excpObj);
             }
             catch(FlintLoadFileError *file) {
                 fileNotFound = file;
@@ -2196,7 +3129,7 @@ void FlintExecution::run(void) {
         goto *opcodes[code[pc]];
     }
     op_monitorexit: {
-        FlintJavaObject *obj = stackPopObject();
+        FlintJavaObject *obj = STACK_POP_OBJECT();
         Flint::lock();
         obj->monitorCount--;
         Flint::unlock();
@@ -2206,61 +3139,61 @@ void FlintExecution::run(void) {
     op_wide: {
         switch((FlintOpCode)code[pc + 1]) {
             case OP_IINC: {
-                uint16_t index = ARRAY_TO_INT16(&code[pc + 2]);
-                locals[index] += ARRAY_TO_INT16(&code[pc + 4]);
+                uint16_t index = CODE_TO_INT16(&code[pc + 2]);
+                locals[index] += CODE_TO_INT16(&code[pc + 4]);
                 pc += 6;
                 goto *opcodes[code[pc]];
             }
             case OP_ALOAD: {
-                uint16_t index = ARRAY_TO_INT16(&code[pc + 2]);
-                stackPushObject((FlintJavaObject *)locals[index]);
+                uint16_t index = CODE_TO_INT16(&code[pc + 2]);
+                STACK_PUSH_OBJECT((FlintJavaObject *)locals[index]);
                 pc += 4;
                 goto *opcodes[code[pc]];
             }
             case OP_FLOAD:
             case OP_ILOAD: {
-                uint16_t index = ARRAY_TO_INT16(&code[pc + 2]);
-                stackPushInt32(locals[index]);
+                uint16_t index = CODE_TO_INT16(&code[pc + 2]);
+                STACK_PUSH_INT32(locals[index]);
                 pc += 4;
                 goto *opcodes[code[pc]];
             }
             case OP_LLOAD:
             case OP_DLOAD: {
-                uint16_t index = ARRAY_TO_INT16(&code[pc + 2]);
-                stackPushInt64(*(int64_t *)&locals[index]);
+                uint16_t index = CODE_TO_INT16(&code[pc + 2]);
+                STACK_PUSH_INT64(*(int64_t *)&locals[index]);
                 pc += 4;
                 goto *opcodes[code[pc]];
             }
             case OP_ASTORE: {
-                uint16_t index = ARRAY_TO_INT16(&code[pc + 2]);
-                locals[index] = stackPopInt32();
+                uint16_t index = CODE_TO_INT16(&code[pc + 2]);
+                locals[index] = STACK_POP_INT32();
                 index = &locals[index] - stack;
-                stackType[index / 8] |= (1 << (index % 8));
+                SET_STACK_OBJECT(index);
                 pc += 4;
                 goto *opcodes[code[pc]];
             }
             case OP_FSTORE:
             case OP_ISTORE: {
-                uint16_t index = ARRAY_TO_INT16(&code[pc + 2]);
-                locals[index] = stackPopInt32();
+                uint16_t index = CODE_TO_INT16(&code[pc + 2]);
+                locals[index] = STACK_POP_INT32();
                 index = &locals[index] - stack;
-                stackType[index / 8] &= ~(1 << (index % 8));
+                CLEAR_STACK_OBJECT(index);
                 pc += 4;
                 goto *opcodes[code[pc]];
             }
             case OP_LSTORE:
             case OP_DSTORE: {
-                uint16_t index = ARRAY_TO_INT16(&code[pc + 2]);
-                *(uint64_t *)&locals[index] = stackPopInt64();
+                uint16_t index = CODE_TO_INT16(&code[pc + 2]);
+                *(uint64_t *)&locals[index] = STACK_POP_INT64();
                 index = &locals[index] - stack;
-                stackType[index / 8] &= ~(1 << (index % 8));
+                CLEAR_STACK_OBJECT(index);
                 index++;
-                stackType[index / 8] &= ~(1 << (index % 8));
+                CLEAR_STACK_OBJECT(index);
                 pc += 4;
                 goto *opcodes[code[pc]];
             }
             case OP_RET: {
-                uint16_t index = ARRAY_TO_INT16(&code[pc + 2]);
+                uint16_t index = CODE_TO_INT16(&code[pc + 2]);
                 pc = locals[index];
                 goto *opcodes[code[pc]];
             }
@@ -2269,7 +3202,7 @@ void FlintExecution::run(void) {
         }
     }
     op_multianewarray: {
-        FlintConstUtf8 *typeName = &method->classLoader.getConstUtf8Class(ARRAY_TO_INT16(&code[pc + 1]));
+        FlintConstUtf8 *typeName = &method->classLoader.getConstUtf8Class(CODE_TO_INT16(&code[pc + 1]));
         uint8_t dimensions = code[pc + 3];
         const char *typeNameText = typeName->text;
         uint32_t length = typeName->length - dimensions;
@@ -2288,7 +3221,7 @@ void FlintExecution::run(void) {
                     goto negative_array_size_excp;
             }
             FlintJavaObject &array = flint.newMultiArray(*typeName, &stack[sp], dimensions);
-            stackPushObject(&array);
+            STACK_PUSH_OBJECT(&array);
         }
         catch(FlintLoadFileError *file) {
             fileNotFound = file;
@@ -2303,24 +3236,49 @@ void FlintExecution::run(void) {
     op_unknow:
         throw "unknow opcode";
     init_static_field: {
-        ClassData &classDataToInit = *(ClassData *)stackPopInt32();
+        ClassData &classDataToInit = *(ClassData *)STACK_POP_INT32();
         Flint::lock();
-        if(classDataToInit.staticFieldsData) {
+        if(classDataToInit.initStatus == CLASS_INITIALIZING && classDataToInit.initOwnId != (uint32_t)this) {
+            /* Wait for the thread running <clinit> without holding the lock */
             Flint::unlock();
-            goto *opcodes[code[pc]];
+            FlintAPI::Thread::yield();
+            STACK_PUSH_INT32((int32_t)&classDataToInit);
+            goto init_static_field;
+        }
+        if(classDataToInit.initStatus != CLASS_UNINITIALIZED) {
+            Flint::unlock();
+            RESUME_FRAME();
         }
-        classDataToInit.isInitializing = 1;
-        flint.initStaticField(classDataToInit);
+        if(classDataToInit.staticFieldsData == 0)
+            flint.initStaticField(classDataToInit);
         FlintMethodInfo &ctorMethod = classDataToInit.getStaticConstructor();
+        if((int32_t)&ctorMethod == 0) {
+            classDataToInit.initStatus = CLASS_INITIALIZED;
+            Flint::unlock();
+            RESUME_FRAME();
+        }
+        classDataToInit.initOwnId = (uint32_t)this;
+        classDataToInit.initStatus = CLASS_INITIALIZING;
+        Flint::unlock();
+        int32_t callerSp = startSp;
         lr = pc;
-        invoke(ctorMethod, 0);
-        goto *opcodes[code[pc]];
+        SAVE_REGISTERS();
+        bool isInvoked = invoke(ctorMethod, 0);
+        LOAD_REGISTERS();
+        if(!isInvoked) {
+            endClassInit(classDataToInit, false);
+            goto pending_excp;
+        }
+        /* <clinit> that ran without a frame has already completed */
+        if(startSp == callerSp)
+            endClassInit(classDataToInit, true);
+        RESUME_FRAME();
     }
     divided_by_zero_excp: {
-        FlintJavaString &strObj = flint.newString(STR_AND_SIZE("Divided by zero"));
+        const char *msg[] = {"Divided by zero"};
         try {
-            FlintJavaThrowable &excpObj = flint.newArithmeticException(&strObj);
-            stackPushObject(&excpObj);
+            FlintJavaThrowable &excpObj = flint.newArithmeticException(msg, LENGTH(msg));
+            STACK_PUSH_OBJECT(&excpObj);
         }
         catch(FlintLoadFileError *file) {
             fileNotFound = file;
@@ -2329,10 +3287,10 @@ void FlintExecution::run(void) {
         goto exception_handler;
     }
     negative_array_size_excp: {
-        FlintJavaString &strObj = flint.newString(STR_AND_SIZE("Size of the array is a negative number"));
+        const char *msg[] = {"Size of the array is a negative number"};
         try {
-            FlintJavaThrowable &excpObj = flint.newNegativeArraySizeException(&strObj);
-            stackPushObject(&excpObj);
+            FlintJavaThrowable &excpObj = flint.newNegativeArraySizeException(msg, LENGTH(msg));
+            STACK_PUSH_OBJECT(&excpObj);
         }
         catch(FlintLoadFileError *file) {
             fileNotFound = file;
@@ -2341,10 +3299,10 @@ void FlintExecution::run(void) {
         goto exception_handler;
     }
     load_null_array_excp: {
-        FlintJavaString &strObj = flint.newString(STR_AND_SIZE("Cannot load from null array object"));
+        const char *msg[] = {"Cannot load from null array object"};
         try {
-            FlintJavaThrowable &excpObj = flint.newNullPointerException(&strObj);
-            stackPushObject(&excpObj);
+            FlintJavaThrowable &excpObj = flint.newNullPointerException(msg, LENGTH(msg));
+            STACK_PUSH_OBJECT(&excpObj);
         }
         catch(FlintLoadFileError *file) {
             fileNotFound = file;
@@ -2353,10 +3311,10 @@ void FlintExecution::run(void) {
         goto exception_handler;
     }
     store_null_array_excp: {
-        FlintJavaString &strObj = flint.newString(STR_AND_SIZE("Cannot store to null array object"));
+        const char *msg[] = {"Cannot store to null array object"};
         try {
-            FlintJavaThrowable &excpObj = flint.newNullPointerException(&strObj);
-            stackPushObject(&excpObj);
+            FlintJavaThrowable &excpObj = flint.newNullPointerException(msg, LENGTH(msg));
+            STACK_PUSH_OBJECT(&excpObj);
         }
         catch(FlintLoadFileError *file) {
             fileNotFound = file;
@@ -2364,14 +3322,591 @@ void FlintExecution::run(void) {
         }
         goto exception_handler;
     }
+    pending_excp: {
+        FlintJavaThrowable *excp = pendingException;
+        pendingException = 0;
+        STACK_PUSH_OBJECT(excp);
+        goto exception_handler;
+    }
     file_not_found_excp: {
         const char *msg[] = {"Could not find or load class ", fileNotFound->getFileName(), ".class"};
         FlintJavaString &strObj = flint.newString(msg, LENGTH(msg));
         FlintJavaThrowable &excpObj = flint.newClassNotFoundException(&strObj);
-        stackPushObject(&excpObj);
+        STACK_PUSH_OBJECT(&excpObj);
+        goto exception_handler;
+    }
+#if FLINT_REGISTER_IR
+    reg_resume:
+        regCode = method->getAttributeCode().regCode;
+        pc &= ~REG_PC_FLAG;
+        goto *regLabels[regCode[pc]];
+    reg_move: {
+        int32_t *dst = &locals[regCode[pc + 1]];
+        int32_t *src = &locals[regCode[pc + 2]];
+        *dst = *src;
+        if(IS_STACK_OBJECT(src - stack))
+            SET_STACK_OBJECT(dst - stack);
+        else
+            CLEAR_STACK_OBJECT(dst - stack);
+        REG_NEXT(3);
+    }
+    reg_const:
+        REG_SET_INT32(regCode[pc + 1], CODE_TO_INT32(&regCode[pc + 2]));
+        REG_NEXT(6);
+    reg_aldc: {
+        FlintConstPool &constPool = method->classLoader.getConstPool(CODE_TO_UINT16(&regCode[pc + 2]));
+        REG_SET_OBJECT(regCode[pc + 1], &method->classLoader.getConstString(flint, constPool));
+        REG_NEXT(4);
+    }
+    reg_iadd:
+        REG_SET_INT32(regCode[pc + 1], locals[regCode[pc + 2]] + locals[regCode[pc + 3]]);
+        REG_NEXT(4);
+    reg_isub:
+        REG_SET_INT32(regCode[pc + 1], locals[regCode[pc + 2]] - locals[regCode[pc + 3]]);
+        REG_NEXT(4);
+    reg_imul:
+        REG_SET_INT32(regCode[pc + 1], locals[regCode[pc + 2]] * locals[regCode[pc + 3]]);
+        REG_NEXT(4);
+    reg_idiv: {
+        int32_t value2 = locals[regCode[pc + 3]];
+        if(value2 == 0)
+            REG_THROW(divided_by_zero_excp);
+        REG_SET_INT32(regCode[pc + 1], locals[regCode[pc + 2]] / value2);
+        REG_NEXT(4);
+    }
+    reg_irem: {
+        int32_t value2 = locals[regCode[pc + 3]];
+        if(value2 == 0)
+            REG_THROW(divided_by_zero_excp);
+        REG_SET_INT32(regCode[pc + 1], locals[regCode[pc + 2]] % value2);
+        REG_NEXT(4);
+    }
+    reg_iand:
+        REG_SET_INT32(regCode[pc + 1], locals[regCode[pc + 2]] & locals[regCode[pc + 3]]);
+        REG_NEXT(4);
+    reg_ior:
+        REG_SET_INT32(regCode[pc + 1], locals[regCode[pc + 2]] | locals[regCode[pc + 3]]);
+        REG_NEXT(4);
+    reg_ixor:
+        REG_SET_INT32(regCode[pc + 1], locals[regCode[pc + 2]] ^ locals[regCode[pc + 3]]);
+        REG_NEXT(4);
+    reg_ishl:
+        REG_SET_INT32(regCode[pc + 1], locals[regCode[pc + 2]] << (locals[regCode[pc + 3]] & 0x1F));
+        REG_NEXT(4);
+    reg_ishr:
+        REG_SET_INT32(regCode[pc + 1], locals[regCode[pc + 2]] >> (locals[regCode[pc + 3]] & 0x1F));
+        REG_NEXT(4);
+    reg_iushr:
+        REG_SET_INT32(regCode[pc + 1], (uint32_t)locals[regCode[pc + 2]] >> (locals[regCode[pc + 3]] & 0x1F));
+        REG_NEXT(4);
+    reg_fadd:
+        REG_SET_FLOAT(regCode[pc + 1], REG_FLOAT(regCode[pc + 2]) + REG_FLOAT(regCode[pc + 3]));
+        REG_NEXT(4);
+    reg_fsub:
+        REG_SET_FLOAT(regCode[pc + 1], REG_FLOAT(regCode[pc + 2]) - REG_FLOAT(regCode[pc + 3]));
+        REG_NEXT(4);
+    reg_fmul:
+        REG_SET_FLOAT(regCode[pc + 1], REG_FLOAT(regCode[pc + 2]) * REG_FLOAT(regCode[pc + 3]));
+        REG_NEXT(4);
+    reg_fdiv:
+        REG_SET_FLOAT(regCode[pc + 1], REG_FLOAT(regCode[pc + 2]) / REG_FLOAT(regCode[pc + 3]));
+        REG_NEXT(4);
+    reg_fcmpl:
+    reg_fcmpg: {
+        float value1 = REG_FLOAT(regCode[pc + 2]);
+        float value2 = REG_FLOAT(regCode[pc + 3]);
+        int32_t value;
+        if((*(uint32_t *)&value1 == FLOAT_NAN) || (*(uint32_t *)&value2 == FLOAT_NAN))
+            value = (regCode[pc] == REG_FCMPL) ? -1 : 1;
+        else if(value1 > value2)
+            value = 1;
+        else if(value1 == value2)
+            value = 0;
+        else
+            value = -1;
+        REG_SET_INT32(regCode[pc + 1], value);
+        REG_NEXT(4);
+    }
+    reg_iadd_imm:
+        REG_SET_INT32(regCode[pc + 1], locals[regCode[pc + 2]] + CODE_TO_INT16(&regCode[pc + 3]));
+        REG_NEXT(5);
+    reg_ineg:
+        REG_SET_INT32(regCode[pc + 1], -locals[regCode[pc + 2]]);
+        REG_NEXT(3);
+    reg_fneg:
+        REG_SET_FLOAT(regCode[pc + 1], -REG_FLOAT(regCode[pc + 2]));
+        REG_NEXT(3);
+    reg_i2f:
+        REG_SET_FLOAT(regCode[pc + 1], (float)locals[regCode[pc + 2]]);
+        REG_NEXT(3);
+    reg_f2i:
+        REG_SET_INT32(regCode[pc + 1], (int32_t)REG_FLOAT(regCode[pc + 2]));
+        REG_NEXT(3);
+    reg_i2b:
+        REG_SET_INT32(regCode[pc + 1], (int8_t)locals[regCode[pc + 2]]);
+        REG_NEXT(3);
+    reg_i2c:
+        REG_SET_INT32(regCode[pc + 1], (uint16_t)locals[regCode[pc + 2]]);
+        REG_NEXT(3);
+    reg_i2s:
+        REG_SET_INT32(regCode[pc + 1], (int16_t)locals[regCode[pc + 2]]);
+        REG_NEXT(3);
+    reg_ifeq:
+        if(locals[regCode[pc + 1]] == 0)
+            REG_JUMP(CODE_TO_UINT16(&regCode[pc + 2]));
+        REG_NEXT(4);
+    reg_ifne:
+        if(locals[regCode[pc + 1]] != 0)
+            REG_JUMP(CODE_TO_UINT16(&regCode[pc + 2]));
+        REG_NEXT(4);
+    reg_iflt:
+        if(locals[regCode[pc + 1]] < 0)
+            REG_JUMP(CODE_TO_UINT16(&regCode[pc + 2]));
+        REG_NEXT(4);
+    reg_ifge:
+        if(locals[regCode[pc + 1]] >= 0)
+            REG_JUMP(CODE_TO_UINT16(&regCode[pc + 2]));
+        REG_NEXT(4);
+    reg_ifgt:
+        if(locals[regCode[pc + 1]] > 0)
+            REG_JUMP(CODE_TO_UINT16(&regCode[pc + 2]));
+        REG_NEXT(4);
+    reg_ifle:
+        if(locals[regCode[pc + 1]] <= 0)
+            REG_JUMP(CODE_TO_UINT16(&regCode[pc + 2]));
+        REG_NEXT(4);
+    reg_if_icmpeq:
+        if(locals[regCode[pc + 1]] == locals[regCode[pc + 2]])
+            REG_JUMP(CODE_TO_UINT16(&regCode[pc + 3]));
+        REG_NEXT(5);
+    reg_if_icmpne:
+        if(locals[regCode[pc + 1]] != locals[regCode[pc + 2]])
+            REG_JUMP(CODE_TO_UINT16(&regCode[pc + 3]));
+        REG_NEXT(5);
+    reg_if_icmplt:
+        if(locals[regCode[pc + 1]] < locals[regCode[pc + 2]])
+            REG_JUMP(CODE_TO_UINT16(&regCode[pc + 3]));
+        REG_NEXT(5);
+    reg_if_icmpge:
+        if(locals[regCode[pc + 1]] >= locals[regCode[pc + 2]])
+            REG_JUMP(CODE_TO_UINT16(&regCode[pc + 3]));
+        REG_NEXT(5);
+    reg_if_icmpgt:
+        if(locals[regCode[pc + 1]] > locals[regCode[pc + 2]])
+            REG_JUMP(CODE_TO_UINT16(&regCode[pc + 3]));
+        REG_NEXT(5);
+    reg_if_icmple:
+        if(locals[regCode[pc + 1]] <= locals[regCode[pc + 2]])
+            REG_JUMP(CODE_TO_UINT16(&regCode[pc + 3]));
+        REG_NEXT(5);
+    reg_goto:
+        REG_JUMP(CODE_TO_UINT16(&regCode[pc + 1]));
+    reg_tableswitch: {
+        int32_t index = locals[regCode[pc + 1]];
+        int32_t low = CODE_TO_INT32(&regCode[pc + 4]);
+        int32_t high = CODE_TO_INT32(&regCode[pc + 8]);
+        if(index < low || index > high)
+            REG_JUMP(CODE_TO_UINT16(&regCode[pc + 2]));
+        REG_JUMP(CODE_TO_UINT16(&regCode[pc + 12 + (index - low) * 2]));
+    }
+    reg_lookupswitch: {
+        int32_t key = locals[regCode[pc + 1]];
+        const uint8_t *pairs = &regCode[pc + 6];
+        int32_t low = 0;
+        int32_t high = CODE_TO_UINT16(&regCode[pc + 4]) - 1;
+        while(low <= high) {
+            int32_t mid = (low + high) >> 1;
+            int32_t midKey = CODE_TO_INT32(&pairs[mid * 6]);
+            if(midKey < key)
+                low = mid + 1;
+            else if(midKey > key)
+                high = mid - 1;
+            else
+                REG_JUMP(CODE_TO_UINT16(&pairs[mid * 6 + 4]));
+        }
+        REG_JUMP(CODE_TO_UINT16(&regCode[pc + 2]));
+    }
+    reg_iaload:
+    reg_aaload: {
+        FlintJavaObject *obj = REG_OBJECT(regCode[pc + 2]);
+        if(obj == 0)
+            REG_THROW(load_null_array_excp);
+        arrayIndex = locals[regCode[pc + 3]];
+        arrayLength = obj->size / sizeof(int32_t);
+        if((uint32_t)arrayIndex >= (uint32_t)arrayLength)
+            goto reg_array_index_excp;
+        if(regCode[pc] == REG_AALOAD)
+            REG_SET_OBJECT(regCode[pc + 1], ((FlintJavaObject **)obj->data)[arrayIndex]);
+        else
+            REG_SET_INT32(regCode[pc + 1], ((int32_t *)obj->data)[arrayIndex]);
+        REG_NEXT(4);
+    }
+    reg_baload: {
+        FlintJavaObject *obj = REG_OBJECT(regCode[pc + 2]);
+        if(obj == 0)
+            REG_THROW(load_null_array_excp);
+        arrayIndex = locals[regCode[pc + 3]];
+        arrayLength = obj->size;
+        if((uint32_t)arrayIndex >= (uint32_t)arrayLength)
+            goto reg_array_index_excp;
+        REG_SET_INT32(regCode[pc + 1], ((int8_t *)obj->data)[arrayIndex]);
+        REG_NEXT(4);
+    }
+    reg_caload:
+    reg_saload: {
+        FlintJavaObject *obj = REG_OBJECT(regCode[pc + 2]);
+        if(obj == 0)
+            REG_THROW(load_null_array_excp);
+        arrayIndex = locals[regCode[pc + 3]];
+        arrayLength = obj->size / sizeof(int16_t);
+        if((uint32_t)arrayIndex >= (uint32_t)arrayLength)
+            goto reg_array_index_excp;
+        if(regCode[pc] == REG_CALOAD)
+            REG_SET_INT32(regCode[pc + 1], ((uint16_t *)obj->data)[arrayIndex]);
+        else
+            REG_SET_INT32(regCode[pc + 1], ((int16_t *)obj->data)[arrayIndex]);
+        REG_NEXT(4);
+    }
+    reg_iastore:
+    reg_aastore: {
+        FlintJavaObject *obj = REG_OBJECT(regCode[pc + 1]);
+        if(obj == 0)
+            REG_THROW(store_null_array_excp);
+        arrayIndex = locals[regCode[pc + 2]];
+        arrayLength = obj->size / sizeof(int32_t);
+        if((uint32_t)arrayIndex >= (uint32_t)arrayLength)
+            goto reg_array_index_excp;
+        ((int32_t *)obj->data)[arrayIndex] = locals[regCode[pc + 3]];
+        REG_NEXT(4);
+    }
+    reg_bastore: {
+        FlintJavaObject *obj = REG_OBJECT(regCode[pc + 1]);
+        if(obj == 0)
+            REG_THROW(store_null_array_excp);
+        arrayIndex = locals[regCode[pc + 2]];
+        arrayLength = obj->size;
+        if((uint32_t)arrayIndex >= (uint32_t)arrayLength)
+            goto reg_array_index_excp;
+        ((int8_t *)obj->data)[arrayIndex] = locals[regCode[pc + 3]];
+        REG_NEXT(4);
+    }
+    reg_castore: {
+        FlintJavaObject *obj = REG_OBJECT(regCode[pc + 1]);
+        if(obj == 0)
+            REG_THROW(store_null_array_excp);
+        arrayIndex = locals[regCode[pc + 2]];
+        arrayLength = obj->size / sizeof(int16_t);
+        if((uint32_t)arrayIndex >= (uint32_t)arrayLength)
+            goto reg_array_index_excp;
+        ((int16_t *)obj->data)[arrayIndex] = locals[regCode[pc + 3]];
+        REG_NEXT(4);
+    }
+    reg_array_index_excp: {
+        pc = method->getAttributeCode().getCodePc(pc);
+        sp = startSp;
+        try {
+            FlintJavaThrowable &excpObj = flint.newArrayIndexOutOfBoundsException(arrayIndex, arrayLength);
+            STACK_PUSH_OBJECT(&excpObj);
+        }
+        catch(FlintLoadFileError *file) {
+            fileNotFound = file;
+            goto file_not_found_excp;
+        }
         goto exception_handler;
     }
+    reg_arraylength: {
+        FlintJavaObject *obj = REG_OBJECT(regCode[pc + 2]);
+        if(obj == 0) {
+            /* The stack code raises the exception from the null it pops */
+            pc = method->getAttributeCode().getCodePc(pc);
+            sp = startSp;
+            STACK_PUSH_OBJECT(obj);
+            goto op_arraylength;
+        }
+        REG_SET_INT32(regCode[pc + 1], obj->size / obj->parseTypeSize());
+        REG_NEXT(3);
+    }
+    reg_igetfield:
+    reg_agetfield: {
+        FlintConstField &constField = *(FlintConstField *)method->classLoader.getConstPool(CODE_TO_UINT16(&regCode[pc + 3])).value;
+        FlintJavaObject *obj = REG_OBJECT(regCode[pc + 2]);
+        if(obj == 0)
+            REG_THROW(getfield_quick_null_excp);
+        FlintFieldsData &fields = *(FlintFieldsData *)obj->data;
+        if(regCode[pc] == REG_AGETFIELD) {
+            if(constField.fieldIndex == 0)
+                fields.getFieldObject(constField);
+            if(constField.fieldIndex == 0)
+                throw "field could not be found";
+            REG_SET_OBJECT(regCode[pc + 1], fields.fieldsObject[constField.fieldIndex & 0x7FFFFFFF].object);
+        }
+        else {
+            if(constField.fieldIndex == 0)
+                fields.getFieldData32(constField);
+            if(constField.fieldIndex == 0)
+                throw "field could not be found";
+            REG_SET_INT32(regCode[pc + 1], fields.fieldsData32[constField.fieldIndex & 0x7FFFFFFF].value);
+        }
+        REG_NEXT(5);
+    }
+    reg_iputfield:
+    reg_bputfield:
+    reg_sputfield:
+    reg_aputfield: {
+        FlintConstField &constField = *(FlintConstField *)method->classLoader.getConstPool(CODE_TO_UINT16(&regCode[pc + 3])).value;
+        FlintJavaObject *obj = REG_OBJECT(regCode[pc + 1]);
+        int32_t value = locals[regCode[pc + 2]];
+        if(obj == 0)
+            REG_THROW(putfield_quick_null_excp);
+        FlintFieldsData &fields = *(FlintFieldsData *)obj->data;
+        if(regCode[pc] == REG_APUTFIELD) {
+            if(constField.fieldIndex == 0)
+                fields.getFieldObject(constField);
+            if(constField.fieldIndex == 0)
+                throw "field could not be found";
+            fields.fieldsObject[constField.fieldIndex & 0x7FFFFFFF].object = (FlintJavaObject *)value;
+        }
+        else {
+            if(constField.fieldIndex == 0)
+                fields.getFieldData32(constField);
+            if(constField.fieldIndex == 0)
+                throw "field could not be found";
+            if(regCode[pc] == REG_BPUTFIELD)
+                value = (int8_t)value;
+            else if(regCode[pc] == REG_SPUTFIELD)
+                value = (int16_t)value;
+            fields.fieldsData32[constField.fieldIndex & 0x7FFFFFFF].value = value;
+        }
+        REG_NEXT(5);
+    }
+    reg_getstatic:
+    reg_putstatic: {
+        uint8_t isPut = (regCode[pc] == REG_PUTSTATIC);
+        FlintConstField &constField = method->classLoader.getConstField(CODE_TO_UINT16(&regCode[pc + 2]));
+        ClassData *classData;
+        try {
+            classData = (ClassData *)&flint.load(constField.className);
+        }
+        catch(FlintLoadFileError *file) {
+            fileNotFound = file;
+            REG_THROW(file_not_found_excp);
+        }
+        if(!isClassInitialized(*classData)) {
+            /* <clinit> runs above the whole frame and the instruction runs again when it returns */
+            pc |= REG_PC_FLAG;
+            sp = startSp + method->getAttributeCode().maxStack;
+            STACK_PUSH_INT32((int32_t)classData);
+            goto init_static_field;
+        }
+        FlintFieldsData &fields = *classData->staticFieldsData;
+        uint8_t quickOpCode;
+        switch(constField.nameAndType.descriptor.text[0]) {
+            case 'Z':
+            case 'B':
+                constField.staticValue = &fields.getFieldData32(constField).value;
+                quickOpCode = isPut ? REG_BPUTSTATIC_QUICK : REG_IGETSTATIC_QUICK;
+                break;
+            case 'C':
+            case 'S':
+                constField.staticValue = &fields.getFieldData32(constField).value;
+                quickOpCode = isPut ? REG_SPUTSTATIC_QUICK : REG_IGETSTATIC_QUICK;
+                break;
+            case 'L':
+            case '[':
+                constField.staticValue = &fields.getFieldObject(constField).object;
+                quickOpCode = isPut ? REG_APUTSTATIC_QUICK : REG_AGETSTATIC_QUICK;
+                break;
+            default:
+                constField.staticValue = &fields.getFieldData32(constField).value;
+                quickOpCode = isPut ? REG_IPUTSTATIC_QUICK : REG_IGETSTATIC_QUICK;
+                break;
+        }
+        if(constField.fieldIndex == 0)
+            throw "field could not be found";
+        if(classData->initStatus == CLASS_INITIALIZED)
+            quickenOpCode(&regCode[pc], quickOpCode);
+        goto *regLabels[quickOpCode];
+    }
+    reg_igetstatic_quick: {
+        FlintConstField &constField = *(FlintConstField *)method->classLoader.getConstPool(CODE_TO_UINT16(&regCode[pc + 2])).value;
+        REG_SET_INT32(regCode[pc + 1], *(int32_t *)constField.staticValue);
+        REG_NEXT(4);
+    }
+    reg_agetstatic_quick: {
+        FlintConstField &constField = *(FlintConstField *)method->classLoader.getConstPool(CODE_TO_UINT16(&regCode[pc + 2])).value;
+        REG_SET_OBJECT(regCode[pc + 1], *(FlintJavaObject **)constField.staticValue);
+        REG_NEXT(4);
+    }
+    reg_iputstatic_quick:
+    reg_aputstatic_quick: {
+        FlintConstField &constField = *(FlintConstField *)method->classLoader.getConstPool(CODE_TO_UINT16(&regCode[pc + 2])).value;
+        *(int32_t *)constField.staticValue = locals[regCode[pc + 1]];
+        REG_NEXT(4);
+    }
+    reg_bputstatic_quick: {
+        FlintConstField &constField = *(FlintConstField *)method->classLoader.getConstPool(CODE_TO_UINT16(&regCode[pc + 2])).value;
+        *(int32_t *)constField.staticValue = (int8_t)locals[regCode[pc + 1]];
+        REG_NEXT(4);
+    }
+    reg_sputstatic_quick: {
+        FlintConstField &constField = *(FlintConstField *)method->classLoader.getConstPool(CODE_TO_UINT16(&regCode[pc + 2])).value;
+        *(int32_t *)constField.staticValue = (int16_t)locals[regCode[pc + 1]];
+        REG_NEXT(4);
+    }
+    reg_new: {
+        FlintConstUtf8 &constClass = method->classLoader.getConstUtf8Class(CODE_TO_UINT16(&regCode[pc + 2]));
+        try {
+            ClassData &classData = *(ClassData *)&flint.load(constClass);
+            uint32_t objectSize = flint.getObjectSize(classData);
+            FlintJavaObject &obj = flint.newObject(objectSize, constClass);
+            memset(obj.data, 0, objectSize);
+            new ((FlintFieldsData *)obj.data)FlintFieldsData(flint, classData, false);
+            REG_SET_OBJECT(regCode[pc + 1], &obj);
+            pc += 4;
+            if(classData.initStatus != CLASS_INITIALIZED) {
+                pc |= REG_PC_FLAG;
+                sp = startSp + method->getAttributeCode().maxStack;
+                STACK_PUSH_INT32((int32_t)&classData);
+                goto init_static_field;
+            }
+            goto *regLabels[regCode[pc]];
+        }
+        catch(FlintLoadFileError *file) {
+            fileNotFound = file;
+            REG_THROW(file_not_found_excp);
+        }
+    }
+    reg_newarray: {
+        int32_t count = locals[regCode[pc + 2]];
+        if(count < 0)
+            REG_THROW(negative_array_size_excp);
+        uint8_t atype = regCode[pc + 3];
+        uint8_t typeSize = FlintJavaObject::getPrimitiveTypeSize(atype);
+        FlintJavaObject &obj = flint.newObject(typeSize * count, *(FlintConstUtf8 *)primTypeConstUtf8List[atype - 4], 1);
+        memset(obj.data, 0, obj.size);
+        REG_SET_OBJECT(regCode[pc + 1], &obj);
+        REG_NEXT(4);
+    }
+    reg_anewarray: {
+        int32_t count = locals[regCode[pc + 2]];
+        if(count < 0)
+            REG_THROW(negative_array_size_excp);
+        FlintConstUtf8 &constClass = method->classLoader.getConstUtf8Class(CODE_TO_UINT16(&regCode[pc + 3]));
+        FlintJavaObject &obj = flint.newObjectArray(constClass, count);
+        memset(obj.data, 0, obj.size);
+        REG_SET_OBJECT(regCode[pc + 1], &obj);
+        REG_NEXT(5);
+    }
+    reg_checkcast: {
+        FlintJavaObject *obj = REG_OBJECT(regCode[pc + 1]);
+        if(obj != 0) {
+            FlintConstClassCache &cache = method->classLoader.getConstClassCache(CODE_TO_UINT16(&regCode[pc + 2]));
+            FlintConstUtf8 &type = method->classLoader.getConstUtf8Class(CODE_TO_UINT16(&regCode[pc + 2]));
+            bool isInsOf;
+            try {
+                isInsOf = flint.isInstanceof(obj, type.text, type.length, cache);
+            }
+            catch(FlintLoadFileError *file) {
+                fileNotFound = file;
+                REG_THROW(file_not_found_excp);
+            }
+            if(!isInsOf) {
+                /* The stack code raises the exception from the object it peeks */
+                pc = method->getAttributeCode().getCodePc(pc);
+                sp = startSp;
+                STACK_PUSH_OBJECT(obj);
+                goto op_checkcast;
+            }
+        }
+        REG_NEXT(4);
+    }
+    reg_instanceof: {
+        FlintJavaObject *obj = REG_OBJECT(regCode[pc + 2]);
+        FlintConstClassCache &cache = method->classLoader.getConstClassCache(CODE_TO_UINT16(&regCode[pc + 3]));
+        FlintConstUtf8 &type = method->classLoader.getConstUtf8Class(CODE_TO_UINT16(&regCode[pc + 3]));
+        int32_t isInsOf;
+        try {
+            isInsOf = flint.isInstanceof(obj, type.text, type.length, cache);
+        }
+        catch(FlintLoadFileError *file) {
+            fileNotFound = file;
+            REG_THROW(file_not_found_excp);
+        }
+        REG_SET_INT32(regCode[pc + 1], isInsOf);
+        REG_NEXT(5);
+    }
+    reg_invokevirtual:
+    reg_invokespecial:
+    reg_invokestatic:
+    reg_invokeinterface: {
+        FlintConstMethod &constMethod = *(FlintConstMethod *)method->classLoader.getConstPool(CODE_TO_UINT16(&regCode[pc + 2])).value;
+        uint8_t opcode = regCode[pc];
+        /* The arguments end at the last argument register, the callee frame starts above them */
+        sp = (locals - stack) + regCode[pc + 1];
+        if(opcode == REG_INVOKEINTERFACE)
+            lr = (pc + 5) | REG_PC_FLAG;
+        else
+            lr = (pc + 4) | REG_PC_FLAG;
+        pc |= REG_PC_FLAG;
+        SAVE_REGISTERS();
+        bool isInvoked;
+        if(opcode == REG_INVOKEVIRTUAL)
+            isInvoked = invokeVirtual(constMethod);
+        else if(opcode == REG_INVOKESPECIAL)
+            isInvoked = invokeSpecial(constMethod);
+        else if(opcode == REG_INVOKEINTERFACE)
+            isInvoked = invokeInterface(constMethod, regCode[(pc & ~REG_PC_FLAG) + 4]);
+        else {
+            FlintMethodInfo *methodInfo = resolveMethod(constMethod);
+            if(methodInfo) {
+                ClassData &classData = *(ClassData *)&methodInfo->classLoader;
+                if(!isClassInitialized(classData)) {
+                    STACK_PUSH_INT32((int32_t)&classData);
+                    goto init_static_field;
+                }
+            }
+            isInvoked = methodInfo && invokeStatic(constMethod);
+        }
+        LOAD_REGISTERS();
+        if(!isInvoked)
+            goto pending_excp;
+        RESUME_FRAME();
+    }
+    reg_ireturn: {
+        int32_t retVal = locals[regCode[pc + 1]];
+        stackRestoreContext();
+        LOAD_REGISTERS();
+        STACK_PUSH_INT32(retVal);
+        pc = lr;
+        RESUME_FRAME();
+    }
+    reg_areturn: {
+        int32_t retVal = locals[regCode[pc + 1]];
+        stackRestoreContext();
+        LOAD_REGISTERS();
+        STACK_PUSH_OBJECT((FlintJavaObject *)retVal);
+        pc = lr;
+        RESUME_FRAME();
+    }
+    reg_return: {
+        if(method->accessFlag & METHOD_STATIC)
+            leaveStaticConstructor(true);
+        stackRestoreContext();
+        LOAD_REGISTERS();
+        pc = lr;
+        RESUME_FRAME();
+    }
+    reg_athrow: {
+        /* The stack code raises the object or the exception for a null object */
+        FlintJavaObject *obj = REG_OBJECT(regCode[pc + 1]);
+        pc = method->getAttributeCode().getCodePc(pc);
+        sp = startSp;
+        STACK_PUSH_OBJECT(obj);
+        goto op_athrow;
+    }
+#endif
     op_exit:
+        SAVE_REGISTERS();
         return;
 }
 
@@ -2380,12 +3915,19 @@ void FlintExecution::innerRunTask(FlintExecution *execution) {
         execution->run();
     }
     catch(FlintJavaThrowable *ex) {
-        FlintJavaString *str = ex->getDetailMessage();
+        FlintJavaString *str;
+        try {
+            str = ex->getDetailMessage();
+        }
+        catch(...) {
+            str = 0;
+        }
         if(str)
             execution->flint.print(str->getText(), str->getLength(), str->getCoder());
         else
             execution->flint.print(ex->type.text, ex->type.length, 0);
         execution->flint.print("\n", 1, 0);
+        printStackTrace(execution->flint, *ex);
     }
     catch(FlintOutOfMemoryError *err) {
         const char *msg = err->getMessage();
@@ -2405,14 +3947,9 @@ void FlintExecution::innerRunTask(FlintExecution *execution) {
         execution->flint.print(msg, strlen(msg), 0);
         execution->flint.print("\n", 1, 0);
     }
-    while(execution->startSp > 3) {
-        if((execution->method->accessFlag & METHOD_STATIC) == METHOD_STATIC) {
-            ClassData &classData = *(ClassData *)&execution->method->classLoader;
-            if(classData.isInitializing) {
-                classData.isInitializing = 0;
-                Flint::unlock();
-            }
-        }
+    while(execution->startSp >= 0 && execution->stack[execution->startSp] >= 0) {
+        if(execution->method->accessFlag & METHOD_STATIC)
+            execution->leaveStaticConstructor(false);
         execution->stackRestoreContext();
     }
     execution->peakSp = -1;
@@ -2450,5 +3987,6 @@ FlintJavaThread &FlintExecution::getOnwerThread(void) {
 
 FlintExecution::~FlintExecution(void) {
     Flint::free(stack);
-    Flint::free(stackType);
+    if(stackType)
+        Flint::free(stackType);
 }
@@ -17,7 +17,7 @@ FlintFieldObject::FlintFieldObject(const FlintFieldInfo &fieldInfo) : fieldInfo(
 }
 
 FlintFieldsData::FlintFieldsData(Flint &flint, const FlintClassLoader &classLoader, bool isStatic) :
-fields32Count(0), fields64Count(0), fieldsObjCount(0) {
+fields32Count(0), fields64Count(0), fieldsObjCount(0), classLoader(classLoader) {
     if(isStatic)
         loadStatic(classLoader);
     else
@@ -287,32 +287,84 @@ void ClassData::clearStaticFields(void) {
         Flint::free(staticFieldsData);
         staticFieldsData = 0;
     }
+    /* <clinit> runs again when the class is used after a restart */
+    initStatus = CLASS_UNINITIALIZED;
+    initOwnId = 0;
 }
 
 ClassData::~ClassData() {
     clearStaticFields();
+    if(vtable)
+        Flint::free(vtable);
+    if(superDisplay)
+        Flint::free(superDisplay);
+    if(interfaceBits)
+        Flint::free(interfaceBits);
+    if(itable) {
+        for(uint16_t i = 0; i < itableSize; i++) {
+            if(itable[i].methods)
+                Flint::free(itable[i].methods);
+        }
+        Flint::free(itable);
+    }
 }
 
 ClassData::ClassData(Flint &flint, const char *fileName) : FlintClassLoader(flint, fileName) {
     ownId = 0;
     monitorCount = 0;
-    isInitializing = 0;
+    initOwnId = 0;
+    initStatus = CLASS_UNINITIALIZED;
     staticFieldsData = 0;
+    vtable = 0;
+    vtableSize = 0;
+    itable = 0;
+    itableSize = 0;
+    superDepth = 0;
+    interfaceId = 0;
+    interfaceWords = 0;
+    superDisplay = 0;
+    interfaceBits = 0;
+    objectSize = 0;
+    isStackTraceDisabled = false;
     next = 0;
 }
 
 ClassData::ClassData(Flint &flint, const char *fileName, uint16_t length) : FlintClassLoader(flint, fileName, length) {
     ownId = 0;
     monitorCount = 0;
-    isInitializing = 0;
+    initOwnId = 0;
+    initStatus = CLASS_UNINITIALIZED;
     staticFieldsData = 0;
+    vtable = 0;
+    vtableSize = 0;
+    itable = 0;
+    itableSize = 0;
+    superDepth = 0;
+    interfaceId = 0;
+    interfaceWords = 0;
+    superDisplay = 0;
+    interfaceBits = 0;
+    objectSize = 0;
+    isStackTraceDisabled = false;
     next = 0;
 }
 
 ClassData::ClassData(Flint &flint, const FlintConstUtf8 &fileName) : FlintClassLoader(flint, fileName) {
     ownId = 0;
     monitorCount = 0;
-    isInitializing = 0;
+    initOwnId = 0;
+    initStatus = CLASS_UNINITIALIZED;
     staticFieldsData = 0;
+    vtable = 0;
+    vtableSize = 0;
+    itable = 0;
+    itableSize = 0;
+    superDepth = 0;
+    interfaceId = 0;
+    interfaceWords = 0;
+    superDisplay = 0;
+    interfaceBits = 0;
+    objectSize = 0;
+    isStackTraceDisabled = false;
     next = 0;
 }
@@ -0,0 +1,68 @@
+
+#include "flint.h"
+#include "flint_inline_cache.h"
+
+#if FLINT_INLINE_CACHE_SIZE
+
+FlintInlineCache::FlintInlineCache(void) : count(0) {
+#if FLINT_INLINE_CACHE_PROFILE
+    hitCount = 0;
+    missCount = 0;
+#endif
+}
+
+bool FlintInlineCache::isMegamorphic(void) const {
+    return count == INLINE_CACHE_MEGAMORPHIC;
+}
+
+uint32_t FlintInlineCache::getHitCount(void) const {
+#if FLINT_INLINE_CACHE_PROFILE
+    return hitCount;
+#else
+    return 0;
+#endif
+}
+
+uint32_t FlintInlineCache::getMissCount(void) const {
+#if FLINT_INLINE_CACHE_PROFILE
+    return missCount;
+#else
+    return 0;
+#endif
+}
+
+FlintMethodInfo *FlintInlineCache::find(const FlintClassLoader *receiverClass) {
+    if(count != INLINE_CACHE_MEGAMORPHIC) {
+        for(uint8_t i = 0; i < count; i++) {
+            if(this->receiverClass[i] == receiverClass) {
+#if FLINT_INLINE_CACHE_PROFILE
+                hitCount++;
+#endif
+                return methodInfo[i];
+            }
+        }
+    }
+#if FLINT_INLINE_CACHE_PROFILE
+    missCount++;
+#endif
+    return 0;
+}
+
+void FlintInlineCache::add(const FlintClassLoader *receiverClass, FlintMethodInfo *methodInfo) {
+    /* A megamorphic call site never changes again, it doesn't need the lock */
+    if(count == INLINE_CACHE_MEGAMORPHIC)
+        return;
+    Flint::lock();
+    if(count == FLINT_INLINE_CACHE_SIZE) {
+        /* Too many receiver types, the call site uses the class dispatch tables from now on */
+        count = INLINE_CACHE_MEGAMORPHIC;
+    }
+    else if(count != INLINE_CACHE_MEGAMORPHIC) {
+        this->receiverClass[count] = receiverClass;
+        this->methodInfo[count] = methodInfo;
+        count++;
+    }
+    Flint::unlock();
+}
+
+#endif /* FLINT_INLINE_CACHE_SIZE */
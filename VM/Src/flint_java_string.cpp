@@ -179,6 +179,22 @@ bool FlintJavaString::equals(FlintJavaString &str) const {
     return true;
 }
 
+int32_t FlintJavaString::hashCode(void) const {
+    /* Same value as String.hashCode, javac relies on it for switches on strings */
+    const uint8_t *value = (const uint8_t *)getText();
+    uint32_t length = getLength();
+    uint32_t hash = 0;
+    if(getCoder() == 0) {
+        for(uint32_t i = 0; i < length; i++)
+            hash = 31 * hash + value[i];
+    }
+    else {
+        for(uint32_t i = 0; i < length; i++)
+            hash = 31 * hash + ((const uint16_t *)value)[i];
+    }
+    return (int32_t)hash;
+}
+
 FlintConstString::FlintConstString(FlintJavaString &flintString) : flintString(flintString) {
     next = 0;
 }
@@ -1,12 +1,76 @@
 
+#include <stdio.h>
+#include <string.h>
+#include "flint.h"
 #include "flint_java_throwable.h"
 #include "flint_const_name.h"
 #include "flint_fields_data.h"
 
-FlintJavaString *FlintJavaThrowable::getDetailMessage(void) const {
-    return (FlintJavaString *)getFields().getFieldObject(*(const FlintConstUtf8 *)"\x0D\x00\xE6\x62""detailMessage").object;
+static FlintJavaString &formatClassCastMessage(Flint &flint, const FlintVmMessage &message) {
+    const FlintConstUtf8 &fromType = *message.fromType;
+    const FlintConstUtf8 &toType = *message.toType;
+    uint32_t len = 7 + fromType.length + 27 + toType.length + 1;
+    bool isPrimType = FlintJavaObject::isPrimType(fromType);
+    len += message.count;
+    if(!isPrimType)
+        len += 2;
+    FlintJavaString &strObj = flint.newString(len, 0);
+    int8_t *strBuff = strObj.getValue()->getData();
+    memcpy(&strBuff[0], "Class '", 7);
+    uint32_t index = 7;
+    for(uint32_t i = 0; i < message.count; i++)
+        strBuff[index++] = '[';
+    if(!isPrimType)
+        strBuff[index++] = 'L';
+    memcpy(&strBuff[index], fromType.text, fromType.length);
+    index += fromType.length;
+    if(!isPrimType)
+        strBuff[index++] = ';';
+    memcpy(&strBuff[index], "' cannot be cast to class '", 27);
+    index += 27;
+    memcpy(&strBuff[index], toType.text, toType.length);
+    index += toType.length;
+    strBuff[index] = '\'';
+    return strObj;
+}
+
+FlintJavaString *FlintJavaThrowable::getDetailMessage(void) {
+    FlintFieldObject &field = getFields().getFieldObject(*(const FlintConstUtf8 *)"\x0D\x00\xE6\x62""detailMessage");
+    FlintThrowableData *throwableData = getThrowableData();
+    FlintVmMessage *message = throwableData ? &throwableData->message : 0;
+    if(message && message->kind != VM_MESSAGE_NONE) {
+        Flint &flint = Flint::getInstance();
+        switch(message->kind) {
+            case VM_MESSAGE_INDEX: {
+                char indexStrBuff[11];
+                char lengthStrBuff[11];
+                sprintf(indexStrBuff, "%d", (int)message->index);
+                sprintf(lengthStrBuff, "%d", (int)message->length);
+                const char *msg[] = {"Index ", indexStrBuff, " out of bounds for length ", lengthStrBuff};
+                field.object = &flint.newString(msg, LENGTH(msg));
+                break;
+            }
+            case VM_MESSAGE_CLASS_CAST:
+                field.object = &formatClassCastMessage(flint, *message);
+                break;
+            default:
+                field.object = &flint.newString(message->texts, message->count);
+                break;
+        }
+        message->kind = VM_MESSAGE_NONE;
+    }
+    return (FlintJavaString *)field.object;
 }
 
 void FlintJavaThrowable::setDetailMessage(FlintJavaString &strObj) {
     getFields().getFieldObject(*(const FlintConstUtf8 *)"\x0D\x00\xE6\x62""detailMessage").object = &strObj;
+    FlintThrowableData *throwableData = getThrowableData();
+    if(throwableData)
+        throwableData->message.kind = VM_MESSAGE_NONE;
+}
+
+FlintThrowableData *FlintJavaThrowable::getThrowableData(void) const {
+    if(dimensions != 0 || size < sizeof(FlintFieldsData) + sizeof(FlintThrowableData))
+        return 0;
+    return (FlintThrowableData *)&data[sizeof(FlintFieldsData)];
 }
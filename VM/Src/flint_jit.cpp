@@ -0,0 +1,837 @@
+
+#include <new>
+#include <string.h>
+#include <stddef.h>
+#include "flint.h"
+#include "flint_jit.h"
+#include "flint_opcodes.h"
+#include "flint_system_api.h"
+#include "flint_code_translator.h"
+
+#if __has_include("flint_conf.h")
+#include "flint_conf.h"
+#endif
+#include "flint_default_conf.h"
+
+#if FLINT_JIT
+
+/* hotCount of the methods that have been compiled or can not be compiled */
+#define JIT_HOT_DONE                0xFFFF
+
+/* Pointers are loaded and stored with REX.W on LP64 hosts, with 32-bit operands on x32 */
+#define JIT_PTR_W                   (sizeof(void *) == 8)
+
+#define X86_RAX                     0
+#define X86_RCX                     1
+#define X86_RDX                     2
+#define X86_RBX                     3
+#define X86_RSP                     4
+#define X86_RBP                     5
+#define X86_RSI                     6
+#define X86_RDI                     7
+#define X86_R12                     12
+#define X86_R13                     13
+#define X86_NO_INDEX                0xFF
+
+/* Prefix bits of the opcodes passed to emitMem and emitReg */
+#define X86_0F                      0x100
+#define X86_66                      0x200
+
+#define X86_CC_E                    0x04
+#define X86_CC_NE                   0x05
+#define X86_CC_AE                   0x03
+#define X86_CC_LE                   0x0E
+#define X86_CC_ALWAYS               0xFF
+
+/* x86 condition codes of ifeq/if_icmpeq to ifle/if_icmple */
+static const uint8_t conditionCodes[6] = {0x04, 0x05, 0x0C, 0x0D, 0x0F, 0x0E};
+
+typedef void (*FlintJitEntry)(FlintJitFrame *frame, const uint8_t *target);
+
+typedef struct {
+    uint32_t at;
+    uint32_t pc;
+    bool isExit;
+} FlintJitPatch;
+
+/*
+ * The compiled code keeps the frame in rbx, the locals in r12 and the address of the top stack slot in r13.
+ * Every instruction works on the slots of the interpreter, there is no state to write back when it exits.
+ */
+class FlintJitBuffer {
+public:
+    uint8_t *data;
+    uint32_t length;
+    uint32_t capacity;
+    FlintJitPatch *patches;
+    uint32_t patchCount;
+    uint32_t patchCapacity;
+    uint32_t exitOffset;
+};
+
+/* Offsets found by building a probe object, the compiler gives up if the layout is not the expected one */
+typedef struct {
+    uint32_t sizeOffset;
+    uint32_t sizeMask;
+    uint32_t newMask;
+    uint32_t dataOffset;
+    uint32_t fields32Offset;
+    uint32_t fieldsObjectOffset;
+    uint32_t value32Offset;
+    uint32_t objectOffset;
+} FlintJitLayout;
+
+static FlintJitLayout layout;
+
+FlintJitCode::FlintJitCode(uint32_t codeLength) : codeLength(codeLength), native(0) {
+    memset(entries, 0, codeLength * sizeof(uint32_t));
+}
+
+static void emit8(FlintJitBuffer &buff, uint8_t value) {
+    if(buff.length == buff.capacity) {
+        uint32_t capacity = buff.capacity ? (buff.capacity * 2) : 256;
+        buff.data = (uint8_t *)Flint::realloc(buff.data, capacity);
+        buff.capacity = capacity;
+    }
+    buff.data[buff.length++] = value;
+}
+
+static void emit32(FlintJitBuffer &buff, uint32_t value) {
+    for(uint8_t i = 0; i < 4; i++)
+        emit8(buff, (uint8_t)(value >> (i * 8)));
+}
+
+static void patch32(FlintJitBuffer &buff, uint32_t at, uint32_t value) {
+    for(uint8_t i = 0; i < 4; i++)
+        buff.data[at + i] = (uint8_t)(value >> (i * 8));
+}
+
+static void emitPrefix(FlintJitBuffer &buff, uint32_t opcode, uint8_t rex) {
+    if(opcode & X86_66)
+        emit8(buff, 0x66);
+    if(rex != 0x40)
+        emit8(buff, rex);
+    if(opcode & X86_0F)
+        emit8(buff, 0x0F);
+    emit8(buff, (uint8_t)opcode);
+}
+
+/* opcode reg, [base + index * scale + disp] */
+static void emitMem(FlintJitBuffer &buff, uint32_t opcode, bool w, uint8_t reg, uint8_t base, int32_t disp, uint8_t index = X86_NO_INDEX, uint8_t scale = 1) {
+    uint8_t rex = 0x40 | (w ? 0x08 : 0) | ((reg >> 1) & 0x04) | ((base >> 3) & 0x01);
+    if(index != X86_NO_INDEX)
+        rex |= (index >> 2) & 0x02;
+    emitPrefix(buff, opcode, rex);
+    uint8_t mod = (disp == 0 && (base & 0x07) != X86_RBP) ? 0x00 : ((disp >= -128 && disp <= 127) ? 0x40 : 0x80);
+    if(index == X86_NO_INDEX && (base & 0x07) != X86_RSP)
+        emit8(buff, mod | ((reg & 0x07) << 3) | (base & 0x07));
+    else {
+        uint8_t ss = (scale == 8) ? 3 : ((scale == 4) ? 2 : ((scale == 2) ? 1 : 0));
+        emit8(buff, mod | ((reg & 0x07) << 3) | 0x04);
+        emit8(buff, (ss << 6) | ((((index == X86_NO_INDEX) ? X86_RSP : index) & 0x07) << 3) | (base & 0x07));
+    }
+    if(mod == 0x40)
+        emit8(buff, (uint8_t)disp);
+    else if(mod == 0x80)
+        emit32(buff, (uint32_t)disp);
+}
+
+/* opcode rm, reg */
+static void emitReg(FlintJitBuffer &buff, uint32_t opcode, bool w, uint8_t reg, uint8_t rm) {
+    emitPrefix(buff, opcode, 0x40 | (w ? 0x08 : 0) | ((reg >> 1) & 0x04) | ((rm >> 3) & 0x01));
+    emit8(buff, 0xC0 | ((reg & 0x07) << 3) | (rm & 0x07));
+}
+
+static void emitAddTop(FlintJitBuffer &buff, int32_t slots) {
+    if(slots == 0)
+        return;
+    emitReg(buff, 0x83, true, (slots > 0) ? 0 : 5, X86_R13);
+    emit8(buff, (uint8_t)(((slots > 0) ? slots : -slots) * sizeof(int32_t)));
+}
+
+static void emitLoadSlot(FlintJitBuffer &buff, uint8_t reg, uint8_t depth) {
+    emitMem(buff, 0x8B, false, reg, X86_R13, -(int32_t)depth * sizeof(int32_t));
+}
+
+static void emitStoreSlot(FlintJitBuffer &buff, uint8_t reg, uint8_t depth) {
+    emitMem(buff, 0x89, false, reg, X86_R13, -(int32_t)depth * sizeof(int32_t));
+}
+
+static void emitLoadLocal(FlintJitBuffer &buff, uint8_t reg, uint16_t index) {
+    emitMem(buff, 0x8B, false, reg, X86_R12, index * sizeof(int32_t));
+}
+
+static void emitStoreLocal(FlintJitBuffer &buff, uint8_t reg, uint16_t index) {
+    emitMem(buff, 0x89, false, reg, X86_R12, index * sizeof(int32_t));
+}
+
+static void emitPushImm(FlintJitBuffer &buff, int32_t value) {
+    emitAddTop(buff, 1);
+    emitMem(buff, 0xC7, false, 0, X86_R13, 0);
+    emit32(buff, (uint32_t)value);
+}
+
+static void emitPatch(FlintJitBuffer &buff, uint32_t pc, bool isExit) {
+    if(buff.patchCount == buff.patchCapacity) {
+        uint32_t capacity = buff.patchCapacity ? (buff.patchCapacity * 2) : 32;
+        buff.patches = (FlintJitPatch *)Flint::realloc(buff.patches, capacity * sizeof(FlintJitPatch));
+        buff.patchCapacity = capacity;
+    }
+    FlintJitPatch &patch = buff.patches[buff.patchCount++];
+    patch.at = buff.length;
+    patch.pc = pc;
+    patch.isExit = isExit;
+    emit32(buff, 0);
+}
+
+static void emitJump(FlintJitBuffer &buff, uint32_t pc) {
+    emit8(buff, 0xE9);
+    emitPatch(buff, pc, false);
+}
+
+static void emitJcc(FlintJitBuffer &buff, uint8_t cc, uint32_t pc, bool isExit) {
+    emit8(buff, 0x0F);
+    emit8(buff, 0x80 | cc);
+    emitPatch(buff, pc, isExit);
+}
+
+/* Leaves to the interpreter, which resumes at pc */
+static void emitExit(FlintJitBuffer &buff, uint32_t pc) {
+    emit8(buff, 0xB8);
+    emit32(buff, pc);
+    emit8(buff, 0xE9);
+    emit32(buff, buff.exitOffset - (buff.length + 4));
+}
+
+/* Loops leave to the interpreter when the thread is asked to terminate or a debugger attaches */
+static void emitPoll(FlintJitBuffer &buff, uint32_t pc) {
+    emitMem(buff, 0x8B, JIT_PTR_W, X86_RAX, X86_RBX, offsetof(FlintJitFrame, opcodes));
+    emitMem(buff, 0x8B, JIT_PTR_W, X86_RAX, X86_RAX, 0);
+    emitMem(buff, 0x3B, JIT_PTR_W, X86_RAX, X86_RBX, offsetof(FlintJitFrame, runOpcodes));
+    emitJcc(buff, X86_CC_NE, pc, true);
+    emitMem(buff, 0x8B, JIT_PTR_W, X86_RAX, X86_RBX, offsetof(FlintJitFrame, debugger));
+    emitMem(buff, 0x83, JIT_PTR_W, 7, X86_RAX, 0);
+    emit8(buff, 0);
+    emitJcc(buff, X86_CC_NE, pc, true);
+}
+
+static void emitBranch(FlintJitBuffer &buff, uint8_t cc, uint32_t pc, uint32_t target) {
+    if(target > pc) {
+        if(cc == X86_CC_ALWAYS)
+            emitJump(buff, target);
+        else
+            emitJcc(buff, cc, target, false);
+        return;
+    }
+    uint32_t skip = 0;
+    if(cc != X86_CC_ALWAYS) {
+        emit8(buff, 0x0F);
+        emit8(buff, 0x80 | (cc ^ 0x01));
+        skip = buff.length;
+        emit32(buff, 0);
+    }
+    emitPoll(buff, target);
+    emitJump(buff, target);
+    if(cc != X86_CC_ALWAYS)
+        patch32(buff, skip, buff.length - (skip + 4));
+}
+
+/* Objects still protected as new must go through the interpreter, which clears the flag when it pushes them */
+static void emitCheckNew(FlintJitBuffer &buff, uint32_t pc) {
+    emitReg(buff, 0x85, false, X86_RAX, X86_RAX);
+    emit8(buff, 0x74);
+    uint32_t skip = buff.length;
+    emit8(buff, 0);
+    emitMem(buff, 0xF7, false, 0, X86_RAX, layout.sizeOffset);
+    emit32(buff, layout.newMask);
+    emitJcc(buff, X86_CC_NE, pc, true);
+    buff.data[skip] = (uint8_t)(buff.length - (skip + 1));
+}
+
+/* Leaves the array in rcx and the index in rax, the interpreter throws if the array is null or the index out of bounds */
+static void emitArrayCheck(FlintJitBuffer &buff, uint32_t pc, uint8_t arrayDepth, uint8_t indexDepth, uint8_t shift) {
+    emitLoadSlot(buff, X86_RAX, indexDepth);
+    emitLoadSlot(buff, X86_RCX, arrayDepth);
+    emitReg(buff, 0x85, false, X86_RCX, X86_RCX);
+    emitJcc(buff, X86_CC_E, pc, true);
+    emitMem(buff, 0x8B, false, X86_RDX, X86_RCX, layout.sizeOffset);
+    emitReg(buff, 0x81, false, 4, X86_RDX);
+    emit32(buff, layout.sizeMask);
+    if(shift) {
+        emitReg(buff, 0xC1, false, 5, X86_RDX);
+        emit8(buff, shift);
+    }
+    emitReg(buff, 0x3B, false, X86_RAX, X86_RDX);
+    emitJcc(buff, X86_CC_AE, pc, true);
+}
+
+/* eax = eax <kind> ecx, the same operations as intRegOp */
+static void emitIntRegOp(FlintJitBuffer &buff, uint8_t kind) {
+    switch(kind) {
+        case IREG_ADD: emitReg(buff, 0x01, false, X86_RCX, X86_RAX); break;
+        case IREG_SUB: emitReg(buff, 0x29, false, X86_RCX, X86_RAX); break;
+        case IREG_MUL: emitReg(buff, X86_0F | 0xAF, false, X86_RAX, X86_RCX); break;
+        case IREG_AND: emitReg(buff, 0x21, false, X86_RCX, X86_RAX); break;
+        case IREG_OR: emitReg(buff, 0x09, false, X86_RCX, X86_RAX); break;
+        case IREG_XOR: emitReg(buff, 0x31, false, X86_RCX, X86_RAX); break;
+        case IREG_SHL: emitReg(buff, 0xD3, false, 4, X86_RAX); break;
+        case IREG_SHR: emitReg(buff, 0xD3, false, 7, X86_RAX); break;
+        default: emitReg(buff, 0xD3, false, 5, X86_RAX); break;
+    }
+}
+
+static void emitAload(FlintJitBuffer &buff, uint32_t pc, uint16_t index) {
+    emitLoadLocal(buff, X86_RAX, index);
+    emitCheckNew(buff, pc);
+    emitAddTop(buff, 1);
+    emitStoreSlot(buff, X86_RAX, 0);
+}
+
+/* The length depends on the element type, it is read by FlintJit::arrayLength with the object in edi */
+static void emitArrayLength(FlintJitBuffer &buff, int32_t (*arrayLength)(FlintJavaObject *)) {
+    emit8(buff, 0x48);
+    emit8(buff, 0xB8);
+    uint64_t address = (uint64_t)(uintptr_t)arrayLength;
+    emit32(buff, (uint32_t)address);
+    emit32(buff, (uint32_t)(address >> 32));
+    emitReg(buff, 0xFF, false, 2, X86_RAX);
+}
+
+static void emitIdiv(FlintJitBuffer &buff, uint32_t pc, bool isRem) {
+    emitLoadSlot(buff, X86_RCX, 0);
+    emitReg(buff, 0x85, false, X86_RCX, X86_RCX);
+    emitJcc(buff, X86_CC_E, pc, true);
+    emitLoadSlot(buff, X86_RAX, 1);
+    /* idiv faults on INT_MIN / -1, Java wraps the quotient and the remainder is 0 */
+    emitReg(buff, 0x83, false, 7, X86_RCX);
+    emit8(buff, 0xFF);
+    emit8(buff, 0x75);
+    uint32_t notMinusOne = buff.length;
+    emit8(buff, 0);
+    if(isRem)
+        emitReg(buff, 0x31, false, X86_RDX, X86_RDX);
+    else
+        emitReg(buff, 0xF7, false, 3, X86_RAX);
+    emit8(buff, 0xEB);
+    uint32_t done = buff.length;
+    emit8(buff, 0);
+    buff.data[notMinusOne] = (uint8_t)(buff.length - (notMinusOne + 1));
+    emit8(buff, 0x99);
+    emitReg(buff, 0xF7, false, 7, X86_RCX);
+    buff.data[done] = (uint8_t)(buff.length - (done + 1));
+    emitAddTop(buff, -1);
+    emitStoreSlot(buff, isRem ? X86_RDX : X86_RAX, 0);
+}
+
+void FlintJit::countHot(FlintMethodInfo &methodInfo) {
+    if(methodInfo.hotCount < FLINT_JIT_THRESHOLD)
+        methodInfo.hotCount++;
+    else if(methodInfo.hotCount == FLINT_JIT_THRESHOLD) {
+        Flint::lock();
+        if(methodInfo.hotCount == FLINT_JIT_THRESHOLD) {
+            /* One attempt per method, other threads see the code only once it is complete */
+            methodInfo.hotCount = JIT_HOT_DONE;
+            FlintJitCode *jitCode = compile(methodInfo);
+            methodInfo.jitCode = jitCode;
+        }
+        Flint::unlock();
+    }
+}
+
+bool FlintJit::enter(Flint &flint, const FlintJitCode &jitCode, FlintJitFrame &frame) {
+    if(frame.pc >= jitCode.codeLength || jitCode.entries[frame.pc] == 0 || flint.dbg)
+        return false;
+    frame.debugger = &flint.dbg;
+    ((FlintJitEntry)jitCode.native)(&frame, &jitCode.native[jitCode.entries[frame.pc]]);
+    return true;
+}
+
+void FlintJit::free(FlintJitCode *jitCode) {
+    if(jitCode == 0)
+        return;
+    if(jitCode->native)
+        FlintAPI::Jit::freeCode(jitCode->native);
+    Flint::free(jitCode);
+}
+
+int32_t FlintJit::arrayLength(FlintJavaObject *obj) {
+    return obj->size / obj->parseTypeSize();
+}
+
+bool FlintJit::loadLayout(FlintConstUtf8 &type) {
+    if(layout.sizeMask)
+        return true;
+    const uint32_t probeSize = 0x02A5A5A5;
+    uintptr_t objBuff[(sizeof(FlintJavaObject) + sizeof(uintptr_t) - 1) / sizeof(uintptr_t)];
+    uint32_t *words = (uint32_t *)objBuff;
+    uint32_t count = sizeof(FlintJavaObject) / sizeof(uint32_t);
+    memset(objBuff, 0, sizeof(objBuff));
+    FlintJavaObject *obj = new (objBuff)FlintJavaObject(probeSize, type, 0);
+    uint32_t index = 0;
+    while(index < count && (words[index] & 0x3FFFFFFF) != probeSize)
+        index++;
+    if(index == count || (words[index] & ~0x3FFFFFFF) == 0)
+        return false;
+    uint32_t newMask = words[index] & ~0x3FFFFFFF;
+    obj->clearProtected();
+    if(words[index] != probeSize)
+        return false;
+
+    uintptr_t fieldsBuff[(sizeof(FlintFieldsData) + sizeof(uintptr_t) - 1) / sizeof(uintptr_t)];
+    FlintFieldsData *fields = (FlintFieldsData *)fieldsBuff;
+    FlintFieldData32 *data32 = (FlintFieldData32 *)fieldsBuff;
+    FlintFieldObject *object = (FlintFieldObject *)fieldsBuff;
+    layout.sizeOffset = index * sizeof(uint32_t);
+    layout.newMask = newMask;
+    layout.dataOffset = obj->data - (uint8_t *)obj;
+    layout.fields32Offset = (uint8_t *)&fields->fieldsData32 - (uint8_t *)fields;
+    layout.fieldsObjectOffset = (uint8_t *)&fields->fieldsObject - (uint8_t *)fields;
+    layout.value32Offset = (uint8_t *)&data32->value - (uint8_t *)data32;
+    layout.objectOffset = (uint8_t *)&object->object - (uint8_t *)object;
+    layout.sizeMask = 0x3FFFFFFF;
+    return true;
+}
+
+bool FlintJit::compileInstruction(FlintJitBuffer &buff, const FlintMethodInfo &methodInfo, const uint8_t *code, uint32_t pc) {
+    uint8_t opcode = code[pc];
+    switch(opcode) {
+        case OP_NOP:
+            return true;
+        case OP_ACONST_NULL:
+            emitPushImm(buff, 0);
+            return true;
+        case OP_ICONST_M1:
+        case OP_ICONST_0:
+        case OP_ICONST_1:
+        case OP_ICONST_2:
+        case OP_ICONST_3:
+        case OP_ICONST_4:
+        case OP_ICONST_5:
+            emitPushImm(buff, opcode - OP_ICONST_0);
+            return true;
+        case OP_FCONST_0:
+            emitPushImm(buff, 0);
+            return true;
+        case OP_FCONST_1:
+            emitPushImm(buff, 0x3F800000);
+            return true;
+        case OP_FCONST_2:
+            emitPushImm(buff, 0x40000000);
+            return true;
+        case OP_BIPUSH:
+            emitPushImm(buff, (int8_t)code[pc + 1]);
+            return true;
+        case OP_SIPUSH:
+            emitPushImm(buff, CODE_TO_INT16(&code[pc + 1]));
+            return true;
+        case OP_LDC_QUICK:
+            emitPushImm(buff, methodInfo.classLoader.getConstPool(code[pc + 1]).value);
+            return true;
+        case OP_LDC_W_QUICK:
+            emitPushImm(buff, methodInfo.classLoader.getConstPool(CODE_TO_UINT16(&code[pc + 1])).value);
+            return true;
+        case OP_ILOAD:
+        case OP_FLOAD:
+            emitLoadLocal(buff, X86_RAX, code[pc + 1]);
+            emitAddTop(buff, 1);
+            emitStoreSlot(buff, X86_RAX, 0);
+            return true;
+        case OP_ILOAD_0:
+        case OP_ILOAD_1:
+        case OP_ILOAD_2:
+        case OP_ILOAD_3:
+        case OP_FLOAD_0:
+        case OP_FLOAD_1:
+        case OP_FLOAD_2:
+        case OP_FLOAD_3:
+            emitLoadLocal(buff, X86_RAX, (opcode - OP_ILOAD_0) & 0x03);
+            emitAddTop(buff, 1);
+            emitStoreSlot(buff, X86_RAX, 0);
+            return true;
+        case OP_ALOAD:
+        case OP_ALOAD_ARRAYLENGTH_IF_ICMPGE:
+            /* The fused arraylength and if_icmpge are still in the code after it */
+            emitAload(buff, pc, code[pc + 1]);
+            return true;
+        case OP_ALOAD_0:
+        case OP_ALOAD_1:
+        case OP_ALOAD_2:
+        case OP_ALOAD_3:
+            emitAload(buff, pc, opcode - OP_ALOAD_0);
+            return true;
+        case OP_ALOAD_0_GETFIELD:
+            emitAload(buff, pc, 0);
+            return true;
+        case OP_ALOAD_N_ARRAYLENGTH_IF_ICMPGE:
+            /* The arraylength was replaced by the local index, the if_icmpge after it is compiled on its own */
+            emitLoadLocal(buff, X86_RDI, code[pc + 1]);
+            emitReg(buff, 0x85, false, X86_RDI, X86_RDI);
+            emitJcc(buff, X86_CC_E, pc, true);
+            emitArrayLength(buff, &FlintJit::arrayLength);
+            emitAddTop(buff, 1);
+            emitStoreSlot(buff, X86_RAX, 0);
+            return true;
+        case OP_ISTORE:
+        case OP_FSTORE:
+        case OP_ASTORE:
+            emitLoadSlot(buff, X86_RAX, 0);
+            emitAddTop(buff, -1);
+            emitStoreLocal(buff, X86_RAX, code[pc + 1]);
+            return true;
+        case OP_ISTORE_0:
+        case OP_ISTORE_1:
+        case OP_ISTORE_2:
+        case OP_ISTORE_3:
+        case OP_FSTORE_0:
+        case OP_FSTORE_1:
+        case OP_FSTORE_2:
+        case OP_FSTORE_3:
+        case OP_ASTORE_0:
+        case OP_ASTORE_1:
+        case OP_ASTORE_2:
+        case OP_ASTORE_3:
+            emitLoadSlot(buff, X86_RAX, 0);
+            emitAddTop(buff, -1);
+            emitStoreLocal(buff, X86_RAX, (opcode - OP_ISTORE_0) & 0x03);
+            return true;
+        case OP_IALOAD:
+        case OP_FALOAD:
+            emitArrayCheck(buff, pc, 1, 0, 2);
+            emitMem(buff, 0x8B, false, X86_RAX, X86_RCX, layout.dataOffset, X86_RAX, sizeof(int32_t));
+            emitAddTop(buff, -1);
+            emitStoreSlot(buff, X86_RAX, 0);
+            return true;
+        case OP_AALOAD:
+            emitArrayCheck(buff, pc, 1, 0, 2);
+            emitMem(buff, 0x8B, JIT_PTR_W, X86_RAX, X86_RCX, layout.dataOffset, X86_RAX, sizeof(FlintJavaObject *));
+            emitCheckNew(buff, pc);
+            emitAddTop(buff, -1);
+            emitStoreSlot(buff, X86_RAX, 0);
+            return true;
+        case OP_BALOAD:
+            emitArrayCheck(buff, pc, 1, 0, 0);
+            emitMem(buff, X86_0F | 0xBE, false, X86_RAX, X86_RCX, layout.dataOffset, X86_RAX, sizeof(int8_t));
+            emitAddTop(buff, -1);
+            emitStoreSlot(buff, X86_RAX, 0);
+            return true;
+        case OP_CALOAD:
+        case OP_SALOAD:
+            emitArrayCheck(buff, pc, 1, 0, 1);
+            emitMem(buff, X86_0F | 0xBF, false, X86_RAX, X86_RCX, layout.dataOffset, X86_RAX, sizeof(int16_t));
+            emitAddTop(buff, -1);
+            emitStoreSlot(buff, X86_RAX, 0);
+            return true;
+        case OP_IASTORE:
+        case OP_FASTORE:
+        case OP_AASTORE:
+            emitArrayCheck(buff, pc, 2, 1, 2);
+            emitLoadSlot(buff, X86_RDX, 0);
+            emitMem(buff, 0x89, false, X86_RDX, X86_RCX, layout.dataOffset, X86_RAX, sizeof(int32_t));
+            emitAddTop(buff, -3);
+            return true;
+        case OP_BASTORE:
+            emitArrayCheck(buff, pc, 2, 1, 0);
+            emitLoadSlot(buff, X86_RDX, 0);
+            emitMem(buff, 0x88, false, X86_RDX, X86_RCX, layout.dataOffset, X86_RAX, sizeof(int8_t));
+            emitAddTop(buff, -3);
+            return true;
+        case OP_CASTORE:
+        case OP_SASTORE:
+            emitArrayCheck(buff, pc, 2, 1, 1);
+            emitLoadSlot(buff, X86_RDX, 0);
+            emitMem(buff, X86_66 | 0x89, false, X86_RDX, X86_RCX, layout.dataOffset, X86_RAX, sizeof(int16_t));
+            emitAddTop(buff, -3);
+            return true;
+        case OP_POP:
+            emitAddTop(buff, -1);
+            return true;
+        case OP_POP2:
+            emitAddTop(buff, -2);
+            return true;
+        case OP_DUP:
+            emitLoadSlot(buff, X86_RAX, 0);
+            emitAddTop(buff, 1);
+            emitStoreSlot(buff, X86_RAX, 0);
+            return true;
+        case OP_DUP_X1:
+            emitLoadSlot(buff, X86_RAX, 0);
+            emitLoadSlot(buff, X86_RCX, 1);
+            emitStoreSlot(buff, X86_RAX, 1);
+            emitStoreSlot(buff, X86_RCX, 0);
+            emitAddTop(buff, 1);
+            emitStoreSlot(buff, X86_RAX, 0);
+            return true;
+        case OP_DUP2:
+            emitLoadSlot(buff, X86_RAX, 1);
+            emitLoadSlot(buff, X86_RCX, 0);
+            emitAddTop(buff, 2);
+            emitStoreSlot(buff, X86_RAX, 1);
+            emitStoreSlot(buff, X86_RCX, 0);
+            return true;
+        case OP_IADD:
+        case OP_ISUB:
+        case OP_IAND:
+        case OP_IOR:
+        case OP_IXOR: {
+            uint8_t aluOp = (opcode == OP_IADD) ? 0x01 : (opcode == OP_ISUB) ? 0x29 : (opcode == OP_IAND) ? 0x21 : (opcode == OP_IOR) ? 0x09 : 0x31;
+            emitLoadSlot(buff, X86_RAX, 0);
+            emitAddTop(buff, -1);
+            emitMem(buff, aluOp, false, X86_RAX, X86_R13, 0);
+            return true;
+        }
+        case OP_IMUL:
+            emitLoadSlot(buff, X86_RAX, 1);
+            emitMem(buff, X86_0F | 0xAF, false, X86_RAX, X86_R13, 0);
+            emitAddTop(buff, -1);
+            emitStoreSlot(buff, X86_RAX, 0);
+            return true;
+        case OP_IDIV:
+        case OP_IREM:
+            emitIdiv(buff, pc, opcode == OP_IREM);
+            return true;
+        case OP_INEG:
+            emitMem(buff, 0xF7, false, 3, X86_R13, 0);
+            return true;
+        case OP_ISHL:
+        case OP_ISHR:
+        case OP_IUSHR:
+            emitLoadSlot(buff, X86_RCX, 0);
+            emitAddTop(buff, -1);
+            emitMem(buff, 0xD3, false, (opcode == OP_ISHL) ? 4 : ((opcode == OP_ISHR) ? 7 : 5), X86_R13, 0);
+            return true;
+        case OP_IINC:
+        case OP_IINC_GOTO:
+            /* The goto of iinc_goto is still in the code after it */
+            emitMem(buff, 0x81, false, 0, X86_R12, code[pc + 1] * sizeof(int32_t));
+            emit32(buff, (uint32_t)(int32_t)(int8_t)code[pc + 2]);
+            return true;
+        case OP_WIDE: {
+            uint16_t index = CODE_TO_UINT16(&code[pc + 2]);
+            switch(code[pc + 1]) {
+                case OP_ILOAD:
+                case OP_FLOAD:
+                    emitLoadLocal(buff, X86_RAX, index);
+                    emitAddTop(buff, 1);
+                    emitStoreSlot(buff, X86_RAX, 0);
+                    return true;
+                case OP_ISTORE:
+                case OP_FSTORE:
+                    emitLoadSlot(buff, X86_RAX, 0);
+                    emitAddTop(buff, -1);
+                    emitStoreLocal(buff, X86_RAX, index);
+                    return true;
+                case OP_IINC:
+                    emitMem(buff, 0x81, false, 0, X86_R12, index * sizeof(int32_t));
+                    emit32(buff, (uint32_t)(int32_t)CODE_TO_INT16(&code[pc + 4]));
+                    return true;
+                default:
+                    return false;
+            }
+        }
+        case OP_I2B:
+            emitMem(buff, X86_0F | 0xBE, false, X86_RAX, X86_R13, 0);
+            emitStoreSlot(buff, X86_RAX, 0);
+            return true;
+        case OP_I2C:
+        case OP_I2S:
+            emitMem(buff, X86_0F | 0xBF, false, X86_RAX, X86_R13, 0);
+            emitStoreSlot(buff, X86_RAX, 0);
+            return true;
+        case OP_IFEQ:
+        case OP_IFNE:
+        case OP_IFLT:
+        case OP_IFGE:
+        case OP_IFGT:
+        case OP_IFLE:
+        case OP_IFNULL:
+        case OP_IFNONNULL: {
+            uint8_t cond = (opcode == OP_IFNULL) ? 0 : ((opcode == OP_IFNONNULL) ? 1 : (opcode - OP_IFEQ));
+            emitLoadSlot(buff, X86_RAX, 0);
+            emitAddTop(buff, -1);
+            emitReg(buff, 0x85, false, X86_RAX, X86_RAX);
+            emitBranch(buff, conditionCodes[cond], pc, pc + CODE_TO_INT16(&code[pc + 1]));
+            return true;
+        }
+        case OP_IF_ICMPEQ:
+        case OP_IF_ICMPNE:
+        case OP_IF_ICMPLT:
+        case OP_IF_ICMPGE:
+        case OP_IF_ICMPGT:
+        case OP_IF_ICMPLE:
+        case OP_IF_ACMPEQ:
+        case OP_IF_ACMPNE: {
+            uint8_t cond = (opcode >= OP_IF_ACMPEQ) ? (opcode - OP_IF_ACMPEQ) : (opcode - OP_IF_ICMPEQ);
+            emitLoadSlot(buff, X86_RAX, 1);
+            emitLoadSlot(buff, X86_RCX, 0);
+            emitAddTop(buff, -2);
+            emitReg(buff, 0x39, false, X86_RCX, X86_RAX);
+            emitBranch(buff, conditionCodes[cond], pc, pc + CODE_TO_INT16(&code[pc + 1]));
+            return true;
+        }
+        case OP_GOTO:
+            emitBranch(buff, X86_CC_ALWAYS, pc, pc + CODE_TO_INT16(&code[pc + 1]));
+            return true;
+        case OP_GOTO_W:
+            emitBranch(buff, X86_CC_ALWAYS, pc, pc + CODE_TO_INT32(&code[pc + 1]));
+            return true;
+        case OP_ARRAYLENGTH:
+            emitLoadSlot(buff, X86_RDI, 0);
+            emitReg(buff, 0x85, false, X86_RDI, X86_RDI);
+            emitJcc(buff, X86_CC_E, pc, true);
+            emitArrayLength(buff, &FlintJit::arrayLength);
+            emitStoreSlot(buff, X86_RAX, 0);
+            return true;
+        case OP_IGETFIELD_QUICK:
+        case OP_AGETFIELD_QUICK:
+        case OP_IPUTFIELD_QUICK:
+        case OP_BPUTFIELD_QUICK:
+        case OP_SPUTFIELD_QUICK:
+        case OP_APUTFIELD_QUICK: {
+            /* Quick field opcodes are never turned back, the field index is fixed once they are there */
+            FlintConstField &constField = *(FlintConstField *)methodInfo.classLoader.getConstPool(CODE_TO_UINT16(&code[pc + 1])).value;
+            uint32_t index = constField.fieldIndex & 0x7FFFFFFF;
+            bool isObject = (opcode == OP_AGETFIELD_QUICK || opcode == OP_APUTFIELD_QUICK);
+            uint32_t fieldsOffset = layout.dataOffset + (isObject ? layout.fieldsObjectOffset : layout.fields32Offset);
+            int32_t valueOffset = isObject ? (index * sizeof(FlintFieldObject) + layout.objectOffset) : (index * sizeof(FlintFieldData32) + layout.value32Offset);
+            bool isGet = (opcode == OP_IGETFIELD_QUICK || opcode == OP_AGETFIELD_QUICK);
+            emitLoadSlot(buff, X86_RCX, isGet ? 0 : 1);
+            emitReg(buff, 0x85, false, X86_RCX, X86_RCX);
+            emitJcc(buff, X86_CC_E, pc, true);
+            emitMem(buff, 0x8B, JIT_PTR_W, X86_RCX, X86_RCX, fieldsOffset);
+            if(isGet) {
+                emitMem(buff, 0x8B, isObject && JIT_PTR_W, X86_RAX, X86_RCX, valueOffset);
+                if(isObject)
+                    emitCheckNew(buff, pc);
+                emitStoreSlot(buff, X86_RAX, 0);
+                return true;
+            }
+            emitLoadSlot(buff, X86_RAX, 0);
+            if(opcode == OP_BPUTFIELD_QUICK)
+                emitReg(buff, X86_0F | 0xBE, false, X86_RAX, X86_RAX);
+            else if(opcode == OP_SPUTFIELD_QUICK)
+                emitReg(buff, X86_0F | 0xBF, false, X86_RAX, X86_RAX);
+            emitMem(buff, 0x89, isObject && JIT_PTR_W, X86_RAX, X86_RCX, valueOffset);
+            emitAddTop(buff, -2);
+            return true;
+        }
+        case OP_ILOAD_ILOAD_IADD_ISTORE:
+        case OP_ILOAD_ILOAD_IADD_ISTORE_W:
+            emitLoadLocal(buff, X86_RAX, code[pc + 1]);
+            emitMem(buff, 0x03, false, X86_RAX, X86_R12, code[pc + 2] * sizeof(int32_t));
+            emitStoreLocal(buff, X86_RAX, code[pc + 3]);
+            return true;
+        case OP_IREG_ARITH:
+            emitLoadLocal(buff, X86_RAX, code[pc + 1] >> 4);
+            emitLoadLocal(buff, X86_RCX, code[pc + 1] & 0x0F);
+            emitIntRegOp(buff, code[pc + 2] & 0x0F);
+            emitStoreLocal(buff, X86_RAX, code[pc + 2] >> 4);
+            return true;
+        case OP_IREG_ARITH_IMM:
+            emitLoadLocal(buff, X86_RAX, code[pc + 1] >> 4);
+            emit8(buff, 0xB9);
+            emit32(buff, (uint32_t)(int32_t)(int8_t)code[pc + 3]);
+            emitIntRegOp(buff, code[pc + 2] & 0x0F);
+            emitStoreLocal(buff, X86_RAX, code[pc + 1] & 0x0F);
+            return true;
+        case OP_IREG_IF_ICMP: {
+            uint8_t cond = code[pc + 2] & 0x0F;
+            emitLoadLocal(buff, X86_RAX, code[pc + 1] >> 4);
+            emitMem(buff, 0x3B, false, X86_RAX, X86_R12, (code[pc + 1] & 0x0F) * sizeof(int32_t));
+            emitBranch(buff, (cond < 6) ? conditionCodes[cond] : X86_CC_LE, pc, pc + CODE_TO_INT16(&code[pc + 3]));
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+FlintJitCode *FlintJit::compile(FlintMethodInfo &methodInfo) {
+    if(methodInfo.accessFlag & (METHOD_NATIVE | METHOD_ABSTRACT))
+        return 0;
+    FlintCodeAttribute &attributeCode = methodInfo.getAttributeCode();
+#if FLINT_REGISTER_IR
+    /* Frames of methods with register code run it instead of the stack code */
+    if(attributeCode.regCode)
+        return 0;
+#endif
+    if(!loadLayout(methodInfo.name))
+        return 0;
+    const uint8_t *code = attributeCode.code;
+    uint32_t codeLength = attributeCode.codeLength;
+    FlintJitBuffer buff = {0, 0, 0, 0, 0, 0, 0};
+    FlintJitCode *jitCode = 0;
+    try {
+        jitCode = (FlintJitCode *)Flint::malloc(sizeof(FlintJitCode) + codeLength * sizeof(uint32_t));
+        new (jitCode)FlintJitCode(codeLength);
+
+        /* entry(frame, target): keep the callee saved registers, load the frame and jump into the method */
+        emit8(buff, 0x53);
+        emit8(buff, 0x41);
+        emit8(buff, 0x54);
+        emit8(buff, 0x41);
+        emit8(buff, 0x55);
+        emitReg(buff, 0x89, JIT_PTR_W, X86_RDI, X86_RBX);
+        emitMem(buff, 0x8B, JIT_PTR_W, X86_R12, X86_RBX, offsetof(FlintJitFrame, locals));
+        emitMem(buff, 0x8B, JIT_PTR_W, X86_R13, X86_RBX, offsetof(FlintJitFrame, stack));
+        emitMem(buff, 0x63, true, X86_RAX, X86_RBX, offsetof(FlintJitFrame, sp));
+        emitMem(buff, 0x8D, true, X86_R13, X86_R13, 0, X86_RAX, sizeof(int32_t));
+        if(!JIT_PTR_W)
+            emitReg(buff, 0x89, false, X86_RSI, X86_RSI);
+        emitReg(buff, 0xFF, false, 4, X86_RSI);
+
+        /* exit with the pc in eax: store the pc and sp for the interpreter and return */
+        buff.exitOffset = buff.length;
+        emitMem(buff, 0x89, false, X86_RAX, X86_RBX, offsetof(FlintJitFrame, pc));
+        emitReg(buff, 0x89, JIT_PTR_W, X86_R13, X86_RCX);
+        emitMem(buff, 0x2B, JIT_PTR_W, X86_RCX, X86_RBX, offsetof(FlintJitFrame, stack));
+        emitReg(buff, 0xC1, JIT_PTR_W, 7, X86_RCX);
+        emit8(buff, 2);
+        emitMem(buff, 0x89, false, X86_RCX, X86_RBX, offsetof(FlintJitFrame, sp));
+        emit8(buff, 0x41);
+        emit8(buff, 0x5D);
+        emit8(buff, 0x41);
+        emit8(buff, 0x5C);
+        emit8(buff, 0x5B);
+        emit8(buff, 0xC3);
+
+        /* Instructions the compiler does not handle leave to the interpreter and have no entry */
+        for(uint32_t pc = 0; pc < codeLength; pc += FlintCodeTranslator::getInstructionLength(code, pc)) {
+            uint32_t start = buff.length;
+            uint32_t patchCount = buff.patchCount;
+            if(compileInstruction(buff, methodInfo, code, pc))
+                jitCode->entries[pc] = start;
+            else {
+                buff.length = start;
+                buff.patchCount = patchCount;
+                emitExit(buff, pc);
+            }
+        }
+        for(uint32_t i = 0; i < buff.patchCount; i++) {
+            FlintJitPatch &patch = buff.patches[i];
+            uint32_t target = (!patch.isExit && patch.pc < codeLength) ? jitCode->entries[patch.pc] : 0;
+            if(target == 0) {
+                target = buff.length;
+                emitExit(buff, patch.pc);
+            }
+            patch32(buff, patch.at, target - (patch.at + 4));
+        }
+
+        jitCode->native = (uint8_t *)FlintAPI::Jit::allocCode(buff.length);
+        if(jitCode->native == 0)
+            throw "can't allocate the compiled code";
+        memcpy(jitCode->native, buff.data, buff.length);
+    }
+    catch(...) {
+        /* The method keeps running in the interpreter */
+        if(jitCode)
+            Flint::free(jitCode);
+        jitCode = 0;
+    }
+    if(buff.data)
+        Flint::free(buff.data);
+    if(buff.patches)
+        Flint::free(buff.patches);
+    return jitCode;
+}
+
+#endif /* FLINT_JIT */
@@ -1,73 +1,108 @@
 
+#include <new>
 #include <string.h>
 #include "flint.h"
 #include "flint_system_api.h"
 #include "flint_method_info.h"
 #include "flint_native_class.h"
+#include "flint_jit.h"
 
-static FlintNativeMethodPtr findNativeMethod(const FlintMethodInfo &methodInfo) {
+static FlintNativeMethodPtr findInClassList(const FlintNativeClass * const *classList, uint32_t count, const FlintMethodInfo &methodInfo) {
     FlintConstUtf8 &className = methodInfo.classLoader.getThisClass();
-    for(uint32_t i = 0; i < LENGTH(BASE_NATIVE_CLASS_LIST); i++) {
-        if(BASE_NATIVE_CLASS_LIST[i]->className == className) {
-            for(uint32_t k = 0; k < BASE_NATIVE_CLASS_LIST[i]->methodCount; k++) {
+    for(uint32_t i = 0; i < count; i++) {
+        if(classList[i]->className == className) {
+            for(uint32_t k = 0; k < classList[i]->methodCount; k++) {
                 if(
-                    BASE_NATIVE_CLASS_LIST[i]->methods[k].name == methodInfo.name &&
-                    BASE_NATIVE_CLASS_LIST[i]->methods[k].descriptor == methodInfo.descriptor
+                    classList[i]->methods[k].name == methodInfo.name &&
+                    classList[i]->methods[k].descriptor == methodInfo.descriptor
                 ) {
-                    return BASE_NATIVE_CLASS_LIST[i]->methods[k].nativeMathod;
+                    return classList[i]->methods[k].nativeMathod;
                 }
             }
             break;
         }
     }
-    FlintNativeMethodPtr nativeMethod = FlintAPI::System::findNativeMethod(methodInfo);
+    return 0;
+}
+
+static FlintNativeMethodPtr findNativeMethod(const FlintMethodInfo &methodInfo) {
+    FlintNativeMethodPtr nativeMethod = findInClassList(BASE_NATIVE_CLASS_LIST, LENGTH(BASE_NATIVE_CLASS_LIST), methodInfo);
+    if(nativeMethod)
+        return nativeMethod;
+    nativeMethod = findInClassList(OVERRIDE_NATIVE_CLASS_LIST, LENGTH(OVERRIDE_NATIVE_CLASS_LIST), methodInfo);
+    if(nativeMethod)
+        return nativeMethod;
+#if FLINT_AOT
+    nativeMethod = findInClassList(AOT_NATIVE_CLASS_LIST, AOT_NATIVE_CLASS_COUNT, methodInfo);
+    if(nativeMethod)
+        return nativeMethod;
+#endif
+    nativeMethod = FlintAPI::System::findNativeMethod(methodInfo);
     if(nativeMethod)
         return nativeMethod;
     throw (FlintFindNativeError *)"can't find the native method";
 }
 
 FlintMethodInfo::FlintMethodInfo(FlintClassLoader &classLoader, FlintMethodAccessFlag accessFlag, FlintConstUtf8 &name, FlintConstUtf8 &descriptor) :
-accessFlag(accessFlag), classLoader(classLoader), name(name), descriptor(descriptor), attributes(0) {
-
+accessFlag(accessFlag), classLoader(classLoader), name(name), descriptor(descriptor), argc(0), retType(0), retSlots(0), frameSize(0), inlineKind(METHOD_INLINE_NONE), inlineValue(0),
+#if FLINT_JIT
+hotCount(0), jitCode(0),
+#endif
+attributes(0), attributeCode(0), attributeNative(0) {
+    FlintParamInfo paramInfo = FlintConstMethod::parseParamInfo(descriptor);
+    *(uint8_t *)&argc = paramInfo.argc + ((accessFlag & METHOD_STATIC) ? 0 : 1);
+    *(uint8_t *)&retType = paramInfo.retType;
+    *(uint8_t *)&retSlots = (retType == 'V') ? 0 : ((retType == 'J' || retType == 'D') ? 2 : 1);
 }
 
 void FlintMethodInfo::addAttribute(FlintAttribute *attribute) {
     attribute->next = this->attributes;
     this->attributes = attribute;
+    if(attribute->attributeType == ATTRIBUTE_CODE) {
+        attributeCode = (FlintCodeAttribute *)attribute;
+        *(uint16_t *)&frameSize = attributeCode->maxLocals + attributeCode->maxStack;
+    }
+    else if(attribute->attributeType == ATTRIBUTE_NATIVE)
+        attributeNative = (FlintNativeAttribute *)attribute;
+}
+
+bool FlintMethodInfo::bindNativeMethod(const FlintNativeClass * const *classList, uint32_t count) {
+    if(findInClassList(classList, count, *this) == 0)
+        return false;
+    /* The code attribute stays for the stack trace, calls go through the native path */
+    FlintNativeAttribute *attrNative = (FlintNativeAttribute *)Flint::malloc(sizeof(FlintNativeAttribute));
+    new (attrNative)FlintNativeAttribute(0);
+    addAttribute(attrNative);
+    *(FlintMethodAccessFlag *)&accessFlag = (FlintMethodAccessFlag)(accessFlag | METHOD_NATIVE);
+    return true;
 }
 
 FlintAttribute &FlintMethodInfo::getAttribute(FlintAttributeType type) const {
-    for(FlintAttribute *node = attributes; node != 0;) {
-        if(node->attributeType == type) {
-            if(type != ATTRIBUTE_NATIVE)
-                return *node;
-            else {
-                FlintNativeAttribute *attrNative = (FlintNativeAttribute *)node;
-                if(attrNative->nativeMethod == 0)
-                    *(void **)&attrNative->nativeMethod = (void *)findNativeMethod(*this);
-                return *attrNative;
-            }
-        }
+    if(type == ATTRIBUTE_CODE)
+        return getAttributeCode();
+    else if(type == ATTRIBUTE_NATIVE)
+        return getAttributeNative();
+    for(FlintAttribute *node = attributes; node != 0; node = node->next) {
+        if(node->attributeType == type)
+            return *node;
     }
     throw "can't find the attribute";
 }
 
 FlintCodeAttribute &FlintMethodInfo::getAttributeCode(void) const {
-    for(FlintAttribute *node = attributes; node != 0;) {
-        if(node->attributeType == ATTRIBUTE_CODE)
-            return *(FlintCodeAttribute *)node;
-    }
+    if(attributeCode)
+        return *attributeCode;
     throw "can't find the code attribute";
 }
 
 FlintNativeAttribute &FlintMethodInfo::getAttributeNative(void) const {
-    for(FlintAttribute *node = attributes; node != 0;) {
-        if(node->attributeType == ATTRIBUTE_NATIVE) {
-            FlintNativeAttribute *attrNative = (FlintNativeAttribute *)node;
-            if(attrNative->nativeMethod == 0)
-                *(void **)&attrNative->nativeMethod = (void *)findNativeMethod(*this);
-            return *(FlintNativeAttribute *)attrNative;
+    if(attributeNative) {
+        if(attributeNative->nativeMethod == 0) {
+            *(uint8_t *)&attributeNative->argc = argc;
+            *(uint8_t *)&attributeNative->retSlots = retSlots;
+            *(void **)&attributeNative->nativeMethod = (void *)findNativeMethod(*this);
         }
+        return *attributeNative;
     }
     throw "can't find the native attribute";
 }
@@ -79,4 +114,7 @@ FlintMethodInfo::~FlintMethodInfo(void) {
         Flint::free(node);
         node = next;
     }
+#if FLINT_JIT
+    FlintJit::free(jitCode);
+#endif
 }
@@ -0,0 +1,131 @@
+
+#include <string.h>
+#include "flint.h"
+#include "flint_opcodes.h"
+#include "flint_opcode_profiler.h"
+
+#if __has_include("flint_conf.h")
+#include "flint_conf.h"
+#endif
+#include "flint_default_conf.h"
+
+#if FLINT_OPCODE_PROFILE
+
+typedef struct {
+    uint32_t key;
+    uint32_t count;
+} FlintOpcodeProfileEntry;
+
+/* Counters are updated without locking, the values are only approximate when several threads are running */
+static FlintOpcodeProfileEntry profileEntries[FLINT_OPCODE_PROFILE_SIZE];
+
+static uint32_t makeKey(const uint8_t *opcodes, uint8_t length) {
+    uint32_t key = 0;
+    for(uint8_t i = 0; i < length; i++)
+        key = (key << 8) | opcodes[i];
+    return ((uint32_t)length << 24) | key;
+}
+
+static FlintOpcodeProfileEntry *findEntry(uint32_t key, bool isCreate) {
+    uint32_t index = (key * 2654435761U) & (FLINT_OPCODE_PROFILE_SIZE - 1);
+    for(uint32_t i = 0; i < FLINT_OPCODE_PROFILE_SIZE; i++) {
+        FlintOpcodeProfileEntry *entry = &profileEntries[index];
+        if(entry->key == key)
+            return entry;
+        else if(entry->key == 0) {
+            if(!isCreate)
+                return 0;
+            entry->key = key;
+            return entry;
+        }
+        index = (index + 1) & (FLINT_OPCODE_PROFILE_SIZE - 1);
+    }
+    return 0;
+}
+
+void FlintOpcodeProfiler::record(uint32_t history) {
+    uint8_t opcodes[3] = {(uint8_t)(history >> 16), (uint8_t)(history >> 8), (uint8_t)history};
+    if(opcodes[1] == OP_EXIT)
+        return;
+    FlintOpcodeProfileEntry *entry = findEntry(makeKey(&opcodes[1], 2), true);
+    if(entry)
+        entry->count++;
+    if(opcodes[0] == OP_EXIT)
+        return;
+    entry = findEntry(makeKey(opcodes, 3), true);
+    if(entry)
+        entry->count++;
+}
+
+uint32_t FlintOpcodeProfiler::getCount(const uint8_t *opcodes, uint8_t length) {
+    FlintOpcodeProfileEntry *entry = findEntry(makeKey(opcodes, length), false);
+    return entry ? entry->count : 0;
+}
+
+uint32_t FlintOpcodeProfiler::getHotSequences(FlintOpcodeSequence *buff, uint32_t maxCount) {
+    uint32_t count = 0;
+    for(uint32_t i = 0; i < FLINT_OPCODE_PROFILE_SIZE; i++) {
+        FlintOpcodeProfileEntry *entry = &profileEntries[i];
+        if(entry->key == 0)
+            continue;
+        uint32_t pos = count;
+        while(pos > 0 && buff[pos - 1].count < entry->count) {
+            if(pos < maxCount)
+                buff[pos] = buff[pos - 1];
+            pos--;
+        }
+        if(pos >= maxCount)
+            continue;
+        buff[pos].length = entry->key >> 24;
+        for(uint8_t k = 0; k < buff[pos].length; k++)
+            buff[pos].opcodes[k] = entry->key >> ((buff[pos].length - 1 - k) * 8);
+        buff[pos].count = entry->count;
+        if(count < maxCount)
+            count++;
+    }
+    return count;
+}
+
+static uint32_t formatHex8(char *buff, uint8_t value) {
+    static const char hexChars[] = "0123456789ABCDEF";
+    buff[0] = hexChars[value >> 4];
+    buff[1] = hexChars[value & 0x0F];
+    buff[2] = ' ';
+    return 3;
+}
+
+static uint32_t formatUInt32(char *buff, uint32_t value) {
+    char tmp[10];
+    uint32_t length = 0;
+    do {
+        tmp[length++] = '0' + (value % 10);
+        value /= 10;
+    } while(value);
+    for(uint32_t i = 0; i < length; i++)
+        buff[i] = tmp[length - 1 - i];
+    return length;
+}
+
+void FlintOpcodeProfiler::print(uint32_t maxCount) {
+    Flint &flint = Flint::getInstance();
+    FlintOpcodeSequence *sequences = (FlintOpcodeSequence *)Flint::malloc(maxCount * sizeof(FlintOpcodeSequence));
+    uint32_t count = getHotSequences(sequences, maxCount);
+    for(uint32_t i = 0; i < count; i++) {
+        char line[32];
+        uint32_t length = 0;
+        for(uint8_t k = 0; k < sequences[i].length; k++)
+            length += formatHex8(&line[length], sequences[i].opcodes[k]);
+        line[length++] = ':';
+        line[length++] = ' ';
+        length += formatUInt32(&line[length], sequences[i].count);
+        line[length++] = '\n';
+        flint.print(line, length, 0);
+    }
+    Flint::free(sequences);
+}
+
+void FlintOpcodeProfiler::reset(void) {
+    memset(profileEntries, 0, sizeof(profileEntries));
+}
+
+#endif /* FLINT_OPCODE_PROFILE */